@@ -0,0 +1,199 @@
+/**
+ *   AllocTracker, per frame and per zone heap allocation counts
+ *
+ *   Nothing in here may allocate, it runs inside operator new.
+ *
+ *   @file     allocTracker.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "allocTracker.h"
+
+#if PACMAN_TRACK_ALLOCS
+
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#ifdef _MSC_VER
+#include <malloc.h>
+#endif
+
+static AllocTracker::Zone zones[AllocTracker::maxZones] = { { "(no zone)", 0, 0, 0, 0 } };
+static int          zoneCount = 1;                  //zones[0] collects allocations outside every zone
+static thread_local bool trackedThread = false;
+static thread_local int  currentZone = 0;
+
+static uint64_t     frameCount = 0,
+                    frameAllocations = 0,
+                    frameBytes = 0,
+                    steadyFrames = 0,
+                    allocatingFrames = 0;
+
+/**
+ *  Makes the calling thread the one that is counted, call once from the main thread
+ */
+void AllocTracker::attachThread() {
+    trackedThread = true;
+}
+
+/**
+ *  Counts one allocation towards the frame and the innermost zone
+ *
+ *  @param bytes - requested size
+ */
+void AllocTracker::countAllocation(size_t bytes) {
+    if (!trackedThread) { return; }
+    frameAllocations++;
+    frameBytes += bytes;
+    Zone& zone = zones[currentZone];
+    zone.allocations++;
+    zone.bytes += bytes;
+    zone.frameAllocations++;
+    zone.frameBytes += bytes;
+}
+
+/**
+ *  Makes a zone the innermost one, zones past maxZones count as "(no zone)"
+ *
+ *  @param name - zone name, a string literal
+ *
+ *  @return returns the zone to go back to in leaveZone
+ */
+int AllocTracker::enterZone(const char* name) {
+    int previous = currentZone;
+    if (!trackedThread) { return previous; }
+    for (int zone = 0; zone < zoneCount; zone++) {
+        if (zones[zone].name == name || strcmp(zones[zone].name, name) == 0) { currentZone = zone; return previous; }
+    }
+    if (zoneCount < maxZones) {
+        zones[zoneCount] = { name, 0, 0, 0, 0 };
+        currentZone = zoneCount++;
+    }
+    return previous;
+}
+
+/**
+ *  Goes back to the zone that was innermost before enterZone
+ *
+ *  @param previous - value returned by enterZone
+ */
+void AllocTracker::leaveZone(int previous) {
+    currentZone = previous;
+}
+
+/**
+ *  Ends a frame, call once per rendered frame
+ *
+ *  @param steadyState - true for gameplay frames after loading and warmup, those must not allocate
+ */
+void AllocTracker::frameMark(bool steadyState) {
+    frameCount++;
+    if (steadyState) {
+        steadyFrames++;
+        if (frameAllocations != 0) {
+            allocatingFrames++;
+            printf("Frame %llu allocated %llu bytes in %llu allocations:\n", (unsigned long long)frameCount,
+                   (unsigned long long)frameBytes, (unsigned long long)frameAllocations);
+            for (int zone = 0; zone < zoneCount; zone++) {
+                if (zones[zone].frameAllocations == 0) { continue; }
+                printf("  %-24s %8llu bytes %6llu allocations\n", zones[zone].name,
+                       (unsigned long long)zones[zone].frameBytes, (unsigned long long)zones[zone].frameAllocations);
+            }
+            assert(frameAllocations == 0 && "steady state frames must not allocate");
+        }
+    }
+    frameAllocations = frameBytes = 0;
+    for (int zone = 0; zone < zoneCount; zone++) { zones[zone].frameAllocations = zones[zone].frameBytes = 0; }
+}
+
+/**
+ *  Prints the totals per zone, call before exiting
+ */
+void AllocTracker::report() {
+    printf("Allocations, main thread: %llu of %llu steady state frames allocated\n",
+           (unsigned long long)allocatingFrames, (unsigned long long)steadyFrames);
+    for (int zone = 0; zone < zoneCount; zone++) {
+        printf("  %-24s %12llu bytes %8llu allocations\n", zones[zone].name,
+               (unsigned long long)zones[zone].bytes, (unsigned long long)zones[zone].allocations);
+    }
+}
+
+// -----------------------------------------------------------------------------
+// Global operator new and delete
+// -----------------------------------------------------------------------------
+void* operator new(size_t size) {
+    AllocTracker::countAllocation(size);
+    void* memory = malloc(size ? size : 1);
+    if (!memory) { throw std::bad_alloc(); }
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept {
+    AllocTracker::countAllocation(size);
+    return malloc(size ? size : 1);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept {
+    return operator new(size, std::nothrow);
+}
+
+/**
+ *  Over-aligned allocations, malloc only guarantees alignof(std::max_align_t)
+ */
+static void* alignedAllocate(size_t size, size_t alignment) {
+    if (size == 0) { size = 1; }
+#ifdef _MSC_VER
+    return _aligned_malloc(size, alignment);
+#else
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+#endif
+}
+
+static void alignedFree(void* memory) {
+#ifdef _MSC_VER
+    _aligned_free(memory);
+#else
+    free(memory);
+#endif
+}
+
+void* operator new(size_t size, std::align_val_t alignment) {
+    AllocTracker::countAllocation(size);
+    void* memory = alignedAllocate(size, size_t(alignment));
+    if (!memory) { throw std::bad_alloc(); }
+    return memory;
+}
+
+void* operator new[](size_t size, std::align_val_t alignment) {
+    return operator new(size, alignment);
+}
+
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    AllocTracker::countAllocation(size);
+    return alignedAllocate(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return operator new(size, alignment, std::nothrow);
+}
+
+void operator delete(void* memory) noexcept                         { free(memory); }
+void operator delete[](void* memory) noexcept                       { free(memory); }
+void operator delete(void* memory, size_t) noexcept                 { free(memory); }
+void operator delete[](void* memory, size_t) noexcept               { free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept  { free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept{ free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept                           { alignedFree(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept                         { alignedFree(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept                   { alignedFree(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept                 { alignedFree(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept    { alignedFree(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept  { alignedFree(memory); }
+
+#endif
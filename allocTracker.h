@@ -0,0 +1,88 @@
+/**
+ *   Header for the AllocTracker class.
+ *
+ *   Built with PACMAN_TRACK_ALLOCS the global operator new is replaced by one
+ *   that counts every allocation of the attached (main) thread, per frame
+ *   and per PROFILE_ZONE. Frames marked as steady state must not allocate:
+ *   the zones that did are printed and, in debug builds, an assert fires.
+ *   Without the option the macros compile to nothing. Over-aligned (C++17
+ *   std::align_val_t) allocations are counted like the rest.
+ *
+ *   @file     allocTracker.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __ALLOCTRACKER_H
+#define __ALLOCTRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#ifndef PACMAN_TRACK_ALLOCS
+#define PACMAN_TRACK_ALLOCS 0
+#endif
+
+#if PACMAN_TRACK_ALLOCS
+
+ // -----------------------------------------------------------------------------
+ // AllocTracker Class header
+ // -----------------------------------------------------------------------------
+class AllocTracker {
+public:
+    static const int maxZones = 64;
+
+    /**
+     *  Allocations made while a zone was the innermost one
+     */
+    struct Zone {
+        const char* name;
+        uint64_t    allocations,
+                    bytes,
+                    frameAllocations,
+                    frameBytes;
+    };
+
+    static void        attachThread();
+    static void        countAllocation(size_t bytes);
+    static int         enterZone(const char* name);
+    static void        leaveZone(int previous);
+    static void        frameMark(bool steadyState);
+    static void        report();
+};
+
+/**
+ *  Makes allocations in the enclosing scope count towards a zone
+ */
+class AllocZone {
+private:
+    int previous;
+public:
+    AllocZone(const char* name) : previous(AllocTracker::enterZone(name)) {};
+    ~AllocZone() { AllocTracker::leaveZone(previous); };
+};
+
+#define ALLOC_ATTACH_THREAD()       AllocTracker::attachThread()
+#define ALLOC_CONCAT_INNER(a, b)    a##b
+#define ALLOC_CONCAT(a, b)          ALLOC_CONCAT_INNER(a, b)
+#define ALLOC_ZONE(name)            AllocZone ALLOC_CONCAT(allocZone, __LINE__)(name)
+#define ALLOC_FRAME_MARK(steady)    AllocTracker::frameMark(steady)
+#define ALLOC_REPORT()              AllocTracker::report()
+
+#else
+
+/**
+ *  Empty stand in, lets zones that combine trackers hold one in every build
+ */
+class AllocZone {
+public:
+    AllocZone(const char*) {};
+};
+
+#define ALLOC_ATTACH_THREAD()
+#define ALLOC_ZONE(name)
+#define ALLOC_FRAME_MARK(steady)    ((void)sizeof(steady))     //Not evaluated, keeps what only feeds the mark from warning as unused
+#define ALLOC_REPORT()
+
+#endif
+
+#endif
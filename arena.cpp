@@ -0,0 +1,143 @@
+/**
+ *   Arena, linear allocators for per frame and per level buffers
+ *
+ *   @file     arena.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "arena.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ *  Creates an arena with one block
+ *
+ *  @param arenaName - name used in the report, a string literal
+ *  @param capacity  - bytes of the first block
+ */
+Arena::Arena(const char* arenaName, size_t capacity) : name(arenaName) {
+    head = newBlock(capacity);
+}
+
+/**
+ *  Frees every block
+ */
+Arena::~Arena() {
+    while (head) {
+        Block* next = head->next;
+        free(head);
+        head = next;
+    }
+}
+
+/**
+ *  Mallocs a block, the header sits in front of its memory
+ *
+ *  @param capacity - usable bytes
+ *
+ *  @return returns the block, or nullptr if malloc failed
+ */
+Arena::Block* Arena::newBlock(size_t capacity) {
+    Block* block = static_cast<Block*>(malloc(sizeof(Block) + capacity));
+    if (!block) {
+        printf("ERROR: %s arena could not allocate %zu bytes\n", name, capacity);
+        return nullptr;
+    }
+    block->next     = nullptr;
+    block->capacity = capacity;
+    block->used     = 0;
+    return block;
+}
+
+/**
+ *  Bumps the head block, chains a bigger block when it is full
+ *
+ *  @param bytes     - size of the allocation
+ *  @param alignment - power of two
+ *
+ *  @return returns the memory, valid until the next reset, nullptr if no block could be allocated
+ */
+void* Arena::allocate(size_t bytes, size_t alignment) {
+    if (head) {
+        uintptr_t base  = reinterpret_cast<uintptr_t>(head + 1),
+                  start = (base + head->used + alignment - 1) & ~uintptr_t(alignment - 1);
+        size_t    end   = size_t(start - base) + bytes;
+        if (end <= head->capacity) {
+            used += end - head->used;
+            head->used = end;
+            return reinterpret_cast<void*>(start);
+        }
+    }
+
+    //Full: chain on a block at least twice the size, reset() folds them into one
+    size_t capacity = head ? head->capacity * 2 : 0;
+    if (capacity < bytes + alignment) { capacity = bytes + alignment; }
+    Block* block = newBlock(capacity);
+    if (!block) { return nullptr; }
+    block->next = head;
+    head = block;
+    grows++;
+    return allocate(bytes, alignment);
+}
+
+/**
+ *  Drops every allocation. If blocks were chained since the last reset they
+ *  are replaced by one block big enough for the peak, so the next frame fits.
+ *
+ *  @return returns the bytes that were in use
+ */
+size_t Arena::reset() {
+    lastUsed = used;
+    if (peak < used) { peak = used; }
+    resets++;
+    if (head && head->next) {
+        size_t capacity = 0;
+        while (head) {
+            Block* next = head->next;
+            capacity += head->capacity;
+            free(head);
+            head = next;
+        }
+        head = newBlock(capacity);
+    }
+    else if (head) {
+        head->used = 0;
+    }
+    used = 0;
+    return lastUsed;
+}
+
+/**
+ *  Total bytes of all blocks
+ */
+size_t Arena::getCapacity() {
+    size_t capacity = 0;
+    for (Block* block = head; block; block = block->next) { capacity += block->capacity; }
+    return capacity;
+}
+
+/**
+ *  Prints peak usage against capacity, call before exiting
+ */
+void Arena::report() {
+    printf("%s arena: peak %.1f KB of %.1f KB over %i resets, grew %i times\n", name,
+           (peak < used ? used : peak) / 1024.0, getCapacity() / 1024.0, resets, grows);
+}
+
+/**
+ *  Arena reset at the end of every main loop iteration
+ */
+Arena& Arena::frame() {
+    static Arena arena("Frame", 256 * 1024);
+    return arena;
+}
+
+/**
+ *  Arena reset when a level is loaded
+ */
+Arena& Arena::level() {
+    static Arena arena("Level", 1024 * 1024);
+    return arena;
+}
@@ -0,0 +1,101 @@
+/**
+ *   Header for the Arena class.
+ *
+ *   Linear (bump) allocators for transient buffers. Allocating moves a
+ *   pointer, freeing does nothing, and reset() drops everything at once.
+ *   Two arenas exist: the frame arena is reset at the end of every main loop
+ *   iteration and the level arena when a level is loaded. ArenaAllocator
+ *   lets std::vector and friends live in an arena.
+ *
+ *   Arenas are not thread safe, only the main (GL) thread may use them.
+ *
+ *   @file     arena.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __ARENA_H
+#define __ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+ // -----------------------------------------------------------------------------
+ // Arena Class header
+ // -----------------------------------------------------------------------------
+class Arena {
+private:
+    /**
+     *  One malloc'ed chunk, the arena only chains more when the first is full
+     */
+    struct Block {
+        Block*  next;
+        size_t  capacity,
+                used;
+    };
+
+    const char* name;
+    Block*  head = nullptr;             //Block allocated from, the newest one
+    size_t  used = 0,                   //Bytes handed out since the last reset, all blocks
+            peak = 0,                   //Largest used seen at a reset
+            lastUsed = 0;
+    int     resets = 0,
+            grows  = 0;                 //Times a block had to be chained on
+
+    Block*  newBlock(size_t capacity);
+
+public:
+    Arena(const char* arenaName, size_t capacity);
+    ~Arena();
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    void*   allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+    size_t  reset();
+    void    report();
+
+    size_t  getUsed()       { return used; };
+    size_t  getPeak()       { return peak; };
+    size_t  getLastUsed()   { return lastUsed; };
+    size_t  getCapacity();
+
+    static Arena& frame();
+    static Arena& level();
+};
+
+/**
+ *  Standard allocator that takes its memory from an Arena, deallocate is a no-op.
+ *  Containers should reserve() up front, every regrowth leaves the old buffer behind.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    Arena* arena;
+
+    ArenaAllocator(Arena& source) : arena(&source) {};
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) : arena(other.arena) {};
+
+    /**
+     *  Takes count objects from the arena, containers expect std::bad_alloc instead of nullptr
+     */
+    T* allocate(size_t count) {
+        if (count > size_t(-1) / sizeof(T)) { throw std::bad_alloc(); }
+        void* memory = arena->allocate(count * sizeof(T), alignof(T));
+        if (!memory) { throw std::bad_alloc(); }
+        return static_cast<T*>(memory);
+    };
+    void deallocate(T*, size_t)     {};
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const { return arena == other.arena; };
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const { return arena != other.arena; };
+};
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+#endif
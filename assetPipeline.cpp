@@ -0,0 +1,154 @@
+/**
+ *   AssetPipeline, threaded startup loading
+ *
+ *   @file     assetPipeline.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "assetPipeline.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+static thread_local int workerNumber = -1;     //Set on worker threads, used in the report
+
+/**
+ *  Starts the worker threads
+ *
+ *  @param workerCount - amount of workers, 0 picks one from the hardware
+ */
+AssetPipeline::AssetPipeline(int workerCount) {
+    created = Clock::now();
+    if (workerCount <= 0) {
+        int hardware = int(std::thread::hardware_concurrency());
+        workerCount = std::max(1, std::min(4, hardware - 1));   //Leaves a core for the main thread
+    }
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(&AssetPipeline::workerLoop, this, i);
+    }
+}
+
+/**
+ *  Stops and joins the workers, queued jobs are still run first
+ */
+AssetPipeline::~AssetPipeline() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (auto& worker : workers) { worker.join(); }
+}
+
+/**
+ *  Worker body, takes jobs until the pipeline is stopped
+ *
+ *  @param index - worker number, used in the report
+ */
+void AssetPipeline::workerLoop(int index) {
+    workerNumber = index;
+    PROFILE_THREAD_NAME("asset worker");
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobReady.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (jobs.empty()) { return; }
+            job = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        {
+            PROFILE_ZONE("asset job");
+            job();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pendingJobs--;
+        }
+        mainReady.notify_one();
+    }
+}
+
+/**
+ *  Queues a timed job for the workers
+ *
+ *  @param name - stage name
+ *  @param job  - work to run
+ */
+void AssetPipeline::enqueueJob(const std::string& name, std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        pendingJobs++;
+        jobs.push_back([this, name, job]() {
+            Clock::time_point start = Clock::now();
+            job();
+            char thread[32];
+            snprintf(thread, sizeof(thread), "worker %i", workerNumber);
+            recordStage(name, thread, start, Clock::now());
+        });
+    }
+    jobReady.notify_one();
+}
+
+/**
+ *  Hands GL work to the main thread, called from a worker
+ *
+ *  @param name   - stage name
+ *  @param upload - work that needs the GL context
+ */
+void AssetPipeline::queueUpload(const std::string& name, std::function<void()> upload) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        uploads.push_back([this, name, upload]() {
+            Clock::time_point start = Clock::now();
+            upload();
+            recordStage(name, "main", start, Clock::now());
+        });
+    }
+    mainReady.notify_one();
+}
+
+/**
+ *  Runs uploads on the calling (GL) thread as they arrive, until every job is done
+ */
+void AssetPipeline::finish() {
+    Clock::time_point start = Clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        mainReady.wait(lock, [this] { return !uploads.empty() || pendingJobs == 0; });
+        if (uploads.empty()) { break; }             //Workers push uploads before finishing a job
+        std::function<void()> upload = std::move(uploads.front());
+        uploads.pop_front();
+        lock.unlock();
+        upload();
+        lock.lock();
+    }
+    lock.unlock();
+    recordStage("wait for assets", "main", start, Clock::now());
+}
+
+/**
+ *  Stores a finished stage, thread safe
+ */
+void AssetPipeline::recordStage(const std::string& name, const std::string& thread,
+                                Clock::time_point start, Clock::time_point stop) {
+    typedef std::chrono::duration<double, std::milli> Ms;
+    Stage stage = { name, thread, Ms(start - created).count(), Ms(stop - start).count() };
+    std::lock_guard<std::mutex> lock(mutex);
+    stages.push_back(stage);
+}
+
+/**
+ *  Prints the startup breakdown, sorted by start time
+ */
+void AssetPipeline::report() {
+    typedef std::chrono::duration<double, std::milli> Ms;
+    std::lock_guard<std::mutex> lock(mutex);
+    std::sort(stages.begin(), stages.end(),
+              [](const Stage& a, const Stage& b) { return a.startMs < b.startMs; });
+    printf("Startup: %.1f ms with %zu asset workers\n", Ms(Clock::now() - created).count(), workers.size());
+    for (auto& stage : stages) {
+        printf("  [%-10s] %8.1f + %7.1f ms  %s\n", stage.thread.c_str(),
+               stage.startMs, stage.durationMs, stage.name.c_str());
+    }
+}
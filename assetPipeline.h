@@ -0,0 +1,105 @@
+/**
+ *   Header for the AssetPipeline class.
+ *
+ *   Runs CPU side asset work (image decoding, model parsing, map meshing)
+ *   on worker threads while the main thread brings up the window and GL
+ *   context. Anything that touches OpenGL is handed back to the main thread
+ *   through an upload queue which is drained by AssetPipeline::finish().
+ *
+ *   @file     assetPipeline.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __ASSETPIPELINE_H
+#define __ASSETPIPELINE_H
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+ // -----------------------------------------------------------------------------
+ // AssetPipeline Class header
+ // -----------------------------------------------------------------------------
+class AssetPipeline {
+public:
+    typedef std::chrono::steady_clock Clock;
+
+    /**
+     *  One timed startup stage, kept for the breakdown printed by report()
+     */
+    struct Stage {
+        std::string name;
+        std::string thread;         //"main" or "worker N"
+        double      startMs,        //Relative to pipeline creation
+                    durationMs;
+    };
+
+private:
+    std::vector<std::thread>            workers;
+    std::deque<std::function<void()>>   jobs;       //Waiting CPU work
+    std::deque<std::function<void()>>   uploads;    //Waiting main thread (GL) work
+    std::vector<Stage>                  stages;
+    std::mutex                          mutex;
+    std::condition_variable             jobReady,
+                                        mainReady;
+    int     pendingJobs = 0;                        //Jobs queued or running
+    bool    stopping    = false;
+    Clock::time_point created;
+
+    void    workerLoop(int index);
+    void    enqueueJob(const std::string& name, std::function<void()> job);
+    void    queueUpload(const std::string& name, std::function<void()> upload);
+
+public:
+    AssetPipeline(int workerCount = 0);
+    ~AssetPipeline();
+
+    /**
+     *  Queues work for a worker thread, its result is handed to upload on the main thread
+     *
+     *  @param name   - stage name used in the startup report
+     *  @param work   - runs on a worker, must not touch OpenGL, returns T
+     *  @param upload - runs on the main thread inside finish(), receives T&
+     */
+    template <typename T, typename Work, typename Upload>
+    void submit(const std::string& name, Work work, Upload upload) {
+        std::shared_ptr<T> result = std::make_shared<T>();
+        enqueueJob(name, [this, name, work, upload, result]() mutable {
+            *result = work();
+            queueUpload("upload " + name, [upload, result]() mutable { upload(*result); });
+        });
+    }
+
+    /**
+     *  Queues work for a worker thread that has nothing to upload on its own
+     */
+    void    submit(const std::string& name, std::function<void()> work) { enqueueJob(name, work); };
+
+    void    finish();
+    void    recordStage(const std::string& name, const std::string& thread,
+                        Clock::time_point start, Clock::time_point stop);
+    void    report();
+    int     getWorkerCount() { return int(workers.size()); };
+};
+
+/**
+ *  Times a block of main thread work as a startup stage
+ */
+class StageTimer {
+private:
+    AssetPipeline&            pipeline;
+    std::string               name;
+    AssetPipeline::Clock::time_point start;
+public:
+    StageTimer(AssetPipeline& owner, const std::string& stageName)
+        : pipeline(owner), name(stageName), start(AssetPipeline::Clock::now()) {};
+    ~StageTimer() { pipeline.recordStage(name, "main", start, AssetPipeline::Clock::now()); };
+};
+
+#endif
@@ -0,0 +1,145 @@
+/**
+ *   Header for the microbenchmark harness used by pacman_bench.
+ *
+ *   Each benchmark is a callable run in a calibrated loop. The loop is
+ *   repeated several times and the median and median absolute deviation of
+ *   the time per call are kept, so one noisy repeat does not move the
+ *   result. Results are written as JSON.
+ *
+ *   @file     benchHarness.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __BENCHHARNESS_H
+#define __BENCHHARNESS_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ *  Keeps the compiler from removing work whose result is unused
+ */
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
+
+ // -----------------------------------------------------------------------------
+ // BenchHarness Class header
+ // -----------------------------------------------------------------------------
+class BenchHarness {
+public:
+    typedef std::vector<std::pair<std::string, long long>> Params;
+
+    /**
+     *  Result of one benchmark at one parameter set
+     */
+    struct Result {
+        std::string name;
+        Params      params;
+        long long   iterations;         //Calls per repeat
+        long long   itemsPerCall;       //Work items one call handles, for throughput
+        double      medianNs,           //Per call
+                    madNs,
+                    minNs;
+    };
+
+private:
+    std::vector<Result> results;
+    std::string filter;
+    double  minRepeatSeconds = 0.02;
+    int     repeats = 7;
+
+public:
+    BenchHarness(const std::string& nameFilter = "", double repeatSeconds = 0.02, int repeatCount = 7)
+        : filter(nameFilter), minRepeatSeconds(repeatSeconds), repeats(repeatCount) {};
+
+    /**
+     *  Returns true when a benchmark of that name would run, to skip costly setup
+     */
+    bool enabled(const std::string& name) { return filter.empty() || name.find(filter) != std::string::npos; };
+
+    /**
+     *  Times a callable, skipped when its name does not contain the filter
+     *
+     *  @param name         - benchmark name
+     *  @param params       - sweep values, written next to the result
+     *  @param itemsPerCall - work items handled by one call of op
+     *  @param op           - work to time, called many times
+     */
+    template <typename Op>
+    void run(const std::string& name, const Params& params, long long itemsPerCall, Op op) {
+        if (!enabled(name)) { return; }
+        typedef std::chrono::steady_clock Clock;
+
+        //Double the iteration count until one repeat takes long enough to time
+        long long iterations = 1;
+        while (true) {
+            Clock::time_point start = Clock::now();
+            for (long long i = 0; i < iterations; i++) { op(); }
+            double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+            if (seconds >= minRepeatSeconds || iterations >= (1ll << 30)) { break; }
+            iterations *= 2;
+        }
+
+        std::vector<double> samples;
+        for (int r = 0; r < repeats; r++) {
+            Clock::time_point start = Clock::now();
+            for (long long i = 0; i < iterations; i++) { op(); }
+            samples.push_back(std::chrono::duration<double, std::nano>(Clock::now() - start).count() / iterations);
+        }
+
+        Result result = { name, params, iterations, itemsPerCall, median(samples), 0.0, 0.0 };
+        result.minNs = *std::min_element(samples.begin(), samples.end());
+        std::vector<double> deviations;
+        for (auto& sample : samples) { deviations.push_back(sample > result.medianNs ? sample - result.medianNs : result.medianNs - sample); }
+        result.madNs = median(deviations);
+        results.push_back(result);
+
+        fprintf(stderr, "%-24s", name.c_str());
+        for (auto& param : params) { fprintf(stderr, " %s=%-6lli", param.first.c_str(), param.second); }
+        fprintf(stderr, " %12.1f ns  +-%.1f\n", result.medianNs, result.madNs);
+    }
+
+    /**
+     *  Returns the median, values is reordered
+     */
+    static double median(std::vector<double> values) {
+        if (values.empty()) { return 0.0; }
+        size_t mid = values.size() / 2;
+        std::nth_element(values.begin(), values.begin() + mid, values.end());
+        return values[mid];
+    }
+
+    /**
+     *  Writes every result as JSON
+     *
+     *  @param out - open file or stdout
+     */
+    void writeJson(FILE* out) {
+        fprintf(out, "{\n  \"benchmarks\": [\n");
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& result = results[i];
+            fprintf(out, "    {\"name\": \"%s\", \"params\": {", result.name.c_str());
+            for (size_t p = 0; p < result.params.size(); p++) {
+                fprintf(out, "%s\"%s\": %lli", p ? ", " : "", result.params[p].first.c_str(), result.params[p].second);
+            }
+            fprintf(out, "}, \"iterations\": %lli, \"medianNs\": %.2f, \"madNs\": %.2f, \"minNs\": %.2f, \"itemsPerSecond\": %.1f}%s\n",
+                    result.iterations, result.medianNs, result.madNs, result.minNs,
+                    result.medianNs > 0.0 ? result.itemsPerCall * 1e9 / result.medianNs : 0.0,
+                    (i + 1 < results.size()) ? "," : "");
+        }
+        fprintf(out, "  ]\n}\n");
+    }
+};
+
+#endif
@@ -0,0 +1,711 @@
+/**
+ *   pacman_bench, microbenchmarks for the game's CPU hot paths
+ *
+ *   Sweeps generated levels from the size of level0 up to 8x its sides and
+ *   entity counts from a handful of ghosts to a crowd of 100k, pathfinders also
+ *   run on mazes of the same sizes. Nothing here needs a GL context, only CPU
+ *   side code is timed.
+ *
+ *   Usage: pacman_bench [--filter name] [--out file.json] [--min-time seconds]
+ *
+ *   @file     pacmanBench.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "benchHarness.h"
+#include "../map.h"
+#include "../ghost.h"
+#include "../pacman.h"
+#include "../pellet.h"
+#include "../timingWheel.h"
+#include "../navGraph.h"
+#include "../distanceOracle.h"
+#include "../hpaPathfinder.h"
+#include "../floodFill.h"
+#include "../lineOfSight.h"
+#include "../ghostLod.h"
+#include "../jobSystem.h"
+#include "../ghostCrowd.h"
+#include <array>
+#include <cstring>
+#include <functional>
+
+static const std::pair<int, int> levelSizes[] = { { 28, 36 }, { 56, 72 }, { 112, 144 }, { 224, 288 } };
+static const std::pair<int, int> hugeLevelSizes[] = { { 1024, 1024 }, { 2048, 2048 } };   //Mazes for the flood fill only
+static const int entityCounts[] = { 5, 64, 512, 4096, 100000 };
+
+/**
+ *  Writes a level of the given size: border walls, a pillar on every even tile
+ *  and pacman in the bottom left corner, so every open tile is reachable
+ *
+ *  @return returns the file path
+ */
+static std::string writeLevel(int width, int height) {
+    std::string path = "bench_level_" + std::to_string(width) + "x" + std::to_string(height);
+    FILE* out = fopen(path.c_str(), "w");
+    fprintf(out, "%ix%i\n", width, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            bool border = (x == 0 || y == 0 || x == width - 1 || y == height - 1),
+                 pillar = (x % 2 == 0 && y % 2 == 0);
+            int  value  = (border || pillar) ? 1 : 0;
+            if (x == 1 && y == height - 2) { value = 2; }
+            fprintf(out, "%i%s", value, (x + 1 < width) ? " " : "\n");
+        }
+    }
+    fclose(out);
+    return path;
+}
+
+/**
+ *  Writes a maze of the given size: corridors one tile wide carved from a
+ *  fixed seed, with one wall in 40 knocked out so there are loops, and
+ *  pacman in the bottom left corner. Manhattan distance says little about
+ *  the way through, unlike on the pillar levels.
+ *
+ *  @return returns the file path
+ */
+static std::string writeMaze(int width, int height) {
+    std::vector<int> grid(size_t(width) * height, 1);
+    int cellsX = (width - 1) / 2, cellsY = (height - 2) / 2;
+    std::vector<char> visited(size_t(cellsX) * cellsY, 0);
+    std::vector<int> stack = { 0 };
+    unsigned seed = 12345;
+    auto next = [&]() { seed = seed * 1103515245u + 12345u; return int((seed >> 16) & 0x7FFF); };
+    visited[0] = 1;
+    grid[1 * width + 1] = 0;
+    while (!stack.empty()) {
+        int cell = stack.back(), cx = cell % cellsX, cy = cell / cellsX;
+        int options[4], count = 0;
+        if (0 < cx && !visited[cell - 1])                { options[count++] = cell - 1; }
+        if (cx + 1 < cellsX && !visited[cell + 1])       { options[count++] = cell + 1; }
+        if (0 < cy && !visited[cell - cellsX])           { options[count++] = cell - cellsX; }
+        if (cy + 1 < cellsY && !visited[cell + cellsX])  { options[count++] = cell + cellsX; }
+        if (count == 0) { stack.pop_back(); continue; }
+        int to = options[next() % count], tx = to % cellsX, ty = to / cellsX;
+        visited[to] = 1;
+        grid[(2 * ty + 1) * width + 2 * tx + 1] = 0;
+        grid[(cy + ty + 1) * width + cx + tx + 1] = 0;
+        stack.push_back(to);
+    }
+    for (int knock = 0; knock < width * height / 40; knock++) {
+        int x = 1 + next() % (width - 2), y = 1 + next() % (height - 3);
+        bool across = (grid[y * width + x - 1] == 0 && grid[y * width + x + 1] == 0)
+                   || (grid[(y - 1) * width + x] == 0 && grid[(y + 1) * width + x] == 0);
+        if (across) { grid[y * width + x] = 0; }
+    }
+    grid[(height - 2) * width + 1] = 2;
+
+    std::string path = "bench_maze_" + std::to_string(width) + "x" + std::to_string(height);
+    FILE* out = fopen(path.c_str(), "w");
+    fprintf(out, "%ix%i\n", width, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) { fprintf(out, "%i%s", grid[y * width + x], (x + 1 < width) ? " " : "\n"); }
+    }
+    fclose(out);
+    return path;
+}
+
+/**
+ *  Returns every open tile of a map
+ */
+static std::vector<std::pair<int, int>> openTiles(Map& map) {
+    std::vector<std::pair<int, int>> tiles;
+    std::pair<int, int> size = map.getWidthHeight();
+    for (int y = 0; y < size.second - 1; y++) {
+        for (int x = 0; x < size.first; x++) {
+            if (map.getMapVal(x, y) == 0) { tiles.push_back({ x, y }); }
+        }
+    }
+    return tiles;
+}
+
+/**
+ *  Spreads ghosts over the open tiles of a map, ghosts share tiles when there are more ghosts than tiles
+ */
+static std::vector<Ghost> spawnGhosts(Map& map, Camera* camera, int count) {
+    std::vector<std::pair<int, int>> tiles = openTiles(map);
+    std::vector<Ghost> ghosts;
+    ghosts.reserve(count);
+    for (int g = 0; g < count; g++) {
+        std::pair<int, int> tile = tiles[(size_t(g) * 7919) % tiles.size()];
+        ghosts.emplace_back(tile.first, tile.second, true, map.getWidthHeight(), map.getXYshift(), camera);
+    }
+    return ghosts;
+}
+
+/**
+ *  Plain A* over the tiles of a NavGraph, the baseline HpaPathfinder is
+ *  measured against. Scratch is sized once per map like the pathfinder's.
+ */
+struct GridAStar {
+    NavGraph* nav = nullptr;
+    int width = 0;
+    std::vector<int> cost, parent;
+    std::vector<uint32_t> seen;
+    uint32_t stamp = 0;
+    std::vector<std::array<int, 3>> open;     //(estimate, cost, tile), ties go to the tile further along
+
+    void init(NavGraph& graph) {
+        nav = &graph;
+        width = graph.getWidthHeight().first;
+        size_t tiles = size_t(width) * graph.getWidthHeight().second;
+        cost.assign(tiles, 0);
+        parent.assign(tiles, -1);
+        seen.assign(tiles, 0);
+        stamp = 0;
+    }
+
+    //Returns the path length in tiles and the path in tiles, -1 if out of reach
+    int findPath(int fromX, int fromY, int toX, int toY, std::vector<int>& tiles) {
+        static const int directions[4] = { 2, 4, 3, 9 };
+        auto later = [](const std::array<int, 3>& a, const std::array<int, 3>& b) { return a[0] > b[0] || (a[0] == b[0] && a[1] < b[1]); };
+        tiles.clear();
+        if (++stamp == 0) { std::fill(seen.begin(), seen.end(), 0); stamp = 1; }
+        int goal = toY * width + toX;
+        open.clear();
+        open.push_back({ std::abs(toX - fromX) + std::abs(toY - fromY), 0, fromY * width + fromX });
+        cost[fromY * width + fromX] = 0;
+        parent[fromY * width + fromX] = -1;
+        seen[fromY * width + fromX] = stamp;
+        while (!open.empty()) {
+            std::pop_heap(open.begin(), open.end(), later);
+            int tile = open.back()[2],
+                x = tile % width, y = tile / width;
+            int reached = open.back()[1];
+            open.pop_back();
+            if (reached != cost[tile]) { continue; }
+            if (tile == goal) {
+                for (int at = goal; at != -1; at = parent[at]) { tiles.push_back(at); }
+                std::reverse(tiles.begin(), tiles.end());
+                return cost[goal];
+            }
+            int mask = nav->legalMask(x, y);
+            for (int d = 0; d < 4; d++) {
+                if (!(mask & NavGraph::bitOf(directions[d]))) { continue; }
+                int nx = x + ((directions[d] == 9) ? 1 : (directions[d] == 3) ? -1 : 0),
+                    ny = y + ((directions[d] == 2) ? 1 : (directions[d] == 4) ? -1 : 0),
+                    next = ny * width + nx;
+                if (seen[next] == stamp && cost[next] <= cost[tile] + 1) { continue; }
+                seen[next] = stamp;
+                cost[next] = cost[tile] + 1;
+                parent[next] = tile;
+                open.push_back({ cost[next] + std::abs(toX - nx) + std::abs(toY - ny), cost[next], next });
+                std::push_heap(open.begin(), open.end(), later);
+            }
+        }
+        return -1;
+    }
+
+    size_t getBytes() {
+        return (cost.size() + parent.size()) * sizeof(int) + seen.size() * sizeof(uint32_t)
+             + open.capacity() * sizeof(std::array<int, 3>);
+    }
+};
+
+/**
+ *  Times HpaPathfinder against plain A* between the same random pairs of
+ *  open tiles. The nextDir cache is cleared every run so each query pays
+ *  for its search. Memory of both and how much longer the hierarchical
+ *  paths are go to stderr.
+ */
+static void benchPaths(BenchHarness& bench, const BenchHarness::Params& params, NavGraph& nav, const std::vector<std::pair<int, int>>& open) {
+    long long tiles = (long long)nav.getWidthHeight().first * nav.getWidthHeight().second;
+    HpaPathfinder hpa;
+    bench.run("hpa_build", params, tiles, [&]() {
+        hpa.build(nav);
+        doNotOptimize(hpa.getNodeCount());
+    });
+    hpa.build(nav);
+    hpa.report();
+    std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> pairs;
+    for (int q = 0; q < 256; q++) { pairs.push_back({ open[rand() % open.size()], open[rand() % open.size()] }); }
+    bench.run("hpa_next_dir", params, 256, [&]() {
+        int sum = 0;
+        hpa.clearCache();
+        for (auto& pair : pairs) { sum += hpa.nextDir(pair.first.first, pair.first.second, pair.second.first, pair.second.second); }
+        doNotOptimize(sum);
+    });
+    std::vector<int> route;
+    bench.run("hpa_find_path", params, 256, [&]() {
+        int sum = 0;
+        for (auto& pair : pairs) { sum += hpa.findPath(pair.first.first, pair.first.second, pair.second.first, pair.second.second, route); }
+        doNotOptimize(sum);
+    });
+    GridAStar astar;
+    astar.init(nav);
+    bench.run("astar_path", params, 256, [&]() {
+        int sum = 0;
+        for (auto& pair : pairs) { sum += astar.findPath(pair.first.first, pair.first.second, pair.second.first, pair.second.second, route); }
+        doNotOptimize(sum);
+    });
+    long long hpaLength = 0, astarLength = 0;
+    for (auto& pair : pairs) {
+        hpaLength   += hpa.findPath(pair.first.first, pair.first.second, pair.second.first, pair.second.second, route);
+        astarLength += astar.findPath(pair.first.first, pair.first.second, pair.second.first, pair.second.second, route);
+    }
+    fprintf(stderr, "HPA* %.1f KB, A* %.1f KB, HPA* paths %.2f%% longer\n",
+        hpa.getBytes() / 1024.0, astar.getBytes() / 1024.0, astarLength ? 100.0 * (hpaLength - astarLength) / astarLength : 0.0);
+}
+
+/**
+ *  Times FloodFill against a breadth first search labelling the same
+ *  components, growing the area around pacman and picking ghost spawns
+ */
+static void benchFlood(BenchHarness& bench, const BenchHarness::Params& params, Map& map) {
+    std::pair<int, int> size = map.getWidthHeight();
+    long long tiles = (long long)size.first * size.second;
+    FloodFill flood;
+    bench.run("flood_build", params, tiles, [&]() {
+        flood.build(map);
+        doNotOptimize(flood.getComponentCount());
+    });
+    flood.build(map);
+    flood.report();
+
+    std::vector<int> component, queue(tiles);
+    bench.run("bfs_label", params, tiles, [&]() {
+        static const int stepX[4] = { 0, 0, -1, 1 }, stepY[4] = { 1, -1, 0, 0 };
+        component.assign(tiles, -1);
+        int components = 0;
+        for (int start = 0; start < tiles; start++) {
+            if (0 <= component[start] || start / size.first == size.second - 1 || map.getMapVal(start % size.first, start / size.first) == 1) { continue; }
+            int head = 0, tail = 0;
+            queue[tail++] = start;
+            component[start] = components;
+            while (head < tail) {
+                int tile = queue[head++];
+                for (int d = 0; d < 4; d++) {
+                    int x = tile % size.first + stepX[d], y = tile / size.first + stepY[d];
+                    if (x < 0 || y < 0 || size.first <= x || size.second - 1 <= y || map.getMapVal(x, y) == 1) { continue; }
+                    if (component[y * size.first + x] < 0) { component[y * size.first + x] = components; queue[tail++] = y * size.first + x; }
+                }
+            }
+            components++;
+        }
+        doNotOptimize(components);
+    });
+
+    std::pair<int, int> pacSpawn = map.getPacSpawnPoint();
+    bench.run("flood_grow", params, 1, [&]() {
+        std::vector<uint64_t> near = flood.emptyBoard();
+        flood.set(near, pacSpawn.first, pacSpawn.second);
+        flood.grow(near, 8);
+        doNotOptimize(near.data());
+    });
+    bench.run("spawn_ghosts", params, 4, [&]() {
+        std::vector<std::pair<int, int>> spawns = map.spawnGhost(4, flood, 8);
+        doNotOptimize(spawns.data());
+    });
+}
+
+/**
+ *  Times batches of ghost to pacman rays, from open tiles to open tiles up to
+ *  sightRange apart: trace() with and without the run tables, and the same
+ *  rays asked one at a time through visible()
+ */
+static void benchSight(BenchHarness& bench, const BenchHarness::Params& params, Map& map, const std::vector<std::pair<int, int>>& open) {
+    static const int rays = 4096, sightRange = 16;
+    std::vector<LineOfSight::Query> queries;
+    while (int(queries.size()) < rays) {
+        std::pair<int, int> from = open[rand() % open.size()], to = open[rand() % open.size()];
+        if (sightRange < std::abs(to.first - from.first) || sightRange < std::abs(to.second - from.second)) {
+            to.first  = from.first  + std::max(-sightRange, std::min(sightRange, to.first  - from.first));
+            to.second = from.second + std::max(-sightRange, std::min(sightRange, to.second - from.second));
+        }
+        queries.push_back({ from.first, from.second, to.first, to.second });
+    }
+    LineOfSight sight;
+    std::vector<uint8_t> visible;
+    for (int tables = 1; 0 <= tables; tables--) {
+        BenchHarness::Params sightParams = params;
+        sightParams.push_back({ "tables", tables });
+        sight.build(map, tables == 1);
+        bench.run("los_trace", sightParams, rays, [&]() {
+            sight.trace(queries, visible);
+            doNotOptimize(visible.data());
+        });
+    }
+    bench.run("los_scalar", params, rays, [&]() {
+        int seen = 0;
+        for (auto& query : queries) { seen += sight.visible(query.fromX, query.fromY, query.toX, query.toY); }
+        doNotOptimize(seen);
+    });
+    sight.trace(queries, visible);
+    int seen = 0;
+    for (uint8_t v : visible) { seen += v; }
+    sight.report();
+    printf("  %d of %d rays see their end\n", seen, rays);
+}
+
+/**
+ *  Times a whole tick of the crowd through GhostCrowd on 1 to N workers, N
+ *  being the hardware threads and at least 4, for the speedup curve. Half
+ *  the ghosts chase pacman and the rest wander. Before timing, every worker
+ *  count runs the same fixed ticks from the same spawn, the positions have
+ *  to match the single worker run bit for bit.
+ *
+ *  Only 1, 2 and 4 workers and one per hardware thread are timed, the last
+ *  as workers=0 like JobSystem(0), so the keys are the same on any machine.
+ *  The rest of the curve is in the check lines.
+ */
+static void benchJobs(BenchHarness& bench, const BenchHarness::Params& params, Map& map, Camera* camera,
+                      NavGraph& nav, DistanceOracle& paths, int count, std::pair<int, int> pacTile) {
+    static const int checkTicks = 100;
+    if (!bench.enabled("ghost_tick_jobs")) { return; }
+    std::vector<int> workerCounts;
+    int hardware = JobSystem::hardwareWorkers(),
+        most     = std::max(4, hardware);
+    for (int workers = 1; workers < most; workers *= 2) { workerCounts.push_back(workers); }
+    workerCounts.push_back(most);
+    if (std::find(workerCounts.begin(), workerCounts.end(), hardware) == workerCounts.end()) {
+        workerCounts.insert(std::upper_bound(workerCounts.begin(), workerCounts.end(), hardware), hardware);
+    }
+
+    std::pair<float, float> shift = map.getXYshift();
+    std::vector<int> everyone(count);
+    for (int g = 0; g < count; g++) { everyone[g] = g; }
+    uint64_t expected = 0;
+    double   oneWorkerMs = 0.0;
+    for (int workers : workerCounts) {
+        JobSystem  jobs(workers);
+        GhostCrowd crowd;
+        crowd.setJobSystem(&jobs);
+        srand(unsigned(count));     //Same spawn and random streams for every worker count
+        std::vector<Ghost> ghosts = spawnGhosts(map, camera, count);
+        MotionBatch motion;
+        for (int g = 0; g < count; g++) {
+            ghosts[g].setNavGraph(&nav);
+            ghosts[g].setOracle(&paths);
+            if (g % 2 == 0) { ghosts[g].setTarget(pacTile); }
+            ghosts[g].bindMotion(motion, 0.0f);
+        }
+        double now  = 0.0;
+        int    tick = 0;
+        auto step = [&]() {
+            now += 0.015;
+            crowd.step(ghosts, motion, float(now));
+            if (tick++ % 3 == 0) {
+                jobs.parallelFor(count, GhostLod::animateChunk, [&](int first, int last) {
+                    for (int g = first; g < last; g++) { ghosts[g].ghostAnimate(); }
+                });
+            }
+            return crowd.collide(ghosts, everyone, pacTile, shift).size();
+        };
+
+        auto start = std::chrono::steady_clock::now();
+        for (int t = 0; t < checkTicks; t++) { step(); }
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        uint64_t hash = 1469598103934665603ull;
+        for (int g = 0; g < count; g++) {
+            float position[2] = { motion.getX(g), motion.getY(g) };
+            uint32_t bits[2];
+            memcpy(bits, position, sizeof(bits));
+            hash = (hash ^ bits[0]) * 1099511628211ull;
+            hash = (hash ^ bits[1]) * 1099511628211ull;
+        }
+        if (workers == 1) { expected = hash; oneWorkerMs = ms; }
+        fprintf(stderr, "ghost_tick_jobs entities=%i workers=%i: %d ticks in %.1f ms, %.2fx, positions %s\n",
+            count, workers, checkTicks, ms, oneWorkerMs / ms, (hash == expected) ? "match" : "DIFFER");
+
+        for (int key : { 1, 2, 4, 0 }) {
+            if (key != workers && !(key == 0 && workers == hardware)) { continue; }
+            BenchHarness::Params jobParams = params;
+            jobParams.push_back({ "workers", key });
+            bench.run("ghost_tick_jobs", jobParams, count, [&]() { doNotOptimize(step()); });
+        }
+        if (workers == most) {
+            crowd.report();
+            jobs.report();
+        }
+    }
+}
+
+/**
+ *  Times scheduling of one AI decision per ghost, every decision picks the
+ *  next one 15 to 1000 ms ahead. Each step is one 15 ms game tick:
+ *  decision_scan counts down every ghost like Ghost::changeDir's AIdelay,
+ *  decision_heap and decision_wheel only touch the ghosts that decide.
+ */
+static void benchDecisions(BenchHarness& bench, int count) {
+    BenchHarness::Params params = { { "entities", count } };
+    std::vector<uint32_t> delays(1024);
+    for (auto& delay : delays) { delay = 15 + uint32_t(rand() % 986); }
+
+    std::vector<uint32_t> countdown(count);
+    for (int id = 0; id < count; id++) { countdown[id] = delays[id & 1023]; }
+    long long decisions = 0;
+    bench.run("decision_scan", params, count, [&]() {
+        for (int id = 0; id < count; id++) {
+            if (countdown[id] <= 15) { countdown[id] = delays[(id + decisions++) & 1023]; }
+            else                     { countdown[id] -= 15; }
+        }
+    });
+
+    typedef std::pair<uint32_t, int> Timer;
+    std::vector<Timer> heap;
+    heap.reserve(count);
+    for (int id = 0; id < count; id++) { heap.push_back({ delays[id & 1023], id }); }
+    std::make_heap(heap.begin(), heap.end(), std::greater<Timer>());
+    uint32_t heapNow = 0;
+    bench.run("decision_heap", params, count, [&]() {
+        heapNow += 15;
+        while (heap.front().first <= heapNow) {
+            int id = heap.front().second;
+            std::pop_heap(heap.begin(), heap.end(), std::greater<Timer>());
+            heap.back() = { heapNow + delays[(id + decisions++) & 1023], id };
+            std::push_heap(heap.begin(), heap.end(), std::greater<Timer>());
+        }
+    });
+
+    TimingWheel wheel;
+    wheel.resize(count);
+    for (int id = 0; id < count; id++) { wheel.schedule(id, delays[id & 1023]); }
+    std::vector<int> expired;
+    expired.reserve(count);
+    uint32_t wheelNow = 0;
+    bench.run("decision_wheel", params, count, [&]() {
+        wheelNow += 15;
+        expired.clear();
+        wheel.advance(wheelNow, expired);
+        for (int id : expired) { wheel.schedule(id, wheelNow + delays[(id + decisions++) & 1023]); }
+    });
+    doNotOptimize(decisions);
+}
+
+/**
+ *  main function
+ */
+int main(int argc, char** argv) {
+    std::string filter, output;
+    double minTime = 0.02;
+    for (int arg = 1; arg + 1 < argc; arg++) {
+        std::string flag = argv[arg];
+        if      (flag == "--filter")   { filter = argv[++arg]; }
+        else if (flag == "--out")      { output = argv[++arg]; }
+        else if (flag == "--min-time") { minTime = std::stod(argv[++arg]); }
+    }
+    srand(1);
+    fprintf(stderr, "MotionBatch kernel: %s\n", MotionBatch::kernelName());
+    BenchHarness bench(filter, minTime);
+    Camera camera;
+
+    for (int count : entityCounts) { benchDecisions(bench, count); }
+
+    for (auto& size : levelSizes) {
+        BenchHarness::Params params = { { "width", size.first }, { "height", size.second } };
+        long long tiles = (long long)size.first * size.second;
+        std::string path = writeLevel(size.first, size.second);
+
+        bench.run("map_parse", params, tiles, [&]() {
+            Map map(path, &camera);
+            doNotOptimize(map.getMapSize());
+        });
+
+        Map map(path, &camera);
+        camera.recieveMap(map.getIntMap());
+        bench.run("map_mesh", params, tiles, [&]() {
+            map.mapFloatCreate();
+            doNotOptimize(map.getMapSize());
+        });
+
+        NavGraph nav;
+        bench.run("nav_build", params, tiles, [&]() {
+            nav.build(map);
+            doNotOptimize(nav.getNodeCount());
+        });
+        nav.build(map);
+
+        //All pairs table on one thread and on every core (threads=0), levels over the limit only set up the fallback
+        DistanceOracle paths;
+        for (int threads : { 1, 0 }) {
+            BenchHarness::Params oracleParams = params;
+            oracleParams.push_back({ "threads", threads });
+            bench.run("oracle_build", oracleParams, tiles, [&]() {
+                paths.build(nav, DistanceOracle::defaultTableTiles, threads);
+                doNotOptimize(paths.getTileCount());
+            });
+        }
+        paths.build(nav);
+        paths.report();
+
+        //Next move queries from anywhere toward as many targets as the fallback caches
+        std::vector<std::pair<int, int>> open = openTiles(map);
+        std::vector<std::pair<int, int>> targets;
+        for (int t = 0; t < DistanceOracle::fieldCacheSize; t++) { targets.push_back(open[(size_t(t) * 104729) % open.size()]); }
+        BenchHarness::Params queryParams = params;
+        queryParams.push_back({ "table", paths.hasTable() ? 1 : 0 });
+        bench.run("oracle_next_dir", queryParams, 4096, [&]() {
+            int sum = 0;
+            for (int q = 0; q < 4096; q++) {
+                std::pair<int, int> from = open[(size_t(q) * 7919) % open.size()],
+                                    to   = targets[q % targets.size()];
+                sum += paths.nextDir(from.first, from.second, to.first, to.second);
+            }
+            doNotOptimize(sum);
+        });
+
+        benchPaths(bench, params, nav, open);
+        std::string mazePath = writeMaze(size.first, size.second);
+        Map maze(mazePath, &camera);
+        remove(mazePath.c_str());
+        NavGraph mazeNav;
+        mazeNav.build(maze);
+        BenchHarness::Params mazeParams = params;
+        mazeParams.push_back({ "maze", 1 });
+        benchPaths(bench, mazeParams, mazeNav, openTiles(maze));
+        benchFlood(bench, params, map);
+        benchFlood(bench, mazeParams, maze);
+        benchSight(bench, params, map, open);
+        benchSight(bench, mazeParams, maze, openTiles(maze));
+
+        std::pair<float, float> shift = map.getXYshift();
+        bench.run("camera_coords", params, tiles * 12, [&]() {
+            float sum = 0.0f;
+            for (int y = 0; y < size.second; y++) {
+                for (int x = 0; x < size.first; x++) {
+                    for (int loop = 0; loop < 12; loop++) { sum += camera.getCoordsWithInt(y, x, loop, 0.0f, shift); }
+                }
+            }
+            doNotOptimize(sum);
+        });
+
+        //Pellet rebuild, CPU side gather that runs before every pellet buffer upload
+        PelletPool pellets;
+        pellets.init(map.getWidthHeight(), shift, &camera);
+        for (auto& tile : openTiles(map)) { pellets.add(tile.first, tile.second); }
+        for (int p = 0; p < pellets.size(); p += 3) { pellets.remove(p); }
+        std::vector<float> container;
+        container.reserve(size_t(pellets.size()) * PelletPool::stride);
+        BenchHarness::Params pelletParams = params;
+        pelletParams.push_back({ "pellets", (long long)pellets.size() });
+        bench.run("pellet_rebuild", pelletParams, (long long)pellets.size(), [&]() {
+            pellets.gatherVertices(container);
+            doNotOptimize(container.data());
+        });
+
+        for (int count : entityCounts) {
+            BenchHarness::Params entityParams = params;
+            entityParams.push_back({ "entities", count });
+
+            //Ghost::updateLerp runs Ghost::changeDir at every tile and rebuilds the ghost vertices
+            std::vector<Ghost> ghosts = spawnGhosts(map, &camera, count);
+            bench.run("ghost_update_lerp", entityParams, count, [&]() {
+                for (auto& ghost : ghosts) { ghost.updateLerp(); }
+            });
+
+            //The same tick through MotionBatch, what Scene::tick runs
+            std::vector<Ghost> batchGhosts = spawnGhosts(map, &camera, count);
+            MotionBatch motion;
+            for (auto& ghost : batchGhosts) { ghost.bindMotion(motion, 0.0f); }
+            double now = 0.0;
+            bench.run("ghost_batch_step", entityParams, count, [&]() {
+                now += 0.015;
+                int   slot;
+                float eventTime;
+                while (motion.nextEvent(float(now), slot, eventTime)) { batchGhosts[slot].tileBoundary(eventTime); }
+                motion.interpolate(float(now));
+                doNotOptimize(motion.getX(0));
+            });
+
+            //The same through the NavGraph, ghosts are only visited at nodes
+            std::vector<Ghost> navGhosts = spawnGhosts(map, &camera, count);
+            MotionBatch navMotion;
+            for (auto& ghost : navGhosts) { ghost.setNavGraph(&nav); ghost.bindMotion(navMotion, 0.0f); }
+            double navNow = 0.0;
+            bench.run("ghost_nav_step", entityParams, count, [&]() {
+                navNow += 0.015;
+                int   slot;
+                float eventTime;
+                while (navMotion.nextEvent(float(navNow), slot, eventTime)) { navGhosts[slot].tileBoundary(eventTime); }
+                navMotion.interpolate(float(navNow));
+                doNotOptimize(navMotion.getX(0));
+            });
+
+            //A whole Scene::tick of the crowd, movement, collisions and an animation step every
+            //third tick, for every ghost and through GhostLod with pacman in the middle of the level
+            std::pair<int, int> pacTile = open[open.size() / 2];
+            for (int tiers = 0; tiers < 2; tiers++) {
+                std::vector<Ghost> tickGhosts = spawnGhosts(map, &camera, count);
+                MotionBatch tickMotion;
+                for (auto& ghost : tickGhosts) { ghost.setNavGraph(&nav); ghost.setOracle(&paths); ghost.bindMotion(tickMotion, 0.0f); }
+                GhostLod lod;
+                lod.setCollisionReach(shift);
+                double tickNow = 0.0;
+                int tick = 0;
+                bench.run(tiers ? "ghost_tick_lod" : "ghost_tick_full", entityParams, count, [&]() {
+                    tickNow += 0.015;
+                    bool refresh = tiers && lod.due(tickGhosts[0].getLerpStep(), 0.015f * tickGhosts[0].getTilesPerSecond());
+                    int   slot;
+                    float eventTime;
+                    while (tickMotion.nextEvent(float(tickNow), slot, eventTime)) { tickGhosts[slot].tileBoundary(eventTime); }
+                    tickMotion.interpolate(float(tickNow));
+                    int hits = 0;
+                    if (tiers) {
+                        if (refresh) { lod.refresh(tickGhosts, &paths, pacTile); }
+                        if (tick++ % 3 == 0) { lod.animate(tickGhosts); }
+                        for (int g : lod.getCollision()) { hits += tickGhosts[g].checkGhostCollision(float(pacTile.first), float(pacTile.second), shift); }
+                    }
+                    else {
+                        if (tick++ % 3 == 0) {
+                            for (auto& ghost : tickGhosts) { ghost.ghostAnimate(); }
+                        }
+                        for (auto& ghost : tickGhosts) { hits += ghost.checkGhostCollision(float(pacTile.first), float(pacTile.second), shift); }
+                    }
+                    doNotOptimize(hits);
+                });
+                if (tiers) { lod.report(); }
+            }
+            if (4096 <= count) { benchJobs(bench, entityParams, map, &camera, nav, paths, count, pacTile); }
+
+            bench.run("ghost_collision", entityParams, count, [&]() {
+                int hits = 0;
+                for (auto& ghost : ghosts) { hits += ghost.checkGhostCollision(float(size.first / 2), float(size.second / 2), shift); }
+                doNotOptimize(hits);
+            });
+
+            bench.run("ghost_random_dir", entityParams, count, [&]() {
+                int sum = 0;
+                for (auto& ghost : ghosts) { sum += ghost.ghostGetRandomDir(); }
+                doNotOptimize(sum);
+            });
+
+            //Pacman::updateLerp with Pacman::changeDir, turning every few tiles like a player would
+            std::vector<Pacman> pacmans;
+            pacmans.reserve(count);
+            std::vector<std::pair<int, int>> tiles = openTiles(map);
+            for (int p = 0; p < count; p++) {
+                pacmans.emplace_back(tiles[(size_t(p) * 7919) % tiles.size()], shift);
+                pacmans.back().getCameraPointer(&camera);
+                pacmans.back().setWidthHeight(map.getWidthHeight());
+                pacmans.back().setXYshift(shift);
+            }
+            const int turns[4] = { 2, 9, 4, 3 };
+            int tick = 0;
+            bench.run("pacman_update_lerp", entityParams, count, [&]() {
+                tick++;
+                for (auto& pacman : pacmans) {
+                    if (tick % 30 == 0) { pacman.updateDir(turns[(tick / 30) % 4]); pacman.changeDir(); }
+                    pacman.updateLerp();
+                }
+            });
+        }
+        remove(path.c_str());
+    }
+
+    for (auto& size : hugeLevelSizes) {
+        if (!bench.enabled("flood_build") && !bench.enabled("bfs_label")) { break; }
+        BenchHarness::Params params = { { "width", size.first }, { "height", size.second }, { "maze", 1 } };
+        std::string path = writeMaze(size.first, size.second);
+        Map maze(path, &camera);
+        remove(path.c_str());
+        benchFlood(bench, params, maze);
+    }
+
+    FILE* out = output.empty() ? stdout : fopen(output.c_str(), "w");
+    if (!out) { fprintf(stderr, "Could not write %s\n", output.c_str()); return EXIT_FAILURE; }
+    bench.writeJson(out);
+    if (out != stdout) { fclose(out); }
+    return EXIT_SUCCESS;
+}
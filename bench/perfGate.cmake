@@ -0,0 +1,47 @@
+# Runs the benchmarks and compares them against BASELINE with PerfCompare.
+# -DUPDATE=ON rewrites BASELINE from this run instead.
+#
+# Expects PACMAN_BENCH, PACMAN, PERF_COMPARE, BASELINE, LEVEL, FRAME_BENCH,
+# RUNS, THRESHOLD and ALLOW, see PACMAN_PERF_GATE in CMakeLists.txt
+
+# Every suite runs RUNS times, PerfCompare takes the median and MAD over the runs
+set(RESULTS "")
+foreach(run RANGE 1 ${RUNS})
+  execute_process(COMMAND ${PACMAN_BENCH} --out perf_micro_${run}.json RESULT_VARIABLE result)
+  if(NOT result EQUAL 0)
+    message(FATAL_ERROR "pacman_bench failed: ${result}")
+  endif()
+  list(APPEND RESULTS perf_micro_${run}.json)
+endforeach()
+
+if(FRAME_BENCH)
+  foreach(run RANGE 1 ${RUNS})
+    execute_process(COMMAND ${PACMAN} --bench --level ${LEVEL} --bench-out perf_frame_${run}.json RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+      message(FATAL_ERROR "Pacman --bench failed: ${result}")
+    endif()
+    list(APPEND RESULTS perf_frame_${run}.json)
+  endforeach()
+endif()
+
+set(MODE "")
+if(UPDATE)
+  set(MODE --update)
+endif()
+
+# Metrics missing from the run or the baseline fail the check unless allowed,
+# frame metrics are only there when Pacman --bench ran
+string(REPLACE "," ";" ALLOW_PREFIXES "${ALLOW}")
+if(NOT FRAME_BENCH)
+  list(APPEND ALLOW_PREFIXES frame/)
+endif()
+set(ALLOW_ARGS "")
+foreach(prefix IN LISTS ALLOW_PREFIXES)
+  list(APPEND ALLOW_ARGS --allow ${prefix})
+endforeach()
+
+execute_process(COMMAND ${PERF_COMPARE} --baseline ${BASELINE} --threshold ${THRESHOLD} ${ALLOW_ARGS} ${MODE} ${RESULTS}
+                RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "Performance check against ${BASELINE} failed")
+endif()
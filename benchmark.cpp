@@ -0,0 +1,206 @@
+/**
+ *   Headless render benchmark, scripted run and JSON report
+ *
+ *   @file     benchmark.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "benchmark.h"
+#include "headless.h"
+#include "scene.h"
+#include "renderStats.h"
+#include "profiler.h"
+#include "allocTracker.h"
+#include "arena.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+static const float benchTick      = 0.015f;    //Simulated seconds per frame, one simulation tick
+static const int   inputInterval  = 24;        //Frames between scripted key presses
+static const int   turnFrames     = 240;       //Frames for one full camera turn
+static const int   scriptDirs[4]  = { 9, 2, 3, 4 };
+
+/**
+ *  Reads one benchmark flag, advancing arg past its value
+ *
+ *  @param arg     - index of the flag, left on the last argument used
+ *  @param argc    - argument count
+ *  @param argv    - arguments
+ *  @param options - settings to fill
+ *
+ *  @return returns false if argv[arg] is not a benchmark flag
+ */
+bool parseBenchOption(int& arg, int argc, char** argv, BenchOptions& options) {
+    std::string flag = argv[arg];
+    if (arg + 1 >= argc) { return false; }
+    if      (flag == "--frames")    { options.frames = std::stoi(argv[++arg]); }
+    else if (flag == "--warmup")    { options.warmup = std::stoi(argv[++arg]); }
+    else if (flag == "--seed")      { options.seed   = unsigned(std::stoul(argv[++arg])); }
+    else if (flag == "--workers")   { options.workers = std::stoi(argv[++arg]); }
+    else if (flag == "--level")     { options.level  = argv[++arg]; }
+    else if (flag == "--bench-out") { options.output = argv[++arg]; }
+    else if (flag == "--size") {
+        if (sscanf(argv[++arg], "%ix%i", &options.width, &options.height) != 2) {
+            printf("Expected --size WxH, got %s\n", argv[arg]);
+        }
+    }
+    else { return false; }
+    return true;
+}
+
+/**
+ *  Returns the nearest rank percentile of sorted values
+ */
+static double percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) { return 0.0; }
+    size_t rank = size_t(p / 100.0 * (sorted.size() - 1) + 0.5);
+    return sorted[std::min(rank, sorted.size() - 1)];
+}
+
+/**
+ *  Writes {"mean":..,"p50":..,...} for a set of samples
+ */
+static void writeDistribution(FILE* out, const char* name, std::vector<double> values, const char* suffix) {
+    std::sort(values.begin(), values.end());
+    double sum = 0.0;
+    for (auto& value : values) { sum += value; }
+    fprintf(out, "  \"%s\": {\"mean\": %.4f, \"min\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p95\": %.4f, \"p99\": %.4f, \"max\": %.4f}%s\n",
+            name, values.empty() ? 0.0 : sum / values.size(), values.empty() ? 0.0 : values.front(),
+            percentile(values, 50), percentile(values, 90), percentile(values, 95), percentile(values, 99),
+            values.empty() ? 0.0 : values.back(), suffix);
+}
+
+/**
+ *  FNV-1a hash of the last frame, equal hashes mean the runs drew the same image
+ */
+static uint64_t hashFramebuffer(int width, int height) {
+    std::vector<unsigned char> pixels(size_t(width) * height * 4);
+    glReadPixels(0, 0, width, height, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+    uint64_t hash = 1469598103934665603ull;
+    for (auto& byte : pixels) { hash = (hash ^ byte) * 1099511628211ull; }
+    return hash;
+}
+
+/**
+ *  Runs the benchmark and writes the report
+ *
+ *  @param options - benchmark settings
+ *
+ *  @return returns the process exit code
+ */
+int runBenchmark(const BenchOptions& options) {
+    srand(options.seed);
+
+    Camera* cameraAdress = new Camera();
+    Scene scene(cameraAdress);
+    scene.setInvulnerable(true);     //A ghost hit must not end the run early
+    JobSystem jobs(options.workers);
+    scene.setJobSystem(&jobs);
+    jobs.report();
+
+    AssetPipeline assets;
+    scene.startLoading(assets, options.level);
+    {
+        StageTimer stage(assets, "headless GL context");
+        if (!createHeadlessContext()) { return EXIT_FAILURE; }
+    }
+    scene.finishLoading(assets);
+    assets.report();
+
+    //Offscreen target, the headless context has no default framebuffer
+    GLuint framebuffer, colorBuffer, depthBuffer;
+    glGenFramebuffers(1, &framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+    glGenRenderbuffers(1, &colorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, colorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, options.width, options.height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, colorBuffer);
+    glGenRenderbuffers(1, &depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, options.width, options.height);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, depthBuffer);
+    if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE) {
+        std::cerr << "Benchmark framebuffer is incomplete." << '\n';
+        return EXIT_FAILURE;
+    }
+    glViewport(0, 0, options.width, options.height);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+    RenderStats::setPipelineStats(true);
+
+    std::vector<double> frameMs, drawCalls, triangles, stateChanges, uploadBytes, gsPrimitives, arenaBytes;
+    frameMs.reserve(options.frames);
+    drawCalls.reserve(options.frames);
+    triangles.reserve(options.frames);
+    stateChanges.reserve(options.frames);
+    uploadBytes.reserve(options.frames);
+    gsPrimitives.reserve(options.frames);
+    arenaBytes.reserve(options.frames);
+
+    for (int frame = 0; frame < options.warmup + options.frames; frame++) {
+        auto start = std::chrono::steady_clock::now();
+
+        //Scripted run: key presses on a fixed cycle, the camera turns with the frame number
+        if (frame % inputInterval == 0) { cameraAdress->setNewDesDir(scriptDirs[(frame / inputInterval) % 4]); }
+        cameraAdress->setYawPitch(180.0f + 360.0f * float(frame % turnFrames) / turnFrames, -10.0f);
+
+        scene.tick(benchTick);
+        scene.updatePellets();
+        RenderStats::beginFrame(true);
+        scene.render(frame * benchTick);
+        RenderStats::Frame stats = RenderStats::endFrame();
+        glFinish();
+        FlightRecorder::frameMark(false);
+        ALLOC_FRAME_MARK(frame >= options.warmup);
+        Arena::frame().reset();
+
+        double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        if (frame < options.warmup) { continue; }
+        frameMs.push_back(ms);
+        drawCalls.push_back(stats.drawCalls);
+        triangles.push_back(double(stats.primitives));
+        stateChanges.push_back(stats.programBinds + stats.vertexArrayBinds + stats.textureBinds);
+        uploadBytes.push_back(double(stats.uploadBytes));
+        if (0 <= stats.gsPrimitives) { gsPrimitives.push_back(double(stats.gsPrimitives)); }
+        arenaBytes.push_back(double(Arena::frame().getLastUsed()));
+    }
+    uint64_t imageHash = hashFramebuffer(options.width, options.height);
+
+    FILE* out = fopen(options.output.c_str(), "w");
+    if (!out) {
+        printf("Could not write %s\n", options.output.c_str());
+        return EXIT_FAILURE;
+    }
+    GpuTimer& gpuTimer = scene.getGpuTimer();
+    fprintf(out, "{\n");
+    fprintf(out, "  \"renderer\": \"%s\",\n", headlessRenderer().c_str());
+    fprintf(out, "  \"level\": \"%s\",\n", options.level.c_str());
+    fprintf(out, "  \"frames\": %i,\n  \"warmup\": %i,\n  \"width\": %i,\n  \"height\": %i,\n  \"seed\": %u,\n  \"workers\": %i,\n",
+            options.frames, options.warmup, options.width, options.height, options.seed, jobs.getWorkerCount());
+    writeDistribution(out, "frameMs", frameMs, ",");
+    writeDistribution(out, "drawCalls", drawCalls, ",");
+    writeDistribution(out, "triangles", triangles, ",");
+    writeDistribution(out, "stateChanges", stateChanges, ",");
+    writeDistribution(out, "uploadBytes", uploadBytes, ",");
+    writeDistribution(out, "pelletGsPrimitives", gsPrimitives, ",");
+    writeDistribution(out, "frameArenaBytes", arenaBytes, ",");
+    fprintf(out, "  \"gpuMs\": {\"map\": %.4f, \"pellets\": %.4f, \"ghosts\": %.4f},\n",
+            gpuTimer.getAverageMs(scene.getMapPass()), gpuTimer.getAverageMs(scene.getPelletPass()),
+            gpuTimer.getAverageMs(scene.getGhostPass()));
+    fprintf(out, "  \"pelletsEaten\": %i,\n  \"ghostHits\": %i,\n", scene.getPelletsEaten(), scene.getGhostHits());
+    fprintf(out, "  \"imageHash\": \"%016llx\"\n}\n", (unsigned long long)imageHash);
+    fclose(out);
+    printf("Benchmark written to %s\n", options.output.c_str());
+    Arena::frame().report();
+    Arena::level().report();
+
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteRenderbuffers(1, &colorBuffer);
+    glDeleteRenderbuffers(1, &depthBuffer);
+    glDeleteFramebuffers(1, &framebuffer);
+    scene.cleanScene();
+    RenderStats::cleanRenderStats();
+    destroyHeadlessContext();
+    delete cameraAdress;
+    return EXIT_SUCCESS;
+}
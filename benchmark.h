@@ -0,0 +1,36 @@
+/**
+ *   Header for the headless render benchmark.
+ *
+ *   `Pacman --bench` loads the level into a headless context, renders a
+ *   scripted run through it into an offscreen framebuffer and writes frame
+ *   time percentiles, draw calls and triangle counts as JSON. Input, ghost
+ *   decisions and animation time all come from the frame number and the
+ *   seed, so every run draws the same frames.
+ *
+ *   @file     benchmark.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __BENCHMARK_H
+#define __BENCHMARK_H
+
+#include <string>
+
+/**
+ *  Benchmark settings, filled from the command line
+ */
+struct BenchOptions {
+    int         frames = 600,           //Measured frames
+                warmup = 60,            //Frames rendered before measuring
+                width  = 1000,
+                height = 1000;
+    unsigned    seed   = 1;             //rand() seed, picks ghost spawns and ghost turns
+    int         workers = 0;            //JobSystem workers for the game and the benchmark, 0 picks one per hardware thread
+    std::string level  = "../../../../levels/level0";
+    std::string output = "bench_result.json";
+};
+
+bool parseBenchOption(int& arg, int argc, char** argv, BenchOptions& options);
+int  runBenchmark(const BenchOptions& options);
+
+#endif
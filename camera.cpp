@@ -100,8 +100,19 @@ void Camera::mouseMoveCamera(const double xpos, const double ypos) {
     xoffset *= sensitivity;
     yoffset *= sensitivity;
 
-    yaw += xoffset;
-    pitch += yoffset;
+    setYawPitch(yaw + xoffset, pitch + yoffset);
+}
+
+/**
+ *  Points the camera, used by the mouse and by scripted camera paths
+ *
+ *  @param newYaw   - rotation around the map normal in degrees
+ *  @param newPitch - rotation up from the map in degrees, clamped to +-89
+ *
+ */
+void Camera::setYawPitch(const float newYaw, const float newPitch) {
+    yaw = newYaw;
+    pitch = newPitch;
 
     // make sure that when pitch is out of bounds, screen doesn't get flipped
     if (pitch > 89.0f)
@@ -9,6 +9,7 @@
 #define __CAMERA_H
 
 #include "include.h"
+#include "inputQueue.h"
 
  // -----------------------------------------------------------------------------
  // Camera Class header
@@ -30,8 +31,7 @@ private:
     int screenWidth = 1000,
         screenHeight = 1000;
 
-    bool  keyCalled = false;
-    int   pacDesDir = 2;
+    InputQueue desDirQueue;             //Filled by key_callback, drained by the simulation tick
 public:
     Camera() {};
     glm::vec3 getCamPos()   { return cameraPos; };
@@ -46,13 +46,14 @@ public:
     int     getCard()             { return pacCard;       };
     void    setCard(int newCard)  { pacCard = newCard;    }
     int     getCamMapVal(int x, int y) {  return mapHolder[y][x]; };
-    int     getNewDesDir() { if (keyCalled) { keyCalled = false; return pacDesDir; } else return -10; };
-    void    setNewDesDir(int newDir) { pacDesDir = newDir; keyCalled = true; }
+    InputQueue& getDesDirQueue()  { return desDirQueue;   };
+    void    setNewDesDir(int newDir) { desDirQueue.push(newDir); }
     int     checkCardinal(const float xRot, const float yRot);
     GLfloat getCoordsWithInt(int y, int x, int loop, float layer, std::pair<float, float> shift);
     void    applycamera(const GLuint shader, const float width, const float height);
     void    recieveMap(std::vector<std::vector<int>> valueMap) { mapHolder = valueMap; }
     void    mouseMoveCamera(const double xpos, const double ypos);
+    void    setYawPitch(const float newYaw, const float newPitch);
     std::pair<int, int> getScreenSize() { std::pair<int, int> wh = { screenWidth, screenHeight }; return wh; }
 };
 
@@ -55,10 +55,12 @@ void Character::convertToVert() {
  *  @param    dir  - pacmans requested direction
  * 
  *  @see      Camera::getCamMapVal(int x, int y)
+ *  @see      NavGraph::canMove(int x, int y, int dir)
  * 
  *  @return   bool whether is is a legal direction or not
  */
 bool Character::getLegalDir(int dir) {
+    if (nav) { return nav->canMove(XYpos[0], XYpos[1], dir); }   //Precomputed mask, same rules as below
     int testPos[2] = { XYpos[0], XYpos[1] };
 
     switch (dir) {
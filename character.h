@@ -10,6 +10,7 @@
 
 #include "globFunc.h"
 #include "camera.h"
+#include "navGraph.h"
  // -----------------------------------------------------------------------------
  // Classes
  // -----------------------------------------------------------------------------
@@ -26,6 +27,7 @@ protected:
             speedDiv = 15.0f,           //Higher number = slower speed
             lerpStep = 1.0f / speedDiv, //Speed of LERP, also slowed by frequency in main
             lerpProg = lerpStep;        //defines progress as step to avoid hickups
+    static constexpr float lerpTick = 0.015f;   //Seconds per lerpStep, the speeds were tuned for a 15 ms tick
 
     int     dir,                        //Direction character is heading
             prevDir,                    //Previous direction character was heading
@@ -34,22 +36,18 @@ protected:
     bool    animFlip = true;            //For ghosts flipflops between frames for pac decides which direction to animate
     GLfloat vertices[4 * 5] = { 0.0f }; //Holds character vertices,  X Y Z T1 T2
     GLuint  shaderProgram,
-            characterVAO,
-            textureSheet;
+            characterVAO;
+    int     textureLayer = 0;           //Layer in the TextureArray
     std::pair<float, float> XYshift{ 0,0 };
     std::pair<int, int> WidthHeight{ 0,0 };
     //Ghost values
     bool    AI = false;                 //Decides whether object is pacman or ghost
 
     Camera* CamHolder;
+    NavGraph* nav = nullptr;            //Legal moves come from here once set, see setNavGraph
 public:
     Character() {};
-    ~Character() {
-        delete vertices;
-        delete XYpos;
-        delete lerpStart;
-        delete lerpStop;
-    };
+    ~Character() {};
 
     //Initialization functions
     virtual void changeDir();
@@ -63,6 +61,7 @@ public:
     void    cleanCharacter();
     void    setShader(const GLuint shaderProg);
     void    setVAO(const GLuint vao);
+    void    setTextureLayer(const int layer) { textureLayer = layer; };
     GLuint  getShader();
     GLuint  getVAO();
     void    callCleanVAO()  { if (characterVAO) CleanVAO(characterVAO); };
@@ -72,6 +71,10 @@ public:
     void    setXYshift(std::pair<float, float> XYvalues)    { XYshift = XYvalues; };
     void    setWidthHeight(std::pair<int, int> widthHeidht) { WidthHeight = widthHeidht; };
     void    getCameraPointer(Camera* newCamera)             { CamHolder = newCamera; };
+    void    setNavGraph(NavGraph* graph)                    { nav = graph; };
+    int     getDir()        { return dir; };
+    float   getLerpStep()   { return lerpStep; };
+    float   getTilesPerSecond() { return lerpStep / lerpTick; };
     std::pair<int, int> getXY() { std::pair<int, int> temp= { XYpos[0], XYpos[1] }; return temp; }
 };
 
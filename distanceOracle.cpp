@@ -0,0 +1,226 @@
+/**
+ *   DistanceOracle, all pairs shortest paths over the legal move masks
+ *
+ *   Table rows are built by breadth first search from each source. The
+ *   first move is inherited along the search tree, and because the queue
+ *   is seeded in direction order it is always the lowest direction index
+ *   among the shortest ways, the same move a fallback field picks.
+ *
+ *   @file     distanceOracle.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "distanceOracle.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+static const int directions[4] = { 2, 4, 3, 9 };   //By direction index, as NavGraph::indexOf
+static const int stepX[4]      = { 0, 0, -1, 1 },
+                 stepY[4]      = { 1, -1, 0, 0 };
+
+/**
+ *  Returns the compact index of a tile, -1 for walls and tiles outside the map
+ */
+int DistanceOracle::index(int x, int y) {
+    if (x < 0 || y < 0 || width <= x || int(tileIndex.size()) <= y * width + x) { return -1; }
+    return tileIndex[y * width + x];
+}
+
+/**
+ *  Builds the table, or prepares the fallback when the level is too big for one
+ *
+ *  @param nav           - graph whose masks define the legal moves
+ *  @param maxTableTiles - most walkable tiles a full table is built for
+ *  @param threads       - worker threads for the table, 0 for one per core
+ */
+void DistanceOracle::build(NavGraph& nav, int maxTableTiles, int threads) {
+    auto start = std::chrono::steady_clock::now();
+    std::pair<int, int> size = nav.getWidthHeight();
+    width = size.first;
+
+    //Walkable tiles are nodes or corridor pieces, both have at least one exit
+    tileIndex.assign(size_t(size.first) * size.second, -1);
+    indexTile.clear();
+    for (int y = 0; y < size.second; y++) {
+        for (int x = 0; x < size.first; x++) {
+            if (nav.legalMask(x, y) == 0) { continue; }
+            tileIndex[y * width + x] = int(indexTile.size());
+            indexTile.push_back(y * width + x);
+        }
+    }
+    tileCount = int(indexTile.size());
+    neighbors.assign(size_t(tileCount) * 4, -1);
+    for (int i = 0; i < tileCount; i++) {
+        int x = indexTile[i] % width,
+            y = indexTile[i] / width;
+        for (int d = 0; d < 4; d++) {
+            if (nav.canMove(x, y, directions[d])) { neighbors[i * 4 + d] = index(x + stepX[d], y + stepY[d]); }
+        }
+    }
+
+    table = (tileCount <= maxTableTiles);
+    hops.clear();   hops.shrink_to_fit();
+    dist8.clear();  dist8.shrink_to_fit();
+    dist16.clear(); dist16.shrink_to_fit();
+    for (auto& field : fields) { field.target = -1; field.dist.clear(); }
+    nextField   = 0;
+    threadsUsed = 0;
+
+    if (table) {
+        hopStride = (tileCount + 3) / 4;
+        hops.assign(size_t(hopStride) * tileCount, 0);
+        std::vector<uint16_t> rows(size_t(tileCount) * tileCount, unreached);
+
+        //Rows are independent and each worker writes only its own
+        int hardware = int(std::thread::hardware_concurrency());
+        threadsUsed  = (0 < threads) ? threads : std::max(1, hardware);
+        threadsUsed  = std::max(1, std::min(threadsUsed, (tileCount + 63) / 64));
+        std::vector<std::thread> workers;
+        for (int w = 1; w < threadsUsed; w++) {
+            workers.emplace_back([this, w, &rows]() { buildRows(w, threadsUsed, rows); });
+        }
+        buildRows(0, threadsUsed, rows);
+        for (auto& worker : workers) { worker.join(); }
+
+        //A byte per pair when the longest shortest path allows it
+        uint16_t longest = 0;
+        for (uint16_t d : rows) { if (d != unreached) { longest = std::max(longest, d); } }
+        if (longest < 0xFF) {
+            dist8.resize(rows.size());
+            for (size_t p = 0; p < rows.size(); p++) { dist8[p] = (rows[p] == unreached) ? 0xFF : uint8_t(rows[p]); }
+        }
+        else { dist16.swap(rows); }
+    }
+    buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ *  Searches from every source first, first + step, ... and fills their rows
+ *
+ *  @param first - first source
+ *  @param step  - distance between sources, the worker count
+ *  @param rows  - tileCount * tileCount distances, unreached on entry
+ */
+void DistanceOracle::buildRows(int first, int step, std::vector<uint16_t>& rows) {
+    std::vector<int>     queue(tileCount);
+    std::vector<uint8_t> firstMove(tileCount);
+    for (int source = first; source < tileCount; source += step) {
+        uint16_t* row = &rows[size_t(source) * tileCount];
+        int head = 0, tail = 0;
+        row[source] = 0;
+        queue[tail++] = source;
+        while (head < tail) {
+            int from = queue[head++];
+            for (int d = 0; d < 4; d++) {
+                int to = neighbors[from * 4 + d];
+                if (to < 0 || row[to] != unreached) { continue; }
+                row[to]       = row[from] + 1;
+                firstMove[to] = (from == source) ? uint8_t(d) : firstMove[from];
+                queue[tail++] = to;
+            }
+        }
+        uint8_t* hopRow = &hops[size_t(source) * hopStride];
+        for (int to = 0; to < tileCount; to++) {
+            if (row[to] != unreached && to != source) { hopRow[to >> 2] |= uint8_t(firstMove[to] << ((to & 3) * 2)); }
+        }
+    }
+}
+
+/**
+ *  Returns the distance field toward a target, searching it if it is not cached
+ *
+ *  @param target - compact index of the target
+ */
+DistanceOracle::Field& DistanceOracle::fieldFor(int target) {
+    for (auto& field : fields) {
+        if (field.target == target) { return field; }
+    }
+    Field& field = fields[nextField];
+    nextField = (nextField + 1) % fieldCacheSize;
+    field.target = target;
+    field.dist.assign(tileCount, unreached);
+
+    //Backwards from the target, a tile is one further than any tile it can step onto
+    std::vector<int> queue(tileCount);
+    int head = 0, tail = 0;
+    field.dist[target] = 0;
+    queue[tail++] = target;
+    while (head < tail) {
+        int to = queue[head++],
+            x  = indexTile[to] % width,
+            y  = indexTile[to] / width;
+        for (int d = 0; d < 4; d++) {
+            int from = index(x - stepX[d], y - stepY[d]);
+            if (from < 0 || neighbors[from * 4 + d] != to || field.dist[from] != unreached) { continue; }
+            field.dist[from] = field.dist[to] + 1;
+            queue[tail++] = from;
+        }
+    }
+    return field;
+}
+
+/**
+ *  Returns the number of moves on a shortest path
+ *
+ *  @return returns -1 if either tile is a wall or there is no path
+ */
+int DistanceOracle::distance(int fromX, int fromY, int toX, int toY) {
+    int from = index(fromX, fromY),
+        to   = index(toX, toY);
+    if (from < 0 || to < 0) { return -1; }
+    if (table) {
+        size_t pair = size_t(from) * tileCount + to;
+        if (!dist8.empty()) { return (dist8[pair] == 0xFF) ? -1 : dist8[pair]; }
+        return (dist16[pair] == unreached) ? -1 : dist16[pair];
+    }
+    uint16_t d = fieldFor(to).dist[from];
+    return (d == unreached) ? -1 : d;
+}
+
+/**
+ *  Returns the first move of a shortest path
+ *
+ *  @return returns the direction to take, 0 if already there or there is no path
+ */
+int DistanceOracle::nextDir(int fromX, int fromY, int toX, int toY) {
+    int from = index(fromX, fromY),
+        to   = index(toX, toY);
+    if (from < 0 || to < 0 || from == to) { return 0; }
+    if (table) {
+        if (distance(fromX, fromY, toX, toY) < 0) { return 0; }
+        return directions[(hops[size_t(from) * hopStride + (to >> 2)] >> ((to & 3) * 2)) & 3];
+    }
+    Field& field = fieldFor(to);
+    if (field.dist[from] == unreached) { return 0; }
+    for (int d = 0; d < 4; d++) {
+        int next = neighbors[from * 4 + d];
+        if (0 <= next && field.dist[next] + 1 == field.dist[from]) { return directions[d]; }
+    }
+    return 0;
+}
+
+/**
+ *  Returns the bytes held by the table or the field cache and the tile lookups
+ */
+size_t DistanceOracle::getBytes() {
+    size_t bytes = (tileIndex.size() + indexTile.size() + neighbors.size()) * sizeof(int)
+                 + hops.size() + dist8.size() + dist16.size() * sizeof(uint16_t);
+    for (auto& field : fields) { bytes += field.dist.capacity() * sizeof(uint16_t); }
+    return bytes;
+}
+
+/**
+ *  Prints the mode, memory and build time
+ */
+void DistanceOracle::report() {
+    if (table) {
+        printf("Distance oracle: table for %d tiles, %s distances, %.1f KB, built in %.2f ms on %d threads\n",
+            tileCount, dist8.empty() ? "2 byte" : "1 byte", getBytes() / 1024.0, buildMs, threadsUsed);
+    }
+    else {
+        printf("Distance oracle: %d tiles is over the table limit, %d cached target fields of %.1f KB each\n",
+            tileCount, fieldCacheSize, tileCount * sizeof(uint16_t) / 1024.0);
+    }
+}
@@ -0,0 +1,77 @@
+/**
+ *   Header for the DistanceOracle class.
+ *
+ *   Shortest path distances and next moves between any two walkable tiles
+ *   of a level. Classic sized levels get a full table built at load time,
+ *   one breadth first search per tile spread over worker threads, so a
+ *   query is a lookup: 2 bits of next move and 1 or 2 bytes of distance
+ *   per pair. Levels with more walkable tiles than the table limit fall
+ *   back to distance fields toward single targets, built on first use and
+ *   kept in a small cache, so only the first query toward a target searches.
+ *
+ *   Moves follow the legal move masks of a NavGraph, the oracle must be
+ *   rebuilt when the graph is.
+ *
+ *   @file     distanceOracle.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __DISTANCEORACLE_H
+#define __DISTANCEORACLE_H
+
+#include "navGraph.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+ // -----------------------------------------------------------------------------
+ // DistanceOracle Class header
+ // -----------------------------------------------------------------------------
+class DistanceOracle {
+public:
+    static const int defaultTableTiles = 2048,  //4M pairs, up to 9 MB of table
+                     fieldCacheSize    = 8;     //Targets kept in fallback mode
+
+private:
+    static constexpr uint16_t unreached = 0xFFFF;
+
+    /**
+     *  Distances from every tile to one target, fallback mode only
+     */
+    struct Field {
+        int target = -1;
+        std::vector<uint16_t> dist;
+    };
+
+    int width = 0;
+    int tileCount = 0;
+    std::vector<int>      tileIndex,        //Compact index of a map tile, -1 for walls
+                          indexTile,        //Map tile of a compact index
+                          neighbors;        //Compact index reached from index * 4 + direction index, -1 if none
+    bool table = false;
+    int  hopStride = 0;                     //Bytes per table row
+    std::vector<uint8_t>  hops,             //Direction index of the first move, 2 bits per pair
+                          dist8;            //Pair distances when the longest path fits a byte
+    std::vector<uint16_t> dist16;           //Pair distances otherwise
+    Field fields[fieldCacheSize];
+    int   nextField = 0;
+    int   threadsUsed = 0;
+    double buildMs = 0.0;
+
+    void  buildRows(int first, int step, std::vector<uint16_t>& rows);
+    Field& fieldFor(int target);
+    int   index(int x, int y);
+
+public:
+    void    build(NavGraph& nav, int maxTableTiles = defaultTableTiles, int threads = 0);
+    void    report();
+    int     distance(int fromX, int fromY, int toX, int toY);
+    int     nextDir(int fromX, int fromY, int toX, int toY);
+
+    bool    hasTable()          { return table; };
+    int     getTileCount()      { return tileCount; };
+    size_t  getBytes();
+    double  getBuildMs()        { return buildMs; };
+};
+
+#endif
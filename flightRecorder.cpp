@@ -0,0 +1,152 @@
+/**
+ *   FlightRecorder, frame ring buffer dumped on frame time spikes
+ *
+ *   @file     flightRecorder.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "flightRecorder.h"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <thread>
+#include <vector>
+
+static const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+static FlightRecorder::Event events[FlightRecorder::eventCapacity];
+static uint32_t     written = 0;                //Total events ever recorded, wraps the ring
+static thread_local bool recorderThread = false;//Only the attached thread records
+
+static int64_t      budgetNs   = 33000000;      //Frames longer than this are dumped
+static int64_t      windowNs   = 5000000000;    //How far back a dump reaches
+static int64_t      lastFrame  = -1;
+static int64_t      lastDump   = -1;            //Dumps are spaced at least one window apart
+static uint64_t     frameCount = 0;
+static std::thread  writer;
+
+/**
+ *  Nanoseconds since the program started, shared with the profiler
+ */
+int64_t FlightRecorder::now() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+/**
+ *  Makes the calling thread the one that is recorded, call once from the main thread
+ */
+void FlightRecorder::attachThread() {
+    recorderThread = true;
+}
+
+/**
+ *  Sets when a dump happens and how much it covers
+ *
+ *  @param budgetMs      - frame time that triggers a dump
+ *  @param windowSeconds - seconds of history written per dump
+ */
+void FlightRecorder::configure(float budgetMs, float windowSeconds) {
+    budgetNs = int64_t(budgetMs * 1000000.0);
+    windowNs = int64_t(windowSeconds * 1000000000.0);
+}
+
+/**
+ *  Stores a finished zone
+ *
+ *  @param name    - zone name, must be a string literal
+ *  @param startNs - start from FlightRecorder::now()
+ *  @param stopNs  - stop from FlightRecorder::now()
+ */
+void FlightRecorder::record(const char* name, int64_t startNs, int64_t stopNs) {
+    if (!recorderThread) { return; }
+    Event& event = events[written % eventCapacity];
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = stopNs - startNs;
+    written++;
+}
+
+/**
+ *  Stores an instant gameplay event, like a pellet being eaten
+ *
+ *  @param name - event name, must be a string literal
+ */
+void FlightRecorder::event(const char* name) {
+    int64_t time = now();
+    record(name, time, time - 1);
+}
+
+/**
+ *  Ends a frame, call right after the buffer swap. Dumps the history if the frame was over budget
+ *
+ *  @param checkBudget - false for frames that were meant to be slow, like throttled background frames
+ *
+ *  @return returns true if a dump was started
+ */
+bool FlightRecorder::frameMark(bool checkBudget) {
+    int64_t time = now();
+    frameCount++;
+    if (lastFrame < 0) { lastFrame = time; return false; }
+
+    int64_t frameNs = time - lastFrame;
+    record("frame", lastFrame, time);
+    lastFrame = time;
+
+    if (checkBudget && frameNs > budgetNs && (lastDump < 0 || time - lastDump > windowNs)) {
+        lastDump = time;
+        char filepath[64];
+        snprintf(filepath, sizeof(filepath), "hitch_frame%llu.json", (unsigned long long)frameCount);
+        printf("Frame %llu took %.2f ms, over the %.2f ms budget, writing %s\n", (unsigned long long)frameCount,
+               frameNs / 1000000.0, budgetNs / 1000000.0, filepath);
+        dump(filepath);
+        return true;
+    }
+    return false;
+}
+
+/**
+ *  Writes the last window of events as Chrome trace JSON on a writer thread
+ *
+ *  @param filepath - file to write
+ */
+void FlightRecorder::dump(const std::string& filepath) {
+    int64_t from = now() - windowNs;
+    uint32_t count = (written < eventCapacity) ? written : eventCapacity;
+
+    //Copying is cheap, only the file writing is moved off the main thread
+    std::vector<Event> copy;
+    copy.reserve(count);
+    for (uint32_t i = written - count; i != written; i++) {
+        const Event& event = events[i % eventCapacity];
+        if (event.startNs >= from) { copy.push_back(event); }
+    }
+
+    if (writer.joinable()) { writer.join(); }
+    writer = std::thread([filepath, copy]() {
+        std::ofstream out(filepath);
+        if (!out) { printf("Could not write %s\n", filepath.c_str()); return; }
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"main\"}}";
+        char line[256];
+        for (auto& event : copy) {
+            if (event.durationNs < 0) {
+                snprintf(line, sizeof(line), ",\n{\"ph\":\"i\",\"s\":\"t\",\"name\":\"%s\",\"pid\":1,\"tid\":0,\"ts\":%.3f}",
+                         event.name, event.startNs / 1000.0);
+            }
+            else {
+                snprintf(line, sizeof(line), ",\n{\"ph\":\"X\",\"name\":\"%s\",\"pid\":1,\"tid\":0,\"ts\":%.3f,\"dur\":%.3f}",
+                         event.name, event.startNs / 1000.0, event.durationNs / 1000.0);
+            }
+            out << line;
+        }
+        out << "\n]}\n";
+    });
+}
+
+/**
+ *  Waits for a dump that is still being written, call before exiting
+ */
+void FlightRecorder::shutdown() {
+    if (writer.joinable()) { writer.join(); }
+}
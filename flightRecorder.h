@@ -0,0 +1,64 @@
+/**
+ *   Header for the FlightRecorder class.
+ *
+ *   Always on recorder for main thread zones and gameplay events. Events go
+ *   into a fixed size ring that is never resized, recording one is a clock
+ *   read and a store. When a frame goes over budget the last few seconds of
+ *   the ring are copied out and written as Chrome trace JSON on a writer
+ *   thread, so intermittent hitches leave a trace behind without anyone
+ *   having to start the profiler.
+ *
+ *   Zones from PROFILE_ZONE are recorded here whether or not the profiler is
+ *   compiled in.
+ *
+ *   @file     flightRecorder.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __FLIGHTRECORDER_H
+#define __FLIGHTRECORDER_H
+
+#include <cstdint>
+#include <string>
+
+ // -----------------------------------------------------------------------------
+ // FlightRecorder Class header
+ // -----------------------------------------------------------------------------
+class FlightRecorder {
+public:
+    static const uint32_t eventCapacity = 1 << 15;  //About 10 seconds of frames with ~20 zones each
+
+    /**
+     *  One zone, frame or instant event, name must be a string literal
+     */
+    struct Event {
+        const char* name;
+        int64_t     startNs,
+                    durationNs;     //-1 marks an instant event
+    };
+
+    static int64_t now();
+    static void    attachThread();
+    static void    configure(float budgetMs, float windowSeconds);
+    static void    record(const char* name, int64_t startNs, int64_t stopNs);
+    static void    event(const char* name);
+    static bool    frameMark(bool checkBudget = true);
+    static void    dump(const std::string& filepath);
+    static void    shutdown();
+};
+
+/**
+ *  Records the lifetime of the enclosing scope in the flight recorder
+ */
+class FlightZone {
+private:
+    const char* name;
+    int64_t     start;
+public:
+    FlightZone(const char* zoneName) : name(zoneName), start(FlightRecorder::now()) {};
+    ~FlightZone() { FlightRecorder::record(name, start, FlightRecorder::now()); };
+};
+
+#define FLIGHT_EVENT(name)  FlightRecorder::event(name)
+
+#endif
@@ -0,0 +1,359 @@
+/**
+ *   FloodFill, bitboard flood fill and connected components of a level
+ *
+ *   Runs of open tiles are filled with Kogge-Stone shifts, six shift and
+ *   mask steps cover a 64 tile word in both directions. The SSE2 kernel
+ *   does two words per step, runs that cross a word boundary are carried
+ *   over by a scalar pass afterwards, so both paths give the same boards.
+ *
+ *   @file     floodFill.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "floodFill.h"
+#include "map.h"
+#include <algorithm>
+#include <bitset>
+#include <chrono>
+#include <cstdio>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define FLOOD_SSE2 1
+#endif
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+/**
+ *  Returns the index of the lowest set bit, bits must not be 0
+ */
+static inline int lowestBit(uint64_t bits) {
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return int(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+}
+
+/**
+ *  Fills every run of open bits that holds a seed toward the high bits
+ */
+static inline uint64_t spreadUp(uint64_t seed, uint64_t open) {
+    seed |= open & (seed << 1);     open &= open << 1;
+    seed |= open & (seed << 2);     open &= open << 2;
+    seed |= open & (seed << 4);     open &= open << 4;
+    seed |= open & (seed << 8);     open &= open << 8;
+    seed |= open & (seed << 16);    open &= open << 16;
+    return seed | (open & (seed << 32));
+}
+
+/**
+ *  Fills every run of open bits that holds a seed toward the low bits
+ */
+static inline uint64_t spreadDown(uint64_t seed, uint64_t open) {
+    seed |= open & (seed >> 1);     open &= open >> 1;
+    seed |= open & (seed >> 2);     open &= open >> 2;
+    seed |= open & (seed >> 4);     open &= open >> 4;
+    seed |= open & (seed >> 8);     open &= open >> 8;
+    seed |= open & (seed >> 16);    open &= open >> 16;
+    return seed | (open & (seed >> 32));
+}
+
+#if FLOOD_SSE2
+/**
+ *  spreadUp() and spreadDown() together on two words at once
+ */
+static inline __m128i spreadBoth(__m128i seed, __m128i open) {
+    __m128i up = seed, upOpen = open,
+            down = seed, downOpen = open;
+    up   = _mm_or_si128(up,   _mm_and_si128(upOpen,   _mm_slli_epi64(up, 1)));     upOpen   = _mm_and_si128(upOpen,   _mm_slli_epi64(upOpen, 1));
+    down = _mm_or_si128(down, _mm_and_si128(downOpen, _mm_srli_epi64(down, 1)));   downOpen = _mm_and_si128(downOpen, _mm_srli_epi64(downOpen, 1));
+    up   = _mm_or_si128(up,   _mm_and_si128(upOpen,   _mm_slli_epi64(up, 2)));     upOpen   = _mm_and_si128(upOpen,   _mm_slli_epi64(upOpen, 2));
+    down = _mm_or_si128(down, _mm_and_si128(downOpen, _mm_srli_epi64(down, 2)));   downOpen = _mm_and_si128(downOpen, _mm_srli_epi64(downOpen, 2));
+    up   = _mm_or_si128(up,   _mm_and_si128(upOpen,   _mm_slli_epi64(up, 4)));     upOpen   = _mm_and_si128(upOpen,   _mm_slli_epi64(upOpen, 4));
+    down = _mm_or_si128(down, _mm_and_si128(downOpen, _mm_srli_epi64(down, 4)));   downOpen = _mm_and_si128(downOpen, _mm_srli_epi64(downOpen, 4));
+    up   = _mm_or_si128(up,   _mm_and_si128(upOpen,   _mm_slli_epi64(up, 8)));     upOpen   = _mm_and_si128(upOpen,   _mm_slli_epi64(upOpen, 8));
+    down = _mm_or_si128(down, _mm_and_si128(downOpen, _mm_srli_epi64(down, 8)));   downOpen = _mm_and_si128(downOpen, _mm_srli_epi64(downOpen, 8));
+    up   = _mm_or_si128(up,   _mm_and_si128(upOpen,   _mm_slli_epi64(up, 16)));    upOpen   = _mm_and_si128(upOpen,   _mm_slli_epi64(upOpen, 16));
+    down = _mm_or_si128(down, _mm_and_si128(downOpen, _mm_srli_epi64(down, 16)));  downOpen = _mm_and_si128(downOpen, _mm_srli_epi64(downOpen, 16));
+    up   = _mm_or_si128(up,   _mm_and_si128(upOpen,   _mm_slli_epi64(up, 32)));
+    down = _mm_or_si128(down, _mm_and_si128(downOpen, _mm_srli_epi64(down, 32)));
+    return _mm_or_si128(up, down);
+}
+#endif
+
+/**
+ *  Grows part of one row of a board from itself and the rows next to it,
+ *  filling every run of open tiles that is touched. Runs that go on past
+ *  the part are followed into the words beside it.
+ *
+ *  @param board - board being flooded
+ *  @param y     - row to grow
+ *  @param first - first word to look at, receives the first word that changed
+ *  @param last  - last word to look at, receives the last word that changed
+ *
+ *  @return returns true if the row gained tiles
+ */
+bool FloodFill::fillRow(std::vector<uint64_t>& board, int y, int& first, int& last) {
+    uint64_t*       row   = &board[size_t(y + 1) * stride + 1];
+    const uint64_t* above = row + stride,
+                  * below = row - stride,
+                  * mask  = &open[size_t(y + 1) * stride + 1];
+    uint64_t*       grown = rowScratch.data();
+    int i = first;
+#if FLOOD_SSE2
+    for (; i + 1 <= last; i += 2) {
+        __m128i p = _mm_loadu_si128((const __m128i*)(mask + i)),
+                s = _mm_or_si128(_mm_loadu_si128((const __m128i*)(row + i)),
+                    _mm_or_si128(_mm_loadu_si128((const __m128i*)(above + i)), _mm_loadu_si128((const __m128i*)(below + i))));
+        _mm_storeu_si128((__m128i*)(grown + i), spreadBoth(_mm_and_si128(s, p), p));
+    }
+#endif
+    for (; i <= last; i++) {
+        uint64_t s = (row[i] | above[i] | below[i]) & mask[i];
+        grown[i] = spreadUp(s, mask[i]) | spreadDown(s, mask[i]);
+    }
+
+    //Runs that go on into the next word, a run already in the board is filled all the way
+    int from = first, to = last;
+    for (i = from + 1; i <= to; i++) {
+        if ((grown[i - 1] >> 63) & mask[i] & ~grown[i] & 1) { grown[i] |= spreadUp(1, mask[i]); }
+    }
+    while (to + 1 < words && (grown[to] >> 63) && (mask[to + 1] & ~row[to + 1] & 1)) {
+        to++;
+        grown[to] = row[to] | spreadUp(1, mask[to]);
+    }
+    for (i = to - 1; from <= i; i--) {
+        if ((grown[i + 1] & 1) && ((mask[i] & ~grown[i]) >> 63)) { grown[i] |= spreadDown(uint64_t(1) << 63, mask[i]); }
+    }
+    while (0 < from && (grown[from] & 1) && ((mask[from - 1] & ~row[from - 1]) >> 63)) {
+        from--;
+        grown[from] = row[from] | spreadDown(uint64_t(1) << 63, mask[from]);
+    }
+
+    first = words;
+    last  = -1;
+    for (i = from; i <= to; i++) {
+        if (grown[i] != row[i]) {
+            row[i] = grown[i];
+            first  = std::min(first, i);
+            last   = i;
+        }
+    }
+    return 0 <= last;
+}
+
+/**
+ *  Marks words of a row as part of the last flood
+ */
+void FloodFill::touch(int y, int first, int last) {
+    if (touchedFirst[y] < 0) {
+        touchedRows.push_back(y);
+        touchedFirst[y] = first;
+        touchedLast[y]  = last;
+    }
+    touchedFirst[y] = std::min(touchedFirst[y], first);
+    touchedLast[y]  = std::max(touchedLast[y], last);
+}
+
+/**
+ *  Floods the component of a tile into a board that is empty around it.
+ *  Rows wait in a work list with the words that changed next to them, a
+ *  row is only filled again where a neighbor gained tiles.
+ *
+ *  @param x, y  - tile to start from
+ *  @param board - receives the component, the rows and words it covers
+ *                 are left in touchedRows, touchedFirst and touchedLast
+ *
+ *  @return returns the tiles in the component, 0 if the tile is not open
+ */
+int FloodFill::flood(int x, int y, std::vector<uint64_t>& board) {
+    for (int row : touchedRows) { touchedFirst[row] = -1; }
+    touchedRows.clear();
+    if (!isOpen(x, y)) { return 0; }
+
+    auto push = [&](int row, int first, int last) {
+        if (row < 0 || height <= row) { return; }
+        if (pendingFirst[row] < 0) {
+            workList.push_back(row);
+            pendingFirst[row] = first;
+            pendingLast[row]  = last;
+        }
+        pendingFirst[row] = std::min(pendingFirst[row], first);
+        pendingLast[row]  = std::max(pendingLast[row], last);
+    };
+    int w = x >> 6;
+    set(board, x, y);
+    touch(y, w, w);
+    push(y - 1, w, w);
+    push(y, w, w);
+    push(y + 1, w, w);
+    while (!workList.empty()) {
+        int row = workList.back();
+        workList.pop_back();
+        int first = pendingFirst[row],
+            last  = pendingLast[row];
+        pendingFirst[row] = -1;
+        if (fillRow(board, row, first, last)) {
+            touch(row, first, last);
+            push(row - 1, first, last);
+            push(row + 1, first, last);
+        }
+    }
+
+    int count = 0;
+    for (int row : touchedRows) {
+        for (int i = touchedFirst[row]; i <= touchedLast[row]; i++) {
+            count += int(std::bitset<64>(board[size_t(row + 1) * stride + 1 + i]).count());
+        }
+    }
+    return count;
+}
+
+/**
+ *  Builds the walkable board and labels every connected component
+ *
+ *  @param map - loaded map, walls are 1
+ */
+void FloodFill::build(Map& map) {
+    auto start = std::chrono::steady_clock::now();
+    std::pair<int, int> size = map.getWidthHeight();
+    width  = size.first;
+    height = size.second;
+    words  = (width + 63) / 64;
+    stride = words + 2;
+    open.assign(size_t(stride) * (height + 2), 0);
+    for (int y = 0; y < height - 1; y++) {
+        for (int x = 0; x < width; x++) {
+            if (map.getMapVal(x, y) != 1) { set(open, x, y); }
+        }
+    }
+    rowScratch.assign(words, 0);
+    growScratch.assign(open.size(), 0);
+    pendingFirst.assign(height, -1);
+    pendingLast.assign(height, -1);
+    touchedFirst.assign(height, -1);
+    touchedLast.assign(height, -1);
+    touchedRows.clear();
+    workList.clear();
+
+    //Flood from the first tile nobody has reached yet until every open tile has a component
+    component.assign(size_t(width) * height, -1);
+    componentSize.clear();
+    std::vector<uint64_t> remaining = open,
+                          board(open.size(), 0);
+    for (int y = 0; y < height; y++) {
+        for (int i = 0; i < words; i++) {
+            uint64_t& rest = remaining[size_t(y + 1) * stride + 1 + i];
+            while (rest) {
+                int id    = getComponentCount(),
+                    count = flood(i * 64 + lowestBit(rest), y, board);
+                for (int row : touchedRows) {
+                    for (int w = touchedFirst[row]; w <= touchedLast[row]; w++) {
+                        size_t at = size_t(row + 1) * stride + 1 + w;
+                        uint64_t bits = board[at];
+                        remaining[at] &= ~bits;
+                        board[at] = 0;
+                        for (; bits; bits &= bits - 1) { component[size_t(row) * width + w * 64 + lowestBit(bits)] = id; }
+                    }
+                }
+                componentSize.push_back(count);
+            }
+        }
+    }
+    buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ *  Floods the component of a tile
+ *
+ *  @param x, y  - tile to start from
+ *  @param board - receives the component, resized to the map
+ *
+ *  @return returns the tiles in the component, 0 if the tile is not open
+ */
+int FloodFill::fill(int x, int y, std::vector<uint64_t>& board) {
+    board.assign(open.size(), 0);
+    return flood(x, y, board);
+}
+
+/**
+ *  Adds every open tile one move away from the board, a number of times.
+ *  Starting from one tile, the board then holds every tile at most that
+ *  many moves away.
+ *
+ *  @param board - board from emptyBoard() or fill()
+ *  @param steps - moves to grow by
+ */
+void FloodFill::grow(std::vector<uint64_t>& board, int steps) {
+    int lo = height, hi = -1;
+    for (int y = 0; y < height; y++) {
+        for (int i = 0; i < words; i++) {
+            if (board[size_t(y + 1) * stride + 1 + i]) { lo = std::min(lo, y); hi = y; }
+        }
+    }
+    if (hi < 0) { return; }
+
+    for (int step = 0; step < steps; step++) {
+        lo = std::max(0, lo - 1);
+        hi = std::min(height - 1, hi + 1);
+        for (int y = lo; y <= hi; y++) {
+            size_t first = size_t(y + 1) * stride + 1;
+            const uint64_t* row  = &board[first];
+            const uint64_t* mask = &open[first];
+            uint64_t*       next = &growScratch[first];
+            int i = 0;
+#if FLOOD_SSE2
+            for (; i + 2 <= words; i += 2) {
+                __m128i here = _mm_loadu_si128((const __m128i*)(row + i)),
+                        reach = _mm_or_si128(here, _mm_or_si128(_mm_loadu_si128((const __m128i*)(row + i + stride)),
+                                                                _mm_loadu_si128((const __m128i*)(row + i - stride))));
+                reach = _mm_or_si128(reach, _mm_or_si128(_mm_slli_epi64(here, 1), _mm_srli_epi64(_mm_loadu_si128((const __m128i*)(row + i - 1)), 63)));
+                reach = _mm_or_si128(reach, _mm_or_si128(_mm_srli_epi64(here, 1), _mm_slli_epi64(_mm_loadu_si128((const __m128i*)(row + i + 1)), 63)));
+                _mm_storeu_si128((__m128i*)(next + i), _mm_and_si128(reach, _mm_loadu_si128((const __m128i*)(mask + i))));
+            }
+#endif
+            for (; i < words; i++) {
+                uint64_t reach = row[i] | row[i + stride] | row[i - stride]
+                               | (row[i] << 1) | (row[i - 1] >> 63) | (row[i] >> 1) | (row[i + 1] << 63);
+                next[i] = reach & mask[i];
+            }
+        }
+        std::copy(growScratch.begin() + size_t(lo + 1) * stride, growScratch.begin() + size_t(hi + 2) * stride,
+                  board.begin() + size_t(lo + 1) * stride);
+    }
+}
+
+/**
+ *  Returns the bytes held by the boards, labels and scratch
+ */
+size_t FloodFill::getBytes() {
+    return (open.size() + rowScratch.size() + growScratch.size()) * sizeof(uint64_t)
+         + (component.size() + componentSize.size()) * sizeof(int)
+         + (pendingFirst.size() + pendingLast.size() + touchedFirst.size() + touchedLast.size()
+          + touchedRows.capacity() + workList.capacity()) * sizeof(int);
+}
+
+/**
+ *  Prints the components found and what they cost
+ */
+void FloodFill::report() {
+    int largest = 0, tiles = 0;
+    for (int count : componentSize) { largest = std::max(largest, count); tiles += count; }
+    printf("Flood fill: %d components, largest %d of %d open tiles, %.1f KB, built in %.2f ms (%s)\n",
+        getComponentCount(), largest, tiles, getBytes() / 1024.0, buildMs, kernelName());
+}
+
+/**
+ *  Returns the row kernel compiled in, for reports
+ */
+const char* FloodFill::kernelName() {
+#if FLOOD_SSE2
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
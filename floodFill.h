@@ -0,0 +1,85 @@
+/**
+ *   Header for the FloodFill class.
+ *
+ *   Reachability on the tile map with one bit per tile. Walkable tiles are
+ *   kept as row bitmasks, 64 tiles to a word, and a flood grows a whole
+ *   row at once: the rows above and below are or'ed in and runs of open
+ *   tiles are filled with shifts and masks, two words at a time with SSE2.
+ *   Rows wait in a work list and are only filled again where a neighbor
+ *   gained tiles, so the cost follows the runs of a component rather than
+ *   the size of the map, and small pockets of a huge map stay cheap.
+ *
+ *   build() labels every connected component, grow() expands a board one
+ *   move at a time to tell tiles near a spot from those further away.
+ *   Walkable follows Character::getLegalDir: anything but a wall, below
+ *   the top row.
+ *
+ *   @file     floodFill.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __FLOODFILL_H
+#define __FLOODFILL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class Map;
+
+ // -----------------------------------------------------------------------------
+ // FloodFill Class header
+ // -----------------------------------------------------------------------------
+class FloodFill {
+private:
+    int width  = 0,
+        height = 0,
+        words  = 0,                         //Words per row of tiles
+        stride = 0;                         //Words per row in a board, one zero word on each side
+    std::vector<uint64_t> open;             //Walkable tiles, rows of zero above and below
+    std::vector<int>      component,        //Component of a tile, -1 for walls
+                          componentSize;
+    double buildMs = 0.0;
+
+    //Fill scratch, sized at build
+    std::vector<uint64_t> rowScratch,
+                          growScratch;
+    std::vector<int>      pendingFirst,     //Words of a row waiting in workList, -1 if not waiting
+                          pendingLast,
+                          touchedFirst,     //Words of a row the last flood reached, -1 if none
+                          touchedLast,
+                          touchedRows,
+                          workList;
+
+    bool  fillRow(std::vector<uint64_t>& board, int y, int& first, int& last);
+    void  touch(int y, int first, int last);
+    int   flood(int x, int y, std::vector<uint64_t>& board);
+    int   word(int x, int y)    { return (y + 1) * stride + 1 + (x >> 6); };
+
+public:
+    void    build(Map& map);
+    void    report();
+    int     fill(int x, int y, std::vector<uint64_t>& board);
+    void    grow(std::vector<uint64_t>& board, int steps);
+
+    std::vector<uint64_t> emptyBoard()  { return std::vector<uint64_t>(open.size(), 0); };
+    bool    isSet(const std::vector<uint64_t>& board, int x, int y) {
+        if (x < 0 || y < 0 || width <= x || height <= y) { return false; }
+        return (board[word(x, y)] >> (x & 63)) & 1;
+    };
+    void    set(std::vector<uint64_t>& board, int x, int y) { board[word(x, y)] |= uint64_t(1) << (x & 63); };
+    bool    isOpen(int x, int y)            { return isSet(open, x, y); };
+    int     componentOf(int x, int y) {
+        if (x < 0 || y < 0 || width <= x || height <= y) { return -1; }
+        return component[y * width + x];
+    };
+    int     getComponentCount()             { return int(componentSize.size()); };
+    int     getComponentSize(int c)         { return componentSize[c]; };
+    size_t  getBytes();
+    double  getBuildMs()                    { return buildMs; };
+
+    static const char* kernelName();
+};
+
+#endif
@@ -0,0 +1,126 @@
+/**
+ *   FramePacer, sleep based frame pacing and idle throttling
+ *
+ *   @file     framePacer.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "framePacer.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+/**
+ *  Sets the swap interval for the pacing mode and reads the refresh rate, must run with the context current
+ */
+void FramePacer::applyMode() {
+    if (mode == ADAPTIVE && !glfwExtensionSupported("WGL_EXT_swap_control_tear")
+                         && !glfwExtensionSupported("GLX_EXT_swap_control_tear")) {
+        printf("Adaptive sync is not supported, using vsync\n");
+        mode = VSYNC;
+    }
+    switch (mode) {
+    case VSYNC:    glfwSwapInterval(1);  break;
+    case ADAPTIVE: glfwSwapInterval(-1); break;
+    case SLEEP:    glfwSwapInterval(0);  break;
+    }
+    GLFWmonitor* monitor = glfwGetPrimaryMonitor();
+    const GLFWvidmode* video = monitor ? glfwGetVideoMode(monitor) : nullptr;
+    if (video && 0 < video->refreshRate) { frameSeconds = 1.0 / video->refreshRate; }
+    nextTick  = glfwGetTime() + tickSeconds;
+    nextFrame = glfwGetTime();
+    lastRender = 0.0;
+}
+
+/**
+ *  Sleeps most of the way to a deadline and spins the rest
+ *
+ *  @param deadline - glfwGetTime() value to return at
+ */
+void FramePacer::sleepUntil(double deadline) {
+    double remaining = deadline - glfwGetTime();
+    if (remaining > spinSeconds) {
+        std::this_thread::sleep_for(std::chrono::duration<double>(remaining - spinSeconds));
+    }
+    while (glfwGetTime() < deadline) { std::this_thread::yield(); }
+}
+
+/**
+ *  Waits until the next frame is due and handles window events
+ *
+ *  Afterwards getTicks() holds the number of simulation ticks to run, often
+ *  0 when the display is faster than the tick, and shouldRender() tells if
+ *  the frame should be drawn and swapped.
+ *
+ *  @param window - game window
+ *  @param active - false once the game has ended, the loop then waits for events and redraws now and then
+ */
+void FramePacer::waitForFrame(GLFWwindow* window, bool active) {
+    bool minimized = glfwGetWindowAttrib(window, GLFW_ICONIFIED),
+         focused   = glfwGetWindowAttrib(window, GLFW_FOCUSED);
+
+    if (!active || minimized) {
+        //Nothing moves, block on events and do not catch up on return. An
+        //ended game is still redrawn, the window may have been resized or uncovered
+        glfwWaitEventsTimeout(idleSeconds);
+        nextTick = glfwGetTime() + tickSeconds;
+        ticks = 0;
+        render = !minimized;
+        throttled = true;
+        return;
+    }
+
+    if (focused) {
+        //Vsync and adaptive sync wait in the buffer swap, sleep mode sleeps to the next refresh
+        if (mode == SLEEP) {
+            sleepUntil(nextFrame);
+            nextFrame += frameSeconds;
+            if (nextFrame <= glfwGetTime()) { nextFrame = glfwGetTime() + frameSeconds; }
+        }
+        glfwPollEvents();
+    }
+    else {
+        //Background, wake up for input but only draw a few times a second
+        throttled = true;
+        double remaining = lastRender + unfocusedSeconds - glfwGetTime();
+        if (remaining > 0.0) { glfwWaitEventsTimeout(remaining); }
+        else { glfwPollEvents(); }
+    }
+
+    double now = glfwGetTime();
+    ticks = 0;
+    while (nextTick <= now && ticks < maxCatchUpTicks) {
+        nextTick += tickSeconds;
+        ticks++;
+    }
+    if (nextTick <= now) { nextTick = now + tickSeconds; }
+
+    render = focused || now - lastRender >= unfocusedSeconds;
+}
+
+/**
+ *  Returns how far a point in time is past the last tick that was due, the
+ *  simulation is that much behind it
+ *
+ *  @param now - time from glfwGetTime()
+ *
+ *  @return returns seconds between 0 and one tick
+ */
+double FramePacer::getTickLead(double now) {
+    return std::min(std::max(now - (nextTick - tickSeconds), 0.0), tickSeconds);
+}
+
+/**
+ *  Reads a pacing mode name
+ *
+ *  @param name - "vsync", "adaptive" or "sleep"
+ *  @param out  - set to the mode if the name is known
+ *
+ *  @return returns false for unknown names
+ */
+bool FramePacer::parseMode(const std::string& name, Mode& out) {
+    if (name == "vsync")    { out = VSYNC;    return true; }
+    if (name == "adaptive") { out = ADAPTIVE; return true; }
+    if (name == "sleep")    { out = SLEEP;    return true; }
+    return false;
+}
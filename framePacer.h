@@ -0,0 +1,65 @@
+/**
+ *   Header for the FramePacer class.
+ *
+ *   Paces the main loop and counts the fixed simulation ticks that are due.
+ *   Every paced frame is drawn, whether or not a tick fell into it: with
+ *   vsync the buffer swap waits for the display, in sleep mode the thread
+ *   sleeps to the next refresh and spins only for a short tail, so the loop
+ *   no longer keeps a core busy. Rendering is throttled while the window is
+ *   unfocused or the game has ended, and stopped while it is minimized.
+ *
+ *   @file     framePacer.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __FRAMEPACER_H
+#define __FRAMEPACER_H
+
+#include "include.h"
+#include <string>
+
+ // -----------------------------------------------------------------------------
+ // FramePacer Class header
+ // -----------------------------------------------------------------------------
+class FramePacer {
+public:
+    /**
+     *  How frames are presented
+     */
+    enum Mode {
+        VSYNC,          //Swap interval 1, swaps wait for the display
+        ADAPTIVE,       //Swap interval -1, late frames tear instead of waiting a whole refresh
+        SLEEP           //Swap interval 0, frames are timed by sleeping alone
+    };
+
+    static const int maxCatchUpTicks = 8;   //Longer stalls are dropped instead of fast forwarded
+
+private:
+    Mode    mode;
+    double  tickSeconds,
+            unfocusedSeconds = 1.0 / 15.0,  //Render interval while the window is in the background
+            idleSeconds      = 0.25,        //Event wait while minimized or after the game has ended
+            spinSeconds      = 0.0015,      //Deadline tail that is spun instead of slept, covers sleep overshoot
+            frameSeconds     = 1.0 / 60.0,  //Refresh interval, paces sleep mode
+            nextTick  = 0.0,
+            nextFrame = 0.0,
+            lastRender = 0.0;
+    int     ticks = 0;
+    bool    render = false,
+            throttled = false;              //Set from an idle or background wait until the next frame is shown
+
+    void    sleepUntil(double deadline);
+public:
+    FramePacer(double tick, Mode pacingMode = VSYNC) : mode(pacingMode), tickSeconds(tick) {};
+    void    applyMode();
+    void    waitForFrame(GLFWwindow* window, bool active);
+    int     getTicks()          { return ticks; };
+    double  getTickLead(double now);
+    bool    shouldRender()      { return render; };
+    bool    wasThrottled()      { return throttled; };
+    void    frameRendered()     { lastRender = glfwGetTime(); throttled = false; };
+    Mode    getMode()           { return mode; };
+    static bool parseMode(const std::string& name, Mode& out);
+};
+
+#endif
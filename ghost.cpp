@@ -3,6 +3,8 @@
 // -----------------------------------------------------------------------------
 
 #include "ghost.h"
+#include "textureArray.h"
+#include "renderStats.h"
 
 /**
  *  Initializes Ghosts
@@ -18,6 +20,7 @@
  *  @see      Ghost::characterInit();
  */
 Ghost::Ghost(int x, int y, bool ai, std::pair<int, int> widthheight, std::pair<float, float> xyshift, Camera* campoint) {
+    randomState = uint32_t(rand());     //rand() is seeded once in main, every ghost draws from its own stream after
     CamHolder = campoint;
     XYpos[0] = x, XYpos[1] = y;
     XYshift = xyshift;
@@ -31,15 +34,18 @@ Ghost::Ghost(int x, int y, bool ai, std::pair<int, int> widthheight, std::pair<f
 };
 
 /**
- *  Handles direction change requests
+ *  Handles direction change requests, with a NavGraph the ghost only
+ *  decides at junctions
  *
+ *  @see      Ghost:: navGetDir();
  *  @see      Ghost:: ghostGetRandomDir();
  *  @see      Ghost:: getLegalDir(int dir);
  *  @see      Character:: getLerpCoords();
  */
 void Ghost::changeDir() {
     bool legal = false;
-    if (AIdelay == 0) { dir = ghostGetRandomDir(); AIdelay = ((rand() + 4) % 10); legal = true; }
+    if (nav) { dir = navGetDir(); legal = (dir != 0); }
+    else if (AIdelay == 0) { dir = ghostGetRandomDir(); AIdelay = ((ghostRandom() + 4) % 10); legal = true; }
     else {
         AIdelay--;
         legal = getLegalDir(dir);
@@ -55,7 +61,7 @@ void Ghost::changeDir() {
 };
 
 /**
- *  Handles ghost LERP updates
+ *  Handles ghost LERP updates, for a ghost that is not bound to a MotionBatch
  *
  *  @see      Character:: changeDir();
  *  @see      Character:: ghostUpdateVertice();
@@ -66,6 +72,131 @@ void Ghost::updateLerp() {
     ghostUpdateVertice();
 }
 
+/**
+ *  Hands the movement to a batch, from then on the batch moves the ghost
+ *  and tileBoundary() must be called for it instead of updateLerp()
+ *
+ *  @param batch - batch shared by the ghosts, must outlive the ghost
+ *  @param time  - current time of the batch
+ */
+void Ghost::bindMotion(MotionBatch& batch, float time) {
+    float duration = lerpTick / lerpStep;
+    motion     = &batch;
+    motionSlot = batch.add(lerpStart, lerpStop, time - lerpProg * duration, duration);
+}
+
+/**
+ *  Picks the next tile of a bound ghost whose segment ended and hands the
+ *  new segment to the batch
+ *
+ *  @param time - exact time the segment ended, from MotionBatch::nextEvent
+ *
+ *  @see      Ghost:: decide(float time);
+ *  @see      Ghost:: commitSegment();
+ */
+void Ghost::tileBoundary(float time) {
+    decide(time);
+    commitSegment();
+}
+
+/**
+ *  Picks the next segment of a bound ghost whose segment ended, without
+ *  touching the batch. A ghost that can not move yet waits on its tile and
+ *  tries again one tick later. With a NavGraph the new segment reaches the
+ *  next node, so a ghost is only visited at junctions, corners and dead ends.
+ *
+ *  Only the ghost itself is written, the batch keeps moving it along the
+ *  old segment until commitSegment(), so ghosts for which decidesAlone()
+ *  holds may decide on any thread at once.
+ *
+ *  @param time - exact time the segment ended, from MotionBatch::nextEvent
+ *
+ *  @see      Ghost:: changeDir();
+ */
+void Ghost::decide(float time) {
+    int node = nav ? nav->nodeAt(XYpos[0], XYpos[1]) : -1;
+    lerpProg = 1.0f;
+    changeDir();
+    if (lerpProg < 1.0f) {
+        //With a NavGraph the segment runs straight on to the next node, nothing to decide before it
+        int tiles = 1;
+        if (0 <= node && 0 <= nav->getEdgeTarget(node, dir)) {
+            for (tiles = 1; tiles < nav->getEdgeLength(node, dir); tiles++) { Character::getLerpCoords(); }
+        }
+        else if (nav) {
+            while (nav->nodeAt(XYpos[0], XYpos[1]) < 0 && nav->canMove(XYpos[0], XYpos[1], dir)) { Character::getLerpCoords(); tiles++; }
+        }
+        nextSegment = { lerpStart[0], lerpStart[1], lerpStop[0], lerpStop[1], time, tiles * lerpTick / lerpStep };
+    }
+    else { nextSegment = { lerpStop[0], lerpStop[1], lerpStop[0], lerpStop[1], time, lerpTick }; }
+}
+
+/**
+ *  Hands the segment picked by decide() to the batch
+ */
+void Ghost::commitSegment() {
+    float start[2] = { nextSegment.startX, nextSegment.startY },
+          stop[2]  = { nextSegment.stopX,  nextSegment.stopY };
+    motion->setSegment(motionSlot, start, stop, nextSegment.time, nextSegment.duration);
+}
+
+/**
+ *  Tells whether decide() only reads what is shared with other ghosts. The
+ *  map, the NavGraph and the oracle's table are read only, the oracle's
+ *  field cache and the HpaPathfinder fill caches as they are asked.
+ *
+ *  @return   returns true if decide() may run on any thread
+ */
+bool Ghost::decidesAlone() {
+    if (!nav || target.first < 0 || (!oracle && !pathfinder)) { return true; }
+    return oracle && oracle->hasTable();
+}
+
+/**
+ *  Draws from the ghost's own random stream, so a ghost turns the same way
+ *  whichever thread it decides on and in whichever order
+ *
+ *  @return   returns a non-negative random number
+ */
+int Ghost::ghostRandom() {
+    uint32_t z = (randomState += 0x9E3779B9u);
+    z = (z ^ (z >> 16)) * 0x85EBCA6Bu;
+    z = (z ^ (z >> 13)) * 0xC2B2AE35u;
+    return int((z ^ (z >> 16)) >> 1);
+}
+
+/**
+ *  Returns the bottom left corner of the ghost's tile, interpolated
+ *
+ *  @return   ghost XY in world coordinates
+ */
+std::pair<float, float> Ghost::ghostPosition() {
+    if (motion) { return { motion->getX(motionSlot), motion->getY(motionSlot) }; }
+    return { vertices[0], vertices[1] };
+}
+
+/**
+ *  Returns the ghost position in tiles, the inverse of Character::getLerpCoords
+ *
+ *  @return   ghost XY in tiles, fractional between two tiles
+ */
+std::pair<float, float> Ghost::tilePosition() {
+    std::pair<float, float> position = ghostPosition();
+    return { (position.first + 1.0f) / XYshift.first, (position.second + 1.0f) / XYshift.second };
+}
+
+/**
+ *  Returns the tile the ghost is on now. XYpos is the end of the segment
+ *  the ghost walks, with a NavGraph that is the next node and can be a
+ *  whole corridor ahead.
+ *
+ *  @return   ghost XY in tiles, rounded to the nearest tile
+ */
+std::pair<int, int> Ghost::currentTile() {
+    std::pair<float, float> position = tilePosition();
+    return { int(position.first + 0.5f), int(position.second + 0.5f) };
+}
+
 /**
  *  compiles modelShader for ghost
  *
@@ -95,8 +226,9 @@ bool Ghost::checkGhostCollision(float pacX, float pacY, std::pair<float,float> x
 
     std::pair<float,float> pacCoords   = {  (pacXpos + (xyshift.first / 2.0f)),
                                             (pacYpos + (xyshift.second /2.0f))};
-    std::pair<float,float> ghostCoords = {  (vertices[0] + (xyshift.first  / 2.0f)),
-                                            (vertices[1] + (xyshift.second / 2.0f))};
+    std::pair<float,float> position    = ghostPosition();
+    std::pair<float,float> ghostCoords = {  (position.first  + (xyshift.first  / 2.0f)),
+                                            (position.second + (xyshift.second / 2.0f))};
     std::pair<float,float> math        = {  (pacCoords.first - ghostCoords.first),
                                             (pacCoords.second - ghostCoords.second)};
     float length = sqrt((math.first * math.first) + (math.second * math.second));
@@ -107,17 +239,15 @@ bool Ghost::checkGhostCollision(float pacX, float pacY, std::pair<float,float> x
 }
 
 /**
- *  Bruteforces a legal direction for AI
+ *  Bruteforces a legal direction for AI, from the ghost's own random stream
  *
  *  @see      Character::getLegalDir(int dir);
  *  @return   returns a legal direction for the AI to take
  */
 int Ghost::ghostGetRandomDir() {
     int temp = 0;
-    time_t t;
-    srand((unsigned)time(&t));
     do {
-        temp = (rand() % 4);
+        temp = (ghostRandom() % 4);
         switch (temp)
         {
         case 0: temp = 2;    break;
@@ -130,41 +260,108 @@ int Ghost::ghostGetRandomDir() {
 }
 
 /**
- *  Handles AI movement
+ *  Picks the way out of the current tile from the NavGraph. Corridors and
+ *  corners have one way on and dead ends lead back, only at junctions is
+ *  there a choice, and it never turns back. A ghost with a target takes the
+ *  shortest way toward it, or the nearest way on if that is behind it, and
+ *  the others pick at random.
+ *
+ *  @see      NavGraph::legalMask(int x, int y)
+ *  @see      Ghost::targetDir()
+ *  @return   returns the direction to take, 0 if the tile has no exit
  */
-void Ghost::ghostUpdateVertice() {
-    for (int f = 0; f < (4 * 5); f += 5) {
-        for (int k = f; k < (f + 3); k++) {
-            if (k == f) {
-                vertices[k] = (((1 - lerpProg) * lerpStart[0]) + (lerpProg * lerpStop[0]));
-            }
-            else if (k == (f + 1)) {
-                vertices[k] = (((1 - lerpProg) * lerpStart[1]) + (lerpProg * lerpStop[1]));
-            }
-            switch (k) {
-            case 0:   vertices[k];                  break;
-            case 1:   vertices[k];                  break;
-
-            case 5:   vertices[k];                  break;
-            case 6:   vertices[k] += XYshift.second;break;
-
-            case 10:  vertices[k] += XYshift.first; break;
-            case 11:  vertices[k] += XYshift.second;break;
-
-            case 15:  vertices[k] += XYshift.first; break;
-            case 16:  vertices[k];                  break;
-            default:  vertices[k] = 0.0f;           break;
-            }
+int Ghost::navGetDir() {
+    int exits = nav->legalMask(XYpos[0], XYpos[1]),
+        ahead = exits & ~NavGraph::bitOf(NavGraph::reverseOf(dir));
+    if (ahead == 0) { return NavGraph::dirOf(exits); }
+    int choices = NavGraph::exitCount(ahead);
+    if (1 < choices && (oracle || pathfinder) && 0 <= target.first) {
+        int toward = targetDir();
+        if (ahead & NavGraph::bitOf(toward)) { return toward; }
+        int best = 0, bestDistance = -1;
+        for (int way = ahead; way != 0; way &= way - 1) {
+            int next = NavGraph::dirOf(way),
+                nextX = XYpos[0] + ((next == 9) ? 1 : (next == 3) ? -1 : 0),
+                nextY = XYpos[1] + ((next == 2) ? 1 : (next == 4) ? -1 : 0),
+                distance = targetDistance(nextX, nextY);
+            if (0 <= distance && (bestDistance < 0 || distance < bestDistance)) { best = next; bestDistance = distance; }
         }
+        if (best != 0) { return best; }
+    }
+    if (1 < choices) {
+        for (int skip = ghostRandom() % choices; 0 < skip; skip--) { ahead &= ahead - 1; }
+    }
+    return NavGraph::dirOf(ahead);
+}
+
+/**
+ *  Returns the first move of the shortest way to the target. The oracle
+ *  answers from its table on classic levels, on levels too big for one the
+ *  HpaPathfinder is asked if the scene built it.
+ *
+ *  @see      DistanceOracle::nextDir(int fromX, int fromY, int toX, int toY)
+ *  @see      HpaPathfinder::nextDir(int fromX, int fromY, int toX, int toY)
+ *  @return   returns the direction to take, 0 if the target is out of reach
+ */
+int Ghost::targetDir() {
+    if (pathfinder && !(oracle && oracle->hasTable())) {
+        return pathfinder->nextDir(XYpos[0], XYpos[1], target.first, target.second);
+    }
+    return oracle->nextDir(XYpos[0], XYpos[1], target.first, target.second);
+}
+
+/**
+ *  Returns the walking distance from a tile to the target, from the same
+ *  source as targetDir()
+ *
+ *  @param    x - tile column
+ *  @param    y - tile row
+ *  @return   returns the distance in tiles, -1 if the target is out of reach
+ */
+int Ghost::targetDistance(int x, int y) {
+    if (pathfinder && !(oracle && oracle->hasTable())) {
+        return pathfinder->distance(x, y, target.first, target.second);
+    }
+    return oracle->distance(x, y, target.first, target.second);
+}
+
+/**
+ *  Updates a wandering ghost from what it sees. Seeing pacman makes it head
+ *  for his tile, once it gets to where he was last seen it wanders again.
+ *  The spot is checked against the tile the ghost is on, it is often in the
+ *  middle of a corridor the ghost only passes through.
+ *
+ *  @param    sees    - the ghost has line of sight to pacman, from currentTile()
+ *  @param    pacTile - tile pacman is on
+ *  @see      LineOfSight::trace(const std::vector<Query>& queries, std::vector<uint8_t>& visible)
+ */
+void Ghost::perceive(bool sees, std::pair<int, int> pacTile) {
+    seesPacman = sees;
+    if (sees) {
+        target = pacTile;
+        searching = true;
+    }
+    else if (searching && currentTile() == target) {
+        clearTarget();
+        searching = false;
     }
 }
 
+/**
+ *  Handles AI movement, ghosts are drawn as models so only the position is kept
+ */
+void Ghost::ghostUpdateVertice() {
+    vertices[0] = (((1 - lerpProg) * lerpStart[0]) + (lerpProg * lerpStop[0]));
+    vertices[1] = (((1 - lerpProg) * lerpStart[1]) + (lerpProg * lerpStop[1]));
+}
+
 /**
  *  Returns the AIs lerpProg
  *
  *  @return   AI lerpProg
  */
 float Ghost::ghostGetLerpPog() {
+    if (motion) { return motion->getProgress(motionSlot); }
     return lerpProg;
 }
 
@@ -224,32 +421,49 @@ void Ghost::ghostAnimate() {
 void Ghost::drawGhostsAsModels(float currentTime, std::pair<int,int> WH) {
 
     glUseProgram(shaderProgram);
+    RenderStats::countProgramBind();
 
     auto vertexColorLocation = glGetUniformLocation(shaderProgram, "u_Color");
     glUniform4f(vertexColorLocation, 0.8f, 0.2f, 0.2f, 1.0f);
 
     auto modelTextureLocation = glGetUniformLocation(shaderProgram, "u_modelTexture");
+    auto modelLayerLocation = glGetUniformLocation(shaderProgram, "u_layer");
     glUseProgram(shaderProgram);
-    glUniform1i(modelTextureLocation, 1);
+    RenderStats::countProgramBind();
+    glUniform1i(modelTextureLocation, TextureArray::textureUnit);
+    glUniform1i(modelLayerLocation, textureLayer);
 
     CamHolder->applycamera(shaderProgram, WH.second, WH.first);
     transformGhost(shaderProgram, currentTime);
     Light(shaderProgram);
 
     glBindVertexArray(characterVAO);
+    RenderStats::countVertexArrayBind();
     glDrawArrays(GL_TRIANGLES, 6, modelSize);
+    RenderStats::countDraw(modelSize);
 }
 
 /**
  *  Loads 3d model
  *
+ *  @see  Ghost::parseModel(const std::string path, const std::string objID)
+ *  @see  Ghost::uploadModel(const std::vector<Vertex>& vertices)
+ *  @return returns VAO and size of model in a pair
+ */
+std::pair<GLuint, int> Ghost::LoadModel(const std::string path, const std::string objID) {
+    return uploadModel(parseModel(path, objID));
+}
+
+/**
+ *  Parses 3d model into vertices, does not touch OpenGL so it can run on a loader thread
+ *
  *  @see  LoadObj(attrib_t *attrib, std::vector<shape_t> *shapes,
              std::vector<material_t> *materials, std::string *warn,
              std::string *err, const char *filename, const char *mtl_basedir,
              bool triangulate, bool default_vcols_fallback)
- *  @return returns VAO and size of model in a pair
+ *  @return returns the models vertices
  */
-std::pair<GLuint, int> Ghost::LoadModel(const std::string path, const std::string objID) {
+std::vector<Ghost::Vertex> Ghost::parseModel(const std::string path, const std::string objID) {
     //We create a vector of Vertex structs. OpenGL can understand these, and so will accept them as input.
     std::vector<Vertex> vertices;
 
@@ -266,7 +480,7 @@ std::pair<GLuint, int> Ghost::LoadModel(const std::string path, const std::strin
     tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, ("../../../../" + path + objID).c_str(), path.c_str());
 
     //For each shape defined in the obj file
-    for (auto shape : shapes)
+    for (auto& shape : shapes)
     {
         //We find each mesh
         for (auto meshIndex : shape.mesh.indices)
@@ -291,7 +505,16 @@ std::pair<GLuint, int> Ghost::LoadModel(const std::string path, const std::strin
 
         }
     }
+    return vertices;
+}
 
+/**
+ *  Uploads parsed model vertices to a new VAO
+ *
+ *  @param vertices - vertices from Ghost::parseModel
+ *  @return returns VAO and size of model in a pair
+ */
+std::pair<GLuint, int> Ghost::uploadModel(const std::vector<Vertex>& vertices) {
     GLuint VAO;
     glGenVertexArrays(1, &VAO);
     glBindVertexArray(VAO);
@@ -301,7 +524,8 @@ std::pair<GLuint, int> Ghost::LoadModel(const std::string path, const std::strin
     glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
     //As you can see, OpenGL will accept a vector of structs as a valid input here
-    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), &vertices[0], GL_STATIC_DRAW);
+    glBufferData(GL_ARRAY_BUFFER, sizeof(Vertex) * vertices.size(), vertices.data(), GL_STATIC_DRAW);
+    RenderStats::countUpload(sizeof(Vertex) * vertices.size());
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(float) * 8, nullptr);
@@ -312,8 +536,11 @@ std::pair<GLuint, int> Ghost::LoadModel(const std::string path, const std::strin
     glEnableVertexAttribArray(2);
     glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(float) * 8, (void*)(sizeof(float) * 6));
 
+    //Unbind so attribute setup done by later shader compiles can not end up on this VAO
+    glBindVertexArray(0);
+
     //This will be needed later to specify how much we need to draw. Look at the main loop to find this variable again.
-    std::pair<GLuint, int> VaoSize = { VAO, vertices.size() };
+    std::pair<GLuint, int> VaoSize = { VAO, int(vertices.size()) };
     return VaoSize;
 }
 
@@ -324,7 +551,8 @@ void Ghost::transformGhost(GLuint shaderProg, float currentTime){
     //LERP performed in the shader for the pacman object
     float height = sin(currentTime) / 100.0f;
     if (height < 0) { height *= -1; }
-    glm::mat4 translation = glm::translate(glm::mat4(1), glm::vec3(vertices[0]+(XYshift.first/2.0f), vertices[1] + (XYshift.second / 2.0f), height));
+    std::pair<float, float> position = ghostPosition();
+    glm::mat4 translation = glm::translate(glm::mat4(1), glm::vec3(position.first + (XYshift.first/2.0f), position.second + (XYshift.second / 2.0f), height));
     //Rotate the object            base matrix      degrees to rotate   axis to rotate around
     glm::mat4 rotate = glm::rotate(glm::mat4(1), glm::radians(90.0f), glm::vec3(1.0f, 0.0f, 0.0f));
     float turn = 0.0f;
@@ -350,15 +578,6 @@ void Ghost::transformGhost(GLuint shaderProg, float currentTime){
     glUniformMatrix4fv(transformationmat, 1, false, glm::value_ptr(transformation));
 }
 
-/**
- *  loads Ghost sprite, just used to add soem texture to the ghosts
- *
- *  @see GLuint load_opengl_texture(const std::string& filepath, GLuint slot)
- */
-void Ghost::loadGhostSpriteSheet() {
-   textureSheet = load_opengl_texture("assets/ghostModelShader.png", 1);
-}
-
 // -----------------------------------------------------------------------------
 // Code handling the Lighting
 // -----------------------------------------------------------------------------
@@ -9,6 +9,9 @@
 #define __GHOST_H
 
 #include "character.h"
+#include "motionBatch.h"
+#include "distanceOracle.h"
+#include "hpaPathfinder.h"
 #include "tiny_obj_loader.h"
 
  // -----------------------------------------------------------------------------
@@ -18,16 +21,26 @@ class Ghost : public Character {
 private:
     int AIdelay = dir;  //Delay for deciding direction of ghost
     int modelSize = 0;
-    GLuint modelShadowShader;
-    GLuint ShadowShader;
-    GLuint floorVAO;
+    MotionBatch* motion = nullptr;      //LERP state lives here once bound, see bindMotion
+    int     motionSlot = 0;
+    DistanceOracle* oracle = nullptr;   //Shortest paths toward target, see setTarget
+    HpaPathfinder*  pathfinder = nullptr;   //Used instead when the oracle has no table
+    std::pair<int, int> target = { -1, -1 };    //Tile to head for at junctions, -1 to wander
+    bool    seesPacman = false;         //Line of sight at the last perceive()
+    bool    searching = false;          //Heading for where pacman was last seen, see perceive
+    uint32_t randomState = 1;           //Own random stream, see ghostRandom
 
-    const GLuint SHADOW_WIDTH = 1;
-    const GLuint SHADOW_HEIGHT = 1;
-
-    GLuint  shadowmapFrameBuffer, 
-            depthMap;
+    /**
+     *  Segment picked by decide(), held back until commitSegment()
+     */
+    struct Segment {
+        float startX, startY,
+              stopX,  stopY,
+              time,
+              duration;
+    } nextSegment = { 0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f };
 
+public:
     //------------------------------------------------------------------------------
     // VERTEX STRUCT
     //------------------------------------------------------------------------------
@@ -38,18 +51,36 @@ private:
         glm::vec2 texCoords;
     };
 
-
-public:
     Ghost() {};
     Ghost(int x, int y, bool ai, std::pair<int, int> widthheight, std::pair<float, float> xyshift, Camera* campoint);
     ~Ghost() {};
 
     virtual void changeDir();
     virtual void updateLerp();
+    void bindMotion(MotionBatch& batch, float time);
+    void tileBoundary(float time);
+    void decide(float time);
+    void commitSegment();
+    bool decidesAlone();
+    std::pair<float, float> ghostPosition();
+    std::pair<float, float> tilePosition();
+    std::pair<int, int> currentTile();
     void compileGhostModelShader();
 
     bool  checkGhostCollision(float pacX, float pacY, std::pair<float, float> xyshift);
     int   ghostGetRandomDir();
+    int   ghostRandom();
+    int   navGetDir();
+    int   targetDir();
+    int   targetDistance(int x, int y);
+    void  setOracle(DistanceOracle* paths)      { oracle = paths; };
+    void  setPathfinder(HpaPathfinder* hpa)     { pathfinder = hpa; };
+    void  setTarget(std::pair<int, int> tile)   { target = tile; };
+    void  clearTarget()                         { target = { -1, -1 }; };
+    void  perceive(bool sees, std::pair<int, int> pacTile);
+    bool  getSeesPacman()                       { return seesPacman; };
+    bool  isSearching()                         { return searching; };
+    std::pair<int, int> getTarget()             { return target; };
     void  ghostUpdateVertice();
     float ghostGetLerpPog();
     int   ghostGetXY(int xy);
@@ -62,8 +93,9 @@ public:
         std::pair<GLuint, int> VAOsize = LoadModel("assets/model/ghost", "/ghostModel.obj");
         characterVAO = VAOsize.first; modelSize = VAOsize.second;
     };
-    void loadGhostSpriteSheet();
     std::pair<GLuint, int> LoadModel(const std::string path, const std::string objID);
+    static std::vector<Vertex>    parseModel(const std::string path, const std::string objID);
+    static std::pair<GLuint, int> uploadModel(const std::vector<Vertex>& vertices);
     void Light(
         const GLuint shaderprogram,
         const glm::vec3 pos = { 0.f, 0.f, 1.f },
@@ -0,0 +1,87 @@
+/**
+ *   GhostCrowd, ghost movement, decisions and collisions on a JobSystem
+ *
+ *   @file     ghostCrowd.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "ghostCrowd.h"
+#include "profiler.h"
+#include <cstdio>
+
+/**
+ *  Moves every ghost to a point in time, deciding for each ghost whose segment ended
+ *
+ *  @param ghosts - ghosts bound to motion, slot g belongs to ghosts[g]
+ *  @param motion - batch the ghosts move in
+ *  @param now    - time to move to
+ */
+void GhostCrowd::step(std::vector<Ghost>& ghosts, MotionBatch& motion, float now) {
+    int   slot;
+    float eventTime;
+    auto decide = [&](int first, int last) {
+        for (int e = first; e < last; e++) {
+            Ghost& ghost = ghosts[events[e].second];
+            if (ghost.decidesAlone()) { ghost.decide(events[e].first); }
+        }
+    };
+    while (true) {
+        events.clear();
+        while (motion.nextEvent(now, slot, eventTime)) { events.push_back({ eventTime, slot }); }
+        if (events.empty()) { break; }
+        rounds++;
+        {
+            PROFILE_ZONE("ghost decide");
+            if (jobs) { jobs->parallelFor(int(events.size()), decideChunk, decide); }
+            else { decide(0, int(events.size())); }
+        }
+        PROFILE_ZONE("ghost commit");
+        for (auto& event : events) {
+            Ghost& ghost = ghosts[event.second];
+            if (ghost.decidesAlone()) { decidedParallel++; }
+            else {
+                ghost.decide(event.first);
+                decidedSerial++;
+            }
+            ghost.commitSegment();
+        }
+    }
+    PROFILE_ZONE("ghost interpolate");
+    motion.interpolate(now, jobs);
+}
+
+/**
+ *  Tests ghosts against pacman
+ *
+ *  @param ghosts  - every ghost
+ *  @param tested  - indices of the ghosts to test
+ *  @param pacTile - tile pacman is on
+ *  @param xyshift - size of a tile in world units
+ *
+ *  @return returns the tested ghosts that hit pacman, in the order of tested
+ */
+const std::vector<int>& GhostCrowd::collide(std::vector<Ghost>& ghosts, const std::vector<int>& tested,
+                                            std::pair<int, int> pacTile, std::pair<float, float> xyshift) {
+    hitFlags.resize(tested.size());
+    auto test = [&](int first, int last) {
+        for (int t = first; t < last; t++) {
+            hitFlags[t] = ghosts[tested[t]].checkGhostCollision(float(pacTile.first), float(pacTile.second), xyshift);
+        }
+    };
+    if (jobs) { jobs->parallelFor(int(tested.size()), collideChunk, test); }
+    else { test(0, int(tested.size())); }
+
+    hits.clear();
+    for (size_t t = 0; t < tested.size(); t++) {
+        if (hitFlags[t]) { hits.push_back(tested[t]); }
+    }
+    return hits;
+}
+
+/**
+ *  Prints where the decisions ran
+ */
+void GhostCrowd::report() {
+    printf("Ghost crowd: %i workers, %lli decisions in parallel, %lli on the main thread, %i rounds\n",
+        jobs ? jobs->getWorkerCount() : 1, decidedParallel, decidedSerial, rounds);
+}
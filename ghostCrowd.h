@@ -0,0 +1,60 @@
+/**
+ *   Header for the GhostCrowd class.
+ *
+ *   Runs the per tick ghost work on a JobSystem. Ghost decisions are double
+ *   buffered: the MotionBatch holds the segments every ghost moves along,
+ *   and a ghost whose segment ended picks its next one into its own back
+ *   buffer (Ghost::decide) while the batch is left alone. Ends due in the
+ *   tick are taken in rounds: all current ends are collected, the ghosts
+ *   decide in parallel, and the new segments are committed to the batch in
+ *   the order the ends were handed out. New segments that end within the
+ *   tick come up in the next round.
+ *
+ *   Every ghost only reads shared tables and draws from its own random
+ *   stream, so a tick gives the same positions on any amount of workers,
+ *   and the same as calling Ghost::tileBoundary one end at a time. Ghosts
+ *   that would fill a shared pathfinding cache decide on the calling
+ *   thread, in the same order.
+ *
+ *   @file     ghostCrowd.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __GHOSTCROWD_H
+#define __GHOSTCROWD_H
+
+#include "ghost.h"
+#include "motionBatch.h"
+#include "jobSystem.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+ // -----------------------------------------------------------------------------
+ // GhostCrowd Class header
+ // -----------------------------------------------------------------------------
+class GhostCrowd {
+public:
+    static const int decideChunk  = 256;    //Ghost decisions in one job
+    static const int collideChunk = 4096;   //Collision tests in one job
+
+private:
+    JobSystem* jobs = nullptr;              //nullptr runs everything on the caller
+    std::vector<std::pair<float, int>> events;  //Segment ends of the current round, as handed out
+    std::vector<uint8_t> hitFlags;          //Collision result per tested ghost
+    std::vector<int>     hits;              //Ghosts that hit pacman, in tested order
+    long long decidedParallel = 0,
+              decidedSerial   = 0;
+    int       rounds = 0;
+
+public:
+    void    setJobSystem(JobSystem* system)     { jobs = system; };
+    void    step(std::vector<Ghost>& ghosts, MotionBatch& motion, float now);
+    const std::vector<int>& collide(std::vector<Ghost>& ghosts, const std::vector<int>& tested,
+                                    std::pair<int, int> pacTile, std::pair<float, float> xyshift);
+    void    report();
+
+    JobSystem* getJobSystem()                   { return jobs; };
+};
+
+#endif
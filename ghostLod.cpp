@@ -0,0 +1,114 @@
+/**
+ *   GhostLod, simulation tiers by distance to pacman
+ *
+ *   @file     ghostLod.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "ghostLod.h"
+#include "jobSystem.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ *  Sets the distance at which a ghost hits pacman, in tiles. The hit test
+ *  is in world units, the narrower side of a tile gives the widest reach.
+ *
+ *  @param xyshift - size of a tile in world units
+ *  @see   Ghost::checkGhostCollision(float pacX, float pacY, std::pair<float, float> xyshift)
+ */
+void GhostLod::setCollisionReach(std::pair<float, float> xyshift) {
+    collisionReach = (xyshift.first + xyshift.second) / (5.0f * std::min(xyshift.first, xyshift.second));
+}
+
+/**
+ *  Counts one tick of movement and tells whether the tiers need a refresh
+ *
+ *  @param pacTiles   - most tiles pacman moves in the tick
+ *  @param ghostTiles - most tiles a ghost moves in the tick
+ *
+ *  @return returns true if refresh() has to run this tick
+ */
+bool GhostLod::due(float pacTiles, float ghostTiles) {
+    reach += pacTiles + ghostTiles;
+    return !refreshed || collisionTiles <= reach + pacSlack + collisionReach;
+}
+
+/**
+ *  Sorts the ghosts into tiers from where they are now
+ *
+ *  @param ghosts  - every ghost, bound to a MotionBatch that was just interpolated
+ *  @param paths   - walking distances when it has a table, Manhattan distance is used otherwise
+ *  @param pacTile - tile pacman is on
+ */
+void GhostLod::refresh(std::vector<Ghost>& ghosts, DistanceOracle* paths, std::pair<int, int> pacTile) {
+    bool walking = paths && paths->hasTable();
+    far.assign(ghosts.size(), 0);
+    nearGhosts.clear();
+    farGhosts.clear();
+    collisionGhosts.clear();
+    for (int g = 0; g < int(ghosts.size()); g++) {
+        std::pair<float, float> position = ghosts[g].tilePosition();
+        float apartX = std::fabs(position.first  - pacTile.first),
+              apartY = std::fabs(position.second - pacTile.second);
+        if (std::max(apartX, apartY) <= collisionTiles) { collisionGhosts.push_back(g); }
+
+        int tileX = int(position.first + 0.5f),
+            tileY = int(position.second + 0.5f),
+            distance = walking ? paths->distance(tileX, tileY, pacTile.first, pacTile.second)
+                               : std::abs(tileX - pacTile.first) + std::abs(tileY - pacTile.second);
+        if ((0 <= distance && distance <= nearTiles) || ghosts[g].getSeesPacman() || ghosts[g].isSearching()) { nearGhosts.push_back(g); }
+        else {
+            far[g] = 1;
+            farGhosts.push_back(g);
+        }
+    }
+    reach = 0.0f;
+    refreshed = true;
+    refreshes++;
+}
+
+/**
+ *  Runs one animation step, near ghosts all animate and far ghosts take turns
+ *
+ *  @param ghosts - every ghost
+ *  @param jobs   - workers to spread the ghosts over, nullptr runs them on the caller
+ */
+void GhostLod::animate(std::vector<Ghost>& ghosts, JobSystem* jobs) {
+    size_t farFirst  = animateStep % farAnimateEvery;
+    int    nearCount = int(nearGhosts.size()),
+           farCount  = (farFirst < farGhosts.size()) ? int((farGhosts.size() - farFirst + farAnimateEvery - 1) / farAnimateEvery) : 0;
+    auto run = [&](int first, int last) {
+        for (int a = first; a < last; a++) {
+            int g = (a < nearCount) ? nearGhosts[a] : farGhosts[farFirst + size_t(a - nearCount) * farAnimateEvery];
+            ghosts[g].ghostAnimate();
+        }
+    };
+    if (jobs) { jobs->parallelFor(nearCount + farCount, animateChunk, run); }
+    else { run(0, nearCount + farCount); }
+    animateStep++;
+}
+
+/**
+ *  Forgets the tiers, the next tick refreshes them
+ */
+void GhostLod::clear() {
+    far.clear();
+    nearGhosts.clear();
+    farGhosts.clear();
+    collisionGhosts.clear();
+    reach = 0.0f;
+    refreshed = false;
+    refreshes = 0;
+    animateStep = 0;
+}
+
+/**
+ *  Prints the size of the tiers
+ */
+void GhostLod::report() {
+    printf("Ghost LOD: %zu near, %zu far, %zu checked for collisions, %d refreshes\n",
+        nearGhosts.size(), farGhosts.size(), collisionGhosts.size(), refreshes);
+}
@@ -0,0 +1,70 @@
+/**
+ *   Header for the GhostLod class.
+ *
+ *   Level of detail for the ghost simulation. Ghosts near pacman, by
+ *   walking distance or because they see him or head for where they last
+ *   saw him, get every update; the rest are far and skip work the player
+ *   would not notice: they look for pacman and take a new target only when
+ *   the tiers are refreshed, and animate on one animation step in
+ *   farAnimateEvery. Movement is never
+ *   reduced, every ghost still moves exactly by time.
+ *
+ *   Collisions are checked only for ghosts within collisionTiles of pacman
+ *   at the last refresh. Every tick adds how far pacman and a ghost may
+ *   have closed in since, and the tiers are refreshed before that could
+ *   bring a ghost outside the list within reach, so no hit is missed.
+ *
+ *   @file     ghostLod.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __GHOSTLOD_H
+#define __GHOSTLOD_H
+
+#include "ghost.h"
+#include "distanceOracle.h"
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class JobSystem;
+
+ // -----------------------------------------------------------------------------
+ // GhostLod Class header
+ // -----------------------------------------------------------------------------
+class GhostLod {
+public:
+    static const int nearTiles = 16;                //Walking distance within which a ghost gets every update
+    static constexpr float collisionTiles = 6.0f;   //Distance in tiles within which collisions are checked
+    static const int farAnimateEvery = 4;           //A far ghost animates on one animation step in this many
+    static const int animateChunk = 4096;           //Ghosts animated in one JobSystem job
+
+private:
+    static constexpr float pacSlack = 2.0f;         //Pacman's tile runs up to a tile ahead of him, at both ends
+
+    std::vector<uint8_t> far;                       //1 for ghosts in the far tier, by index
+    std::vector<int>     nearGhosts,                //Ghost indices of each tier, ascending
+                         farGhosts,
+                         collisionGhosts;           //Ghosts that may reach pacman before the next refresh
+    float   reach = 0.0f,                           //Tiles pacman and a ghost may have closed in since the refresh
+            collisionReach = 0.4f;                  //Tiles apart at which Ghost::checkGhostCollision hits
+    bool    refreshed = false;
+    int     refreshes = 0,
+            animateStep = 0;
+
+public:
+    void    setCollisionReach(std::pair<float, float> xyshift);
+    bool    due(float pacTiles, float ghostTiles);
+    void    refresh(std::vector<Ghost>& ghosts, DistanceOracle* paths, std::pair<int, int> pacTile);
+    void    animate(std::vector<Ghost>& ghosts, JobSystem* jobs = nullptr);
+    void    clear();
+    void    report();
+
+    bool    isFar(int ghost)    { return ghost < int(far.size()) && far[ghost]; };
+    const std::vector<int>& getNear()       { return nearGhosts; };
+    const std::vector<int>& getFar()        { return farGhosts; };
+    const std::vector<int>& getCollision()  { return collisionGhosts; };
+    int     getRefreshes()      { return refreshes; };
+};
+
+#endif
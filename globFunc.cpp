@@ -1,5 +1,7 @@
 #include "globFunc.h"
 #include "camera.h"
+#include "renderStats.h"
+#include "arena.h"
 #include <stb_image.h>
 
 // -----------------------------------------------------------------------------
@@ -154,40 +156,36 @@ GLuint CompileShader(const std::string& vertexShaderSrc,
 }
 
 /*
-*   Loads texture
-* 
+*   Decodes an image file to RGBA8, does not touch OpenGL so it is safe on any thread.
+*   A converted .ktx next to the image is read as well, the PNG stays as the fallback
+*
 *   @param filepath - filepath of texture
-*   @param slot - what slot to load the texture into
-* 
-*   @return returns texture GLuint
+*
+*   @see readKtx(const std::string& filepath, KtxTexture& texture)
+*
+*   @return returns the decoded image, pixels are empty if it failed
 */
-GLuint load_opengl_texture(const std::string& filepath, GLuint slot)
+DecodedImage decode_image(const std::string& filepath)
 {
+    DecodedImage image;
+    image.path = filepath;
+    if (!readKtx(ktxPathFor(filepath), image.precompressed)) { image.precompressed = KtxTexture(); }
+
     /** Image width, height, bit depth */
-    int w, h, bpp;
-    auto pixels = stbi_load(filepath.c_str(), &w, &h, &bpp, STBI_rgb_alpha);
-
-    /*Generate a texture object and upload the loaded image to it.*/
-    GLuint tex;
-    glGenTextures(1, &tex);
-    glActiveTexture(GL_TEXTURE0 + slot); //Texture Unit
-    glBindTexture(GL_TEXTURE_2D, tex);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, w, h, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
-
-    /** Set parameters for the texture */
-    //Wrapping
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    //Filtering
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-    /** Free memory */
-    if (pixels)
-        stbi_image_free(pixels);
+    int bpp;
+    auto pixels = stbi_load(filepath.c_str(), &image.width, &image.height, &bpp, STBI_rgb_alpha);
 
-    return tex;
-};
+    /** Copy and free memory */
+    if (pixels) {
+        image.pixels.assign(pixels, pixels + (size_t(image.width) * image.height * 4));
+        stbi_image_free(pixels);
+    }
+    else {
+        image.width = image.height = 0;
+        std::cerr << "Couldnt load texture: " << filepath << '\n';
+    }
+    return image;
+}
 
 // -----------------------------------------------------------------------------
 //  INITIALIZE OBJECT
@@ -203,7 +201,9 @@ GLuint load_opengl_texture(const std::string& filepath, GLuint slot)
  */
 GLuint CreateObject(GLfloat* object, int size, const int stride)
 {
-    std::vector<GLuint> object_indices;
+    //Only needed until the upload, lives in the level arena
+    ArenaVector<GLuint> object_indices{ ArenaAllocator<GLuint>(Arena::level()) };
+    object_indices.reserve(size_t(size / 4 + 1) * 6);
 
     for (int i = 0; i < size; i += 4) {
         for (int o = 0; o < 2; o++) {
@@ -227,12 +227,14 @@ GLuint CreateObject(GLfloat* object, int size, const int stride)
         size,
         (&object[0]),
         GL_STATIC_DRAW);
+    RenderStats::countUpload(size);
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, (sizeof(GLfloat) * stride), (const void*)0);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, object_indices.size() * sizeof(object_indices)[0], (&object_indices[0]), GL_STATIC_DRAW);
+    RenderStats::countUpload(object_indices.size() * sizeof(object_indices)[0]);
 
     return vao;
 };
@@ -260,6 +262,7 @@ GLuint CreateObject(GLfloat* object, int size, const int stride, bool noEbo)
         size,
         (&object[0]),
         GL_STATIC_DRAW);
+    RenderStats::countUpload(size);
 
     glEnableVertexAttribArray(0);
     glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, (sizeof(GLfloat) * stride), (const void*)0);
@@ -288,7 +291,8 @@ GLuint getIndices(int out, int mid, int in) {
 void CleanVAO(GLuint& vao)
 {
     GLint nAttr = 0;
-    std::set<GLuint> vbos;
+    GLuint vbos[32];            //Attributes share buffers, each is deleted once
+    int    vboCount = 0;
 
     GLint eboId;
     glGetVertexArrayiv(vao, GL_ELEMENT_ARRAY_BUFFER_BINDING, &eboId);
@@ -301,17 +305,14 @@ void CleanVAO(GLuint& vao)
     {
         GLint vboId = 0;
         glGetVertexAttribiv(iAttr, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &vboId);
-        if (vboId > 0)
+        if (vboId > 0 && std::find(vbos, vbos + vboCount, GLuint(vboId)) == vbos + vboCount && vboCount < 32)
         {
-            vbos.insert(vboId);
+            vbos[vboCount++] = GLuint(vboId);
         }
         glDisableVertexAttribArray(iAttr);
     }
 
-    for (auto vbo : vbos)
-    {
-        glDeleteBuffers(1, &vbo);
-    }
+    glDeleteBuffers(vboCount, vbos);
 
     glDeleteVertexArrays(1, &vao);
 }
\ No newline at end of file
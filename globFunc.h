@@ -10,6 +10,18 @@
 
 //Inclusions
 #include "include.h"
+#include "ktx.h"
+
+/**
+ *  Image decoded to RGBA8 on the CPU, waiting to be uploaded
+ */
+struct DecodedImage {
+    std::string path;
+    int width  = 0,
+        height = 0;
+    std::vector<unsigned char> pixels;  //width * height * 4 bytes, empty if loading failed
+    KtxTexture precompressed;           //Converted mip chain from tools/texconv, empty if there is none
+};
 
 // -----------------------------------------------------------------------------
 // FUNCTION PROTOTYPES
@@ -22,7 +34,7 @@ GLuint  CompileShader(const std::string& vertexShader, const std::string& fragme
 GLuint  CreateObject(GLfloat *object, int size, const int stride);
 GLuint  CreateObject(GLfloat* object, int size, const int stride, bool noEbo);
 GLuint  getIndices(      int out, int mid, int in);
-GLuint  load_opengl_texture(const std::string& filepath, GLuint slot);
+DecodedImage decode_image(const std::string& filepath);
 void    TransformMap(const GLuint);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,114 @@
+/**
+ *   GpuTimer, non blocking GL_TIME_ELAPSED queries per render pass
+ *
+ *   @file     gpuTimer.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "gpuTimer.h"
+#include "profiler.h"
+
+/**
+ *  Registers a pass, must run on the GL thread
+ *
+ *  @param name - pass name, must be a string literal
+ *
+ *  @return returns the pass index used by begin()
+ */
+int GpuTimer::addPass(const char* name) {
+    Pass pass;
+    pass.name = name;
+    glGenQueries(queryRing, pass.queries);
+    passes.push_back(pass);
+    return int(passes.size()) - 1;
+}
+
+/**
+ *  Starts timing a pass, dropped if every query of the pass is still in flight
+ *
+ *  @param pass - index from addPass
+ *
+ *  @return returns false if another pass is active, end() must then not be called for this one
+ */
+bool GpuTimer::begin(int pass) {
+    if (activePass != -1) { return false; }
+    activePass = pass;
+    activeIssued = false;
+
+    Pass& p = passes[pass];
+    if (p.pending[p.next]) {
+        collect();
+        if (p.pending[p.next]) { p.skipped++; return true; }
+    }
+    glBeginQuery(GL_TIME_ELAPSED, p.queries[p.next]);
+    activeIssued = true;
+    return true;
+}
+
+/**
+ *  Stops timing the pass started by begin()
+ */
+void GpuTimer::end() {
+    if (activePass == -1) { return; }
+    if (activeIssued) {
+        Pass& p = passes[activePass];
+        glEndQuery(GL_TIME_ELAPSED);
+        p.pending[p.next] = true;
+        p.next = (p.next + 1) % queryRing;
+    }
+    activePass = -1;
+}
+
+/**
+ *  Reads back every finished query without waiting, call once per frame
+ */
+void GpuTimer::collect() {
+    for (auto& pass : passes) {
+        //Oldest first, so samples stay in issue order
+        for (int i = 0; i < queryRing; i++) {
+            int slot = (pass.next + i) % queryRing;
+            if (!pass.pending[slot]) { continue; }
+
+            GLint available = 0;
+            glGetQueryObjectiv(pass.queries[slot], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) { break; }
+
+            GLuint64 elapsed = 0;
+            glGetQueryObjectui64v(pass.queries[slot], GL_QUERY_RESULT, &elapsed);
+            pass.pending[slot] = false;
+            addSample(pass, elapsed / 1000000.0);
+        }
+    }
+}
+
+/**
+ *  Adds a result to the rolling average and the profiler trace
+ *
+ *  @param pass - pass the result belongs to
+ *  @param ms   - GPU time in milliseconds
+ */
+void GpuTimer::addSample(Pass& pass, double ms) {
+    if (pass.sampleCount == averageSize) { pass.sampleSum -= pass.samples[pass.sampleNext]; }
+    else { pass.sampleCount++; }
+    pass.samples[pass.sampleNext] = ms;
+    pass.sampleSum += ms;
+    pass.sampleNext = (pass.sampleNext + 1) % averageSize;
+    pass.lastMs = ms;
+    PROFILE_COUNTER(pass.name, ms);
+}
+
+/**
+ *  Returns the rolling average of a pass in milliseconds, 0 before the first result
+ */
+double GpuTimer::getAverageMs(int pass) {
+    const Pass& p = passes[pass];
+    return (p.sampleCount == 0) ? 0.0 : p.sampleSum / p.sampleCount;
+}
+
+/**
+ *  Deletes every query object
+ */
+void GpuTimer::cleanGpuTimer() {
+    for (auto& pass : passes) { glDeleteQueries(queryRing, pass.queries); }
+    passes.clear();
+}
@@ -0,0 +1,74 @@
+/**
+ *   Header for the GpuTimer class.
+ *
+ *   Times render passes on the GPU with GL_TIME_ELAPSED queries. Every pass
+ *   owns a small ring of query objects, a result is only read once the
+ *   driver reports it available, so timing never waits on the GPU. Results
+ *   arrive a few frames late and are kept as a rolling average per pass.
+ *
+ *   @file     gpuTimer.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __GPUTIMER_H
+#define __GPUTIMER_H
+
+#include "include.h"
+
+ // -----------------------------------------------------------------------------
+ // GpuTimer Class header
+ // -----------------------------------------------------------------------------
+class GpuTimer {
+public:
+    static const int queryRing   = 4;      //Queries in flight per pass
+    static const int averageSize = 64;     //Samples in the rolling average
+
+private:
+    /**
+     *  One timed pass and its queries
+     */
+    struct Pass {
+        const char* name;                   //String literal, also used as the profiler counter name
+        GLuint  queries[queryRing] = { 0 };
+        bool    pending[queryRing] = { false };
+        int     next = 0;                   //Ring slot the next begin() uses
+        double  samples[averageSize] = { 0.0 };
+        double  sampleSum = 0.0;
+        int     sampleCount = 0,
+                sampleNext  = 0;
+        double  lastMs = 0.0;
+        int     skipped = 0;                //begin() calls dropped because the ring was full
+    };
+
+    std::vector<Pass> passes;
+    int     activePass = -1;                //GL_TIME_ELAPSED queries can not nest
+    bool    activeIssued = false;
+
+    void    addSample(Pass& pass, double ms);
+public:
+    int     addPass(const char* name);
+    bool    begin(int pass);
+    void    end();
+    void    collect();
+    void    cleanGpuTimer();
+    int     getPassCount()              { return int(passes.size()); };
+    const char* getName(int pass)       { return passes[pass].name; };
+    double  getAverageMs(int pass);
+    double  getLastMs(int pass)         { return passes[pass].lastMs; };
+    int     getSkipped(int pass)        { return passes[pass].skipped; };
+};
+
+/**
+ *  Times the enclosing scope as one GpuTimer pass, a scope nested in another
+ *  pass is not timed and leaves the outer one running
+ */
+class GpuTimerScope {
+private:
+    GpuTimer& timer;
+    bool      started;
+public:
+    GpuTimerScope(GpuTimer& owner, int pass) : timer(owner), started(owner.begin(pass)) {};
+    ~GpuTimerScope() { if (started) { timer.end(); } };
+};
+
+#endif
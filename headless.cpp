@@ -0,0 +1,92 @@
+/**
+ *   Headless EGL context for the benchmark
+ *
+ *   @file     headless.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "headless.h"
+#include "include.h"
+
+#if PACMAN_HAS_EGL
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+
+static EGLDisplay display = EGL_NO_DISPLAY;
+static EGLContext context = EGL_NO_CONTEXT;
+
+/**
+ *  Creates a surfaceless 4.3 core context and loads GL through glad
+ *
+ *  @return returns false if no display or context could be created
+ */
+bool createHeadlessContext() {
+    auto getPlatformDisplay = (PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+    if (getPlatformDisplay) { display = getPlatformDisplay(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, nullptr); }
+    if (display == EGL_NO_DISPLAY) { display = eglGetDisplay(EGL_DEFAULT_DISPLAY); }
+
+    EGLint major = 0, minor = 0;
+    if (display == EGL_NO_DISPLAY || !eglInitialize(display, &major, &minor)) {
+        std::cerr << "EGL initialization failed." << '\n';
+        return false;
+    }
+    if (!eglBindAPI(EGL_OPENGL_API)) {
+        std::cerr << "EGL has no desktop OpenGL." << '\n';
+        return false;
+    }
+
+    //No config and no surface, needs EGL_KHR_no_config_context and EGL_KHR_surfaceless_context
+    const EGLint contextAttribs[] = {
+        EGL_CONTEXT_MAJOR_VERSION,       4,
+        EGL_CONTEXT_MINOR_VERSION,       3,
+        EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+        EGL_NONE
+    };
+    context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, contextAttribs);
+    if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context)) {
+        std::cerr << "EGL context creation failed, error 0x" << std::hex << eglGetError() << std::dec << '\n';
+        return false;
+    }
+
+    if (!gladLoadGLLoader((GLADloadproc)eglGetProcAddress)) {
+        std::cout << "Failed to initialize GLAD" << std::endl;
+        return false;
+    }
+
+    glEnable(GL_DEPTH_TEST);
+    glDepthFunc(GL_LEQUAL);
+    return true;
+}
+
+/**
+ *  Releases the context and the display
+ */
+void destroyHeadlessContext() {
+    if (display == EGL_NO_DISPLAY) { return; }
+    eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (context != EGL_NO_CONTEXT) { eglDestroyContext(display, context); }
+    eglTerminate(display);
+    display = EGL_NO_DISPLAY;
+    context = EGL_NO_CONTEXT;
+}
+
+#else
+
+bool createHeadlessContext() {
+    std::cerr << "Headless rendering needs EGL, this build has none." << '\n';
+    return false;
+}
+
+void destroyHeadlessContext() {}
+
+#endif
+
+/**
+ *  Returns the GL renderer and version string of the current context
+ */
+std::string headlessRenderer() {
+    const char* renderer = (const char*)glGetString(GL_RENDERER);
+    const char* version  = (const char*)glGetString(GL_VERSION);
+    return std::string(renderer ? renderer : "unknown") + " | " + (version ? version : "unknown");
+}
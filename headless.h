@@ -0,0 +1,23 @@
+/**
+ *   Header for the headless GL context.
+ *
+ *   Creates an OpenGL 4.3 core context without a window through EGL on the
+ *   surfaceless platform (Mesa llvmpipe on machines without a GPU). The
+ *   context has no default framebuffer, callers render into their own FBO.
+ *
+ *   Only available when CMake found EGL, see PACMAN_HAS_EGL.
+ *
+ *   @file     headless.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __HEADLESS_H
+#define __HEADLESS_H
+
+#include <string>
+
+bool        createHeadlessContext();
+void        destroyHeadlessContext();
+std::string headlessRenderer();
+
+#endif
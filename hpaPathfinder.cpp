@@ -0,0 +1,394 @@
+/**
+ *   HpaPathfinder, clusters, entrances and the abstract graph search
+ *
+ *   Borders are scanned for runs of tiles where a move crosses from one
+ *   cluster to the next. Runs of up to 5 tiles get a transition in the
+ *   middle, longer ones one at each end, as in the original HPA* paper.
+ *
+ *   @file     hpaPathfinder.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "hpaPathfinder.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+
+static const int directions[4] = { 2, 4, 3, 9 };   //By direction index, as NavGraph::indexOf
+static const int stepX[4]      = { 0, 0, -1, 1 },
+                 stepY[4]      = { 1, -1, 0, 0 };
+
+/**
+ *  Returns the abstract node on a tile, adding it if there is none
+ */
+int HpaPathfinder::addNode(int x, int y) {
+    int tile = y * width + x;
+    if (tileNode[tile] < 0) {
+        tileNode[tile] = int(nodeTile.size());
+        nodeTile.push_back(tile);
+    }
+    return tileNode[tile];
+}
+
+/**
+ *  Adds the transitions along one cluster border
+ *
+ *  @param x, y    - first tile on the near side of the border
+ *  @param along   - direction the border runs in
+ *  @param cross   - direction from the near to the far side
+ *  @param length  - tiles along the border
+ *  @param pending - receives the edges over the border, by source node
+ */
+void HpaPathfinder::addEntrances(int x, int y, int along, int cross, int length, std::vector<std::pair<int, Edge>>& pending) {
+    int a = NavGraph::indexOf(along),
+        c = NavGraph::indexOf(cross),
+        back = NavGraph::reverseOf(cross);
+    auto open = [&](int i) {
+        int nearX = x + i * stepX[a], nearY = y + i * stepY[a];
+        return nav->canMove(nearX, nearY, cross) || nav->canMove(nearX + stepX[c], nearY + stepY[c], back);
+    };
+    auto transition = [&](int i) {
+        int nearX = x + i * stepX[a], nearY = y + i * stepY[a],
+            farX  = nearX + stepX[c], farY = nearY + stepY[c],
+            nearNode = addNode(nearX, nearY),
+            farNode  = addNode(farX, farY);
+        if (nav->canMove(nearX, nearY, cross)) { pending.push_back({ nearNode, { farNode, 1 } }); }
+        if (nav->canMove(farX, farY, back))    { pending.push_back({ farNode, { nearNode, 1 } }); }
+    };
+    for (int i = 0; i < length; ) {
+        if (!open(i)) { i++; continue; }
+        int first = i;
+        while (i < length && open(i)) { i++; }
+        if (i - first <= 5) { transition((first + i - 1) / 2); }
+        else                { transition(first); transition(i - 1); }
+    }
+}
+
+/**
+ *  Breadth first search that stays inside the cluster of a tile
+ *
+ *  @param x, y       - tile the search starts from
+ *  @param backwards  - follow moves into the tile instead of out of it
+ *  @param dist       - receives distances by localIndex, -1 if not reached
+ *  @param trackMoves - fill firstMove with the first move toward each tile
+ */
+void HpaPathfinder::searchCluster(int x, int y, bool backwards, std::vector<int>& dist, bool trackMoves) {
+    int left   = (x / clusterSize) * clusterSize,
+        bottom = (y / clusterSize) * clusterSize,
+        right  = std::min(width,  left + clusterSize),
+        top    = std::min(height, bottom + clusterSize),
+        origin = localIndex(x, y),
+        head = 0, tail = 0;
+    std::fill(dist.begin(), dist.end(), -1);
+    dist[origin] = 0;
+    localQueue[tail++] = y * width + x;
+    while (head < tail) {
+        int tile = localQueue[head++],
+            tx = tile % width,
+            ty = tile / width,
+            here = localIndex(tx, ty);
+        for (int d = 0; d < 4; d++) {
+            int nx = backwards ? tx - stepX[d] : tx + stepX[d],
+                ny = backwards ? ty - stepY[d] : ty + stepY[d];
+            if (nx < left || ny < bottom || right <= nx || top <= ny) { continue; }
+            int next = localIndex(nx, ny);
+            if (0 <= dist[next]) { continue; }
+            if (!nav->canMove(backwards ? nx : tx, backwards ? ny : ty, directions[d])) { continue; }
+            dist[next] = dist[here] + 1;
+            if (trackMoves) { firstMove[next] = (here == origin) ? uint8_t(d) : firstMove[here]; }
+            localQueue[tail++] = ny * width + nx;
+        }
+    }
+}
+
+/**
+ *  Builds clusters, transitions and the abstract graph
+ *
+ *  @param graph - graph whose masks define the legal moves
+ *  @param size  - cluster side in tiles
+ */
+void HpaPathfinder::build(NavGraph& graph, int size) {
+    auto start = std::chrono::steady_clock::now();
+    nav = &graph;
+    clusterSize = size;
+    std::pair<int, int> widthHeight = graph.getWidthHeight();
+    width     = widthHeight.first;
+    height    = widthHeight.second;
+    clustersX = (width  + clusterSize - 1) / clusterSize;
+    clustersY = (height + clusterSize - 1) / clusterSize;
+    tileNode.assign(size_t(width) * height, -1);
+    nodeTile.clear();
+
+    std::vector<std::pair<int, Edge>> pending;
+    for (int cx = 1; cx < clustersX; cx++) {
+        for (int cy = 0; cy < clustersY; cy++) {
+            int y = cy * clusterSize;
+            addEntrances(cx * clusterSize - 1, y, 2, 9, std::min(clusterSize, height - y), pending);
+        }
+    }
+    for (int cy = 1; cy < clustersY; cy++) {
+        for (int cx = 0; cx < clustersX; cx++) {
+            int x = cx * clusterSize;
+            addEntrances(x, cy * clusterSize - 1, 9, 2, std::min(clusterSize, width - x), pending);
+        }
+    }
+
+    //Nodes by cluster
+    int nodes = getNodeCount();
+    clusterStart.assign(size_t(clustersX) * clustersY + 1, 0);
+    for (int tile : nodeTile) { clusterStart[clusterOf(tile % width, tile / width) + 1]++; }
+    for (size_t c = 1; c < clusterStart.size(); c++) { clusterStart[c] += clusterStart[c - 1]; }
+    clusterNodes.assign(nodes, 0);
+    std::vector<int> fill(clusterStart.begin(), clusterStart.end() - 1);
+    for (int node = 0; node < nodes; node++) {
+        clusterNodes[fill[clusterOf(nodeTile[node] % width, nodeTile[node] / width)]++] = node;
+    }
+
+    //Walking distances between the transitions of each cluster. A walk that passes another
+    //transition at no extra cost is left out, A* finds it as two edges, which keeps open
+    //areas with many transitions from turning every cluster into a clique
+    startDist.assign(size_t(clusterSize) * clusterSize, -1);
+    goalDist.assign(startDist.size(), -1);
+    localQueue.assign(startDist.size(), 0);
+    firstMove.assign(startDist.size(), 0);
+    std::vector<int> between;
+    for (int c = 0; c + 1 < int(clusterStart.size()); c++) {
+        int first = clusterStart[c],
+            count = clusterStart[c + 1] - first;
+        between.assign(size_t(count) * count, -1);
+        for (int i = 0; i < count; i++) {
+            int from = clusterNodes[first + i];
+            searchCluster(nodeTile[from] % width, nodeTile[from] / width, false, startDist, false);
+            for (int j = 0; j < count; j++) {
+                int to = clusterNodes[first + j];
+                between[i * count + j] = startDist[localIndex(nodeTile[to] % width, nodeTile[to] / width)];
+            }
+        }
+        for (int i = 0; i < count; i++) {
+            for (int j = 0; j < count; j++) {
+                int d = between[i * count + j];
+                if (d <= 0) { continue; }
+                bool passes = false;
+                for (int k = 0; k < count && !passes; k++) {
+                    int in = between[i * count + k], out = between[k * count + j];
+                    passes = (0 < in && 0 < out && in + out == d);
+                }
+                if (!passes) { pending.push_back({ clusterNodes[first + i], { clusterNodes[first + j], d } }); }
+            }
+        }
+    }
+
+    //Edges by source node
+    edgeStart.assign(size_t(nodes) + 1, 0);
+    for (auto& edge : pending) { edgeStart[edge.first + 1]++; }
+    for (int n = 0; n < nodes; n++) { edgeStart[n + 1] += edgeStart[n]; }
+    edges.assign(pending.size(), { 0, 0 });
+    fill.assign(edgeStart.begin(), edgeStart.end() - 1);
+    for (auto& edge : pending) { edges[fill[edge.first]++] = edge.second; }
+
+    nodeCost.assign(size_t(nodes) + 1, 0);
+    nodeParent.assign(size_t(nodes) + 1, -1);
+    nodeStamp.assign(size_t(nodes) + 1, 0);
+    stamp = 0;
+    openList.clear();
+    openList.reserve(edges.size() + 2 * size_t(nodes) + 1);     //Every push is a seed, an edge or a way to the goal
+    pathScratch.clear();
+    pathScratch.reserve(size_t(nodes) + 1);
+    cache.assign(cacheSize, CacheEntry());
+    queries = cacheHits = 0;
+    buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ *  Finds a path between two walkable tiles. Tiles in the same cluster
+ *  that can reach each other inside it are answered by the first search.
+ *
+ *  @param from - start tile, y * width + x
+ *  @param to   - goal tile
+ *
+ *  @return returns the length of the path or -1 if there is none. The
+ *          abstract nodes on it are left in pathScratch, empty for a path
+ *          inside one cluster, and firstMove holds the first moves from
+ *          the start toward every tile of its cluster.
+ */
+int HpaPathfinder::search(int from, int to) {
+    int fromX = from % width, fromY = from / width,
+        toX   = to % width,   toY   = to / width;
+    pathScratch.clear();
+    searchCluster(fromX, fromY, false, startDist, true);
+    if (clusterOf(fromX, fromY) == clusterOf(toX, toY) && 0 <= startDist[localIndex(toX, toY)]) {
+        return startDist[localIndex(toX, toY)];
+    }
+    searchCluster(toX, toY, true, goalDist, false);
+
+    //A* over the transitions, goal is a virtual node reached from the goal cluster
+    int goal = getNodeCount(),
+        goalCluster = clusterOf(toX, toY);
+    if (++stamp == 0) { std::fill(nodeStamp.begin(), nodeStamp.end(), 0); stamp = 1; }
+    auto estimate = [&](int node) {
+        if (node == goal) { return 0; }
+        return std::abs(nodeTile[node] % width - toX) + std::abs(nodeTile[node] / width - toY);
+    };
+    auto open = [&](int node, int cost, int parent) {
+        if (nodeStamp[node] == stamp && nodeCost[node] <= cost) { return; }
+        nodeStamp[node]  = stamp;
+        nodeCost[node]   = cost;
+        nodeParent[node] = parent;
+        openList.push_back({ cost + estimate(node), cost, node });
+        std::push_heap(openList.begin(), openList.end(), std::greater<OpenEntry>());
+    };
+    openList.clear();
+    int startCluster = clusterOf(fromX, fromY);
+    for (int i = clusterStart[startCluster]; i < clusterStart[startCluster + 1]; i++) {
+        int node = clusterNodes[i],
+            d    = startDist[localIndex(nodeTile[node] % width, nodeTile[node] / width)];
+        if (0 <= d) { open(node, d, -1); }
+    }
+    while (!openList.empty()) {
+        OpenEntry top = openList.front();
+        std::pop_heap(openList.begin(), openList.end(), std::greater<OpenEntry>());
+        openList.pop_back();
+        int node = top.node;
+        if (top.cost != nodeCost[node]) { continue; }   //Opened again cheaper
+        if (node == goal) { break; }
+        int x = nodeTile[node] % width,
+            y = nodeTile[node] / width;
+        if (clusterOf(x, y) == goalCluster && 0 <= goalDist[localIndex(x, y)]) {
+            open(goal, nodeCost[node] + goalDist[localIndex(x, y)], node);
+        }
+        for (int e = edgeStart[node]; e < edgeStart[node + 1]; e++) { open(edges[e].to, nodeCost[node] + edges[e].cost, node); }
+    }
+    if (nodeStamp[goal] != stamp) { return -1; }
+    for (int node = nodeParent[goal]; node != -1; node = nodeParent[node]) { pathScratch.push_back(node); }
+    std::reverse(pathScratch.begin(), pathScratch.end());
+    return nodeCost[goal];
+}
+
+/**
+ *  Returns the first move toward a tile, refining only the first part of the path
+ *
+ *  @return returns the direction to take, 0 if already there or there is no path
+ */
+int HpaPathfinder::nextDir(int fromX, int fromY, int toX, int toY) {
+    if (nav->legalMask(fromX, fromY) == 0 || nav->legalMask(toX, toY) == 0) { return 0; }
+    int from = fromY * width + fromX,
+        to   = toY * width + toX;
+    if (from == to) { return 0; }
+
+    uint64_t key = (uint64_t(from) << 32) | uint32_t(to);
+    CacheEntry& entry = cache[((uint64_t(from) * 73856093u) ^ (uint64_t(to) * 19349663u)) & (cacheSize - 1)];
+    queries++;
+    if (entry.key == key) { cacheHits++; return entry.dir; }
+
+    int cost = search(from, to),
+        dir  = 0;
+    if (cost < 0) { dir = 0; }
+    else if (pathScratch.empty()) { dir = directions[firstMove[localIndex(toX, toY)]]; }
+    else {
+        //The first waypoint that is not the start, inside its cluster or one step over the border
+        int next = nodeTile[pathScratch[0]];
+        if (next == from) { next = (1 < pathScratch.size()) ? nodeTile[pathScratch[1]] : to; }
+        int nextX = next % width, nextY = next / width;
+        if (clusterOf(nextX, nextY) == clusterOf(fromX, fromY)) { dir = directions[firstMove[localIndex(nextX, nextY)]]; }
+        else {
+            for (int d = 0; d < 4; d++) {
+                if (fromX + stepX[d] == nextX && fromY + stepY[d] == nextY) { dir = directions[d]; }
+            }
+        }
+    }
+    entry.key  = key;
+    entry.dir  = dir;
+    entry.cost = cost;
+    return dir;
+}
+
+/**
+ *  Returns the length of the path the pathfinder would take
+ *
+ *  @return returns -1 if either tile is not walkable or there is no path
+ */
+int HpaPathfinder::distance(int fromX, int fromY, int toX, int toY) {
+    if (nav->legalMask(fromX, fromY) == 0 || nav->legalMask(toX, toY) == 0) { return -1; }
+    if (fromX == toX && fromY == toY) { return 0; }
+    nextDir(fromX, fromY, toX, toY);
+    int from = fromY * width + fromX,
+        to   = toY * width + toX;
+    return cache[((uint64_t(from) * 73856093u) ^ (uint64_t(to) * 19349663u)) & (cacheSize - 1)].cost;
+}
+
+/**
+ *  Appends the tiles after from up to and including to, which are next to
+ *  each other or in the same cluster
+ */
+void HpaPathfinder::appendLeg(int from, int to, std::vector<int>& tiles) {
+    int x = from % width, y = from / width,
+        toX = to % width, toY = to / width;
+    if (clusterOf(x, y) != clusterOf(toX, toY)) { tiles.push_back(to); return; }
+    searchCluster(toX, toY, true, goalDist, false);
+    while (x != toX || y != toY) {
+        int here = goalDist[localIndex(x, y)];
+        for (int d = 0; d < 4; d++) {
+            int nx = x + stepX[d], ny = y + stepY[d];
+            if (nx < 0 || ny < 0 || width <= nx || height <= ny || clusterOf(nx, ny) != clusterOf(toX, toY)) { continue; }
+            if (nav->canMove(x, y, directions[d]) && goalDist[localIndex(nx, ny)] == here - 1) { x = nx; y = ny; break; }
+        }
+        tiles.push_back(y * width + x);
+    }
+}
+
+/**
+ *  Refines a whole path, tile by tile
+ *
+ *  @param tiles - receives the tiles from the start to the goal, both included
+ *
+ *  @return returns the length of the path or -1 if there is none
+ */
+int HpaPathfinder::findPath(int fromX, int fromY, int toX, int toY, std::vector<int>& tiles) {
+    tiles.clear();
+    if (nav->legalMask(fromX, fromY) == 0 || nav->legalMask(toX, toY) == 0) { return -1; }
+    int from = fromY * width + fromX,
+        to   = toY * width + toX;
+    tiles.push_back(from);
+    if (from == to) { return 0; }
+    if (search(from, to) < 0) { tiles.clear(); return -1; }
+
+    std::vector<int> waypoints;
+    waypoints.reserve(pathScratch.size() + 1);
+    for (int node : pathScratch) { waypoints.push_back(nodeTile[node]); }
+    waypoints.push_back(to);
+    for (int waypoint : waypoints) {
+        if (waypoint != tiles.back()) { appendLeg(tiles.back(), waypoint, tiles); }
+    }
+    return int(tiles.size()) - 1;
+}
+
+/**
+ *  Forgets every cached nextDir() answer
+ */
+void HpaPathfinder::clearCache() {
+    std::fill(cache.begin(), cache.end(), CacheEntry());
+    queries = cacheHits = 0;
+}
+
+/**
+ *  Returns the bytes held by the abstract graph, cache and query scratch
+ */
+size_t HpaPathfinder::getBytes() {
+    return (tileNode.size() + nodeTile.size() + clusterStart.size() + clusterNodes.size() + edgeStart.size()
+          + startDist.size() + goalDist.size() + localQueue.size() + nodeCost.size() + nodeParent.size()
+          + pathScratch.capacity()) * sizeof(int)
+         + edges.size() * sizeof(Edge) + cache.size() * sizeof(CacheEntry)
+         + openList.capacity() * sizeof(OpenEntry) + firstMove.size() + nodeStamp.size() * sizeof(uint32_t);
+}
+
+/**
+ *  Prints the size of the abstract graph and how often the cache answered
+ */
+void HpaPathfinder::report() {
+    printf("HPA*: %dx%d clusters of %d tiles, %d transitions, %d edges, %.1f KB, built in %.2f ms",
+        clustersX, clustersY, clusterSize, getNodeCount(), getEdgeCount(), getBytes() / 1024.0, buildMs);
+    if (0 < queries) { printf(", %lld queries %.0f%% cached", queries, 100.0 * cacheHits / queries); }
+    printf("\n");
+}
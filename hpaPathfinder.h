@@ -0,0 +1,116 @@
+/**
+ *   Header for the HpaPathfinder class.
+ *
+ *   Hierarchical pathfinding (HPA*) for levels too big for the
+ *   DistanceOracle table. The map is cut into square clusters, every run
+ *   of open tiles along a cluster border gets one or two transitions, and
+ *   the transitions of a cluster are linked by their walking distance
+ *   inside it. A query searches the start and goal clusters tile by tile,
+ *   runs A* over the small abstract graph in between and refines only as
+ *   much of the path as it needs: nextDir() only the first move,
+ *   findPath() every tile. Answers of nextDir() are cached, ghosts at the
+ *   same junction heading for the same tile ask the same question.
+ *
+ *   Paths can be a few tiles longer than the shortest, they are always
+ *   legal. Moves follow the legal move masks of a NavGraph, which must
+ *   outlive the pathfinder and be rebuilt together with it.
+ *
+ *   @file     hpaPathfinder.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __HPAPATHFINDER_H
+#define __HPAPATHFINDER_H
+
+#include "navGraph.h"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+ // -----------------------------------------------------------------------------
+ // HpaPathfinder Class header
+ // -----------------------------------------------------------------------------
+class HpaPathfinder {
+public:
+    static const int defaultClusterSize = 16,
+                     cacheSize          = 4096;     //nextDir() answers kept, a power of two
+
+private:
+    /**
+     *  Abstract graph edge, a step over a border or a walk inside a cluster
+     */
+    struct Edge {
+        int to,
+            cost;
+    };
+
+    /**
+     *  Abstract node waiting in the A* open list
+     */
+    struct OpenEntry {
+        int estimate,
+            cost,
+            node;
+        bool operator>(const OpenEntry& other) const {          //Ties go to the node further along
+            return estimate > other.estimate || (estimate == other.estimate && cost < other.cost);
+        }
+    };
+
+    /**
+     *  One remembered nextDir() answer
+     */
+    struct CacheEntry {
+        uint64_t key  = UINT64_MAX;
+        int      dir  = 0,
+                 cost = -1;
+    };
+
+    NavGraph* nav = nullptr;
+    int width = 0, height = 0,
+        clusterSize = defaultClusterSize,
+        clustersX = 0, clustersY = 0;
+    std::vector<int>  tileNode,             //Abstract node on a tile, -1 if none
+                      nodeTile,             //Tile of an abstract node
+                      clusterStart,         //First entry of a cluster in clusterNodes
+                      clusterNodes,         //Abstract nodes by cluster
+                      edgeStart;            //First edge of a node in edges
+    std::vector<Edge> edges;
+    std::vector<CacheEntry> cache;
+    long long queries = 0,
+              cacheHits = 0;
+    double buildMs = 0.0;
+
+    //Query scratch, sized at build so queries do not allocate
+    std::vector<int>      startDist, goalDist,  //Tile distances inside the start and goal cluster
+                          localQueue,
+                          nodeCost, nodeParent;
+    std::vector<OpenEntry> openList;            //Min heap by estimate
+    std::vector<uint8_t>  firstMove;            //Direction index of the first move toward a start cluster tile
+    std::vector<uint32_t> nodeStamp;
+    uint32_t stamp = 0;
+    std::vector<int>      pathScratch;
+
+    int  clusterOf(int x, int y)        { return (y / clusterSize) * clustersX + (x / clusterSize); };
+    int  localIndex(int x, int y)       { return (y % clusterSize) * clusterSize + (x % clusterSize); };
+    int  addNode(int x, int y);
+    void addEntrances(int x, int y, int along, int cross, int length, std::vector<std::pair<int, Edge>>& pending);
+    void searchCluster(int x, int y, bool backwards, std::vector<int>& dist, bool trackMoves);
+    int  search(int from, int to);
+    void appendLeg(int from, int to, std::vector<int>& tiles);
+
+public:
+    void    build(NavGraph& graph, int size = defaultClusterSize);
+    void    report();
+    int     nextDir(int fromX, int fromY, int toX, int toY);
+    int     distance(int fromX, int fromY, int toX, int toY);
+    int     findPath(int fromX, int fromY, int toX, int toY, std::vector<int>& tiles);
+
+    int     getNodeCount()      { return int(nodeTile.size()); };
+    int     getEdgeCount()      { return int(edges.size()); };
+    size_t  getBytes();
+    double  getBuildMs()        { return buildMs; };
+    void    clearCache();
+};
+
+#endif
@@ -14,6 +14,7 @@
 #include "shaders/ghostShad.h"
 #include "shaders/playerShad.h"
 #include "shaders/modelShader.h"
+#include "shaders/overlayShad.h"
 
  //Library Inclusion
 #include <glad/glad.h>
@@ -29,5 +30,6 @@
 #include <set>
 #include <cmath>
 #include <vector>
+#include <algorithm>
 
 #endif
\ No newline at end of file
@@ -0,0 +1,105 @@
+/**
+ *   InputQueue, lock free key event ring with latency tracking
+ *
+ *   @file     inputQueue.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "inputQueue.h"
+#include "flightRecorder.h"
+#include <algorithm>
+#include <cstdio>
+
+/**
+ *  Adds a latency sample, the oldest is overwritten once the window is full
+ *
+ *  @param latencyNs - latency in nanoseconds
+ */
+void LatencyStats::addSample(int64_t latencyNs) {
+    samples[next] = latencyNs / 1000000.0f;
+    next = (next + 1) % sampleCapacity;
+    if (count < sampleCapacity) { count++; }
+}
+
+/**
+ *  Returns a percentile of the samples in milliseconds
+ *
+ *  @param p - percentile between 0 and 100
+ *
+ *  @return returns the percentile, 0 without samples
+ */
+float LatencyStats::percentile(float p) {
+    if (count == 0) { return 0.0f; }
+    std::vector<float> sorted(samples, samples + count);
+    size_t rank = std::min(size_t(p / 100.0f * count), size_t(count - 1));
+    std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+    return sorted[rank];
+}
+
+/**
+ *  Queues a direction request, producer side (key callback)
+ *
+ *  @param dir - requested direction
+ *
+ *  @return returns false if the ring was full and the event was dropped
+ */
+bool InputQueue::push(int dir) {
+    uint32_t write = tail.load(std::memory_order_relaxed);
+    if (write - head.load(std::memory_order_acquire) == capacity) { dropped++; return false; }
+    events[write % capacity] = { dir, FlightRecorder::now() };
+    tail.store(write + 1, std::memory_order_release);
+    return true;
+}
+
+/**
+ *  Reads the oldest event without removing it, consumer side (simulation tick)
+ *
+ *  @param out - set to the oldest event
+ *
+ *  @return returns false if the queue is empty
+ */
+bool InputQueue::peek(InputEvent& out) {
+    uint32_t read = head.load(std::memory_order_relaxed);
+    if (read == tail.load(std::memory_order_acquire)) { return false; }
+    out = events[read % capacity];
+    return true;
+}
+
+/**
+ *  Removes the oldest event, only call after a successful peek
+ */
+void InputQueue::pop() {
+    head.store(head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+/**
+ *  Records that the simulation acted on an event
+ *
+ *  @param event - the applied event
+ */
+void InputQueue::markApplied(const InputEvent& event) {
+    toSimulation.addSample(FlightRecorder::now() - event.timestampNs);
+    if (waitingForPresent.size() < waitingForPresent.capacity()) { waitingForPresent.push_back(event.timestampNs); }
+}
+
+/**
+ *  Records that a frame showing every applied event was swapped, call after glfwSwapBuffers
+ */
+void InputQueue::markPresented() {
+    if (waitingForPresent.empty()) { return; }
+    int64_t now = FlightRecorder::now();
+    for (auto& timestamp : waitingForPresent) { toPresent.addSample(now - timestamp); }
+    waitingForPresent.clear();
+}
+
+/**
+ *  Prints latency percentiles over the most recent samples
+ */
+void InputQueue::report() {
+    printf("Input latency (ms)      p50     p90     p99   samples\n");
+    printf("  to simulation     %7.2f %7.2f %7.2f %7i\n", toSimulation.percentile(50), toSimulation.percentile(90),
+           toSimulation.percentile(99), toSimulation.getCount());
+    printf("  to present        %7.2f %7.2f %7.2f %7i\n", toPresent.percentile(50), toPresent.percentile(90),
+           toPresent.percentile(99), toPresent.getCount());
+    if (dropped) { printf("  %u events dropped, queue was full\n", dropped); }
+}
@@ -0,0 +1,71 @@
+/**
+ *   Header for the InputQueue class.
+ *
+ *   Single producer, single consumer ring of timestamped direction requests.
+ *   The GLFW key callback pushes, the simulation tick pops, neither side
+ *   takes a lock. Every event keeps the time it arrived so the queue can
+ *   report how long input waited for the simulation and for the next frame.
+ *
+ *   @file     inputQueue.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __INPUTQUEUE_H
+#define __INPUTQUEUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+/**
+ *  One direction request from the keyboard
+ */
+struct InputEvent {
+    int     dir;            //2 up, 4 down, 3 left, 9 right, like Character::dir
+    int64_t timestampNs;    //FlightRecorder::now() when the key callback ran
+};
+
+/**
+ *  Fixed window of latency samples with percentile lookup
+ */
+class LatencyStats {
+public:
+    static const int sampleCapacity = 4096;
+private:
+    float   samples[sampleCapacity];    //Milliseconds, oldest overwritten
+    int     count = 0,
+            next  = 0;
+public:
+    void    addSample(int64_t latencyNs);
+    float   percentile(float p);
+    int     getCount()  { return count; };
+};
+
+ // -----------------------------------------------------------------------------
+ // InputQueue Class header
+ // -----------------------------------------------------------------------------
+class InputQueue {
+public:
+    static const uint32_t capacity = 64;    //Power of two
+
+private:
+    InputEvent              events[capacity];
+    std::atomic<uint32_t>   head{ 0 },      //Next slot to read, written by the consumer
+                            tail{ 0 };      //Next slot to write, written by the producer
+    uint32_t                dropped = 0;    //Producer side, events lost to a full ring
+
+    LatencyStats            toSimulation,
+                            toPresent;
+    std::vector<int64_t>    waitingForPresent;  //Applied events not yet on screen
+
+public:
+    InputQueue() { waitingForPresent.reserve(capacity); };
+    bool    push(int dir);
+    bool    peek(InputEvent& out);
+    void    pop();
+    void    markApplied(const InputEvent& event);
+    void    markPresented();
+    void    report();
+};
+
+#endif
@@ -0,0 +1,185 @@
+/**
+ *   JobSystem, work-stealing workers for data parallel frame work
+ *
+ *   @file     jobSystem.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "jobSystem.h"
+#include "profiler.h"
+#include <algorithm>
+#include <cstdio>
+
+static thread_local const JobSystem* workerSystem = nullptr;    //System the current thread works for
+static thread_local int workerNumber = 0;                       //Its deque in that system
+
+/**
+ *  Starts the worker threads
+ *
+ *  @param workerCount - workers including the calling thread, 0 picks one per hardware thread
+ */
+JobSystem::JobSystem(int workerCount) {
+    if (workerCount <= 0) { workerCount = hardwareWorkers(); }
+    for (int i = 0; i < workerCount; i++) {
+        workers.emplace_back(new Worker());
+        workers.back()->ring.resize(dequeSize);
+    }
+    for (int i = 1; i < workerCount; i++) {
+        threads.emplace_back(&JobSystem::workerLoop, this, i);
+    }
+}
+
+/**
+ *  Stops and joins the workers, every wait() must have returned
+ */
+JobSystem::~JobSystem() {
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& thread : threads) { thread.join(); }
+}
+
+/**
+ *  Returns one worker per hardware thread, at least one
+ */
+int JobSystem::hardwareWorkers() {
+    return std::max(1, int(std::thread::hardware_concurrency()));
+}
+
+/**
+ *  Returns the deque of the calling thread, threads outside the system share the owner's
+ */
+int JobSystem::currentWorker() {
+    return (workerSystem == this) ? workerNumber : 0;
+}
+
+/**
+ *  Puts a job at the back of a deque
+ *
+ *  @return returns false if the deque is full
+ */
+bool JobSystem::push(int worker, const Job& job) {
+    Worker& deque = *workers[worker];
+    std::lock_guard<std::mutex> lock(deque.mutex);
+    if (deque.size == dequeSize) { return false; }
+    deque.ring[(deque.front + deque.size) % dequeSize] = job;
+    deque.size++;
+    queued++;
+    return true;
+}
+
+/**
+ *  Takes the newest job from the back of a worker's own deque
+ */
+bool JobSystem::pop(int worker, Job& job) {
+    Worker& deque = *workers[worker];
+    std::lock_guard<std::mutex> lock(deque.mutex);
+    if (deque.size == 0) { return false; }
+    deque.size--;
+    job = deque.ring[(deque.front + deque.size) % dequeSize];
+    queued--;
+    return true;
+}
+
+/**
+ *  Takes the oldest job from the front of another worker's deque, victims are tried in turn after the thief
+ */
+bool JobSystem::steal(int thief, Job& job) {
+    int count = int(workers.size());
+    for (int offset = 1; offset < count; offset++) {
+        Worker& deque = *workers[(thief + offset) % count];
+        std::lock_guard<std::mutex> lock(deque.mutex);
+        if (deque.size == 0) { continue; }
+        job = deque.ring[deque.front];
+        deque.front = (deque.front + 1) % dequeSize;
+        deque.size--;
+        queued--;
+        stolen++;
+        return true;
+    }
+    return false;
+}
+
+/**
+ *  Runs a job and counts it off its batch
+ */
+void JobSystem::execute(const Job& job) {
+    job.function(job.data, job.first, job.last);
+    executed++;
+    if (job.counter) { job.counter->left--; }
+}
+
+/**
+ *  Wakes sleeping workers for newly queued jobs
+ */
+void JobSystem::wakeWorkers() {
+    if (threads.empty()) { return; }
+    {
+        std::lock_guard<std::mutex> lock(sleepMutex);
+    }
+    wake.notify_all();
+}
+
+/**
+ *  Queues a job on the calling thread's deque without waking anyone, with
+ *  one worker or a full deque it runs right away
+ */
+void JobSystem::queue(const Job& job) {
+    if (threads.empty() || !push(currentWorker(), job)) { execute(job); }
+}
+
+/**
+ *  Queues a job on the calling thread's deque and wakes the workers
+ *
+ *  @param job - job to run, its counter must be counted up before
+ */
+void JobSystem::submit(const Job& job) {
+    queue(job);
+    wakeWorkers();
+}
+
+/**
+ *  Runs and steals jobs until a batch is done
+ *
+ *  @param counter - batch to wait for
+ */
+void JobSystem::wait(Counter& counter) {
+    int worker = currentWorker();
+    Job job;
+    while (0 < counter.left) {
+        if (take(worker, job)) { execute(job); }
+        else { std::this_thread::yield(); }
+    }
+}
+
+/**
+ *  Worker body, runs and steals jobs and sleeps when there are none
+ *
+ *  @param index - deque of the worker
+ */
+void JobSystem::workerLoop(int index) {
+    workerSystem = this;
+    workerNumber = index;
+    PROFILE_THREAD_NAME("job worker");
+    Job job;
+    while (true) {
+        if (take(index, job)) {
+            PROFILE_ZONE("job");
+            execute(job);
+            continue;
+        }
+        std::unique_lock<std::mutex> lock(sleepMutex);
+        wake.wait(lock, [this] { return stopping || 0 < queued; });
+        if (stopping) { return; }
+    }
+}
+
+/**
+ *  Prints the amount of workers and jobs
+ */
+void JobSystem::report() {
+    printf("Job system: %i workers (%i hardware threads), %lli jobs run, %lli stolen\n",
+        getWorkerCount(), int(std::thread::hardware_concurrency()), getExecuted(), getStolen());
+}
@@ -0,0 +1,129 @@
+/**
+ *   Header for the JobSystem class.
+ *
+ *   A work-stealing job system for data parallel work inside a frame. Every
+ *   worker has its own deque of jobs: it pushes and pops at the back, and
+ *   workers that run dry steal from the front of the others. The thread
+ *   that owns the system is worker 0 and helps with the work while it waits,
+ *   so a system of one worker runs everything inline on the caller.
+ *
+ *   Jobs are plain function pointers over an index range, nothing is
+ *   allocated per job. parallelFor() splits a range into chunks that only
+ *   depend on the count and the chunk size, never on the amount of workers,
+ *   so work that writes only its own items gives the same result on any
+ *   amount of threads.
+ *
+ *   @file     jobSystem.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __JOBSYSTEM_H
+#define __JOBSYSTEM_H
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+ // -----------------------------------------------------------------------------
+ // JobSystem Class header
+ // -----------------------------------------------------------------------------
+class JobSystem {
+public:
+    typedef void (*JobFunction)(void* data, int first, int last);
+
+    /**
+     *  Jobs left of a batch, wait() returns once it reaches 0
+     */
+    struct Counter {
+        std::atomic<int> left{ 0 };
+    };
+
+    /**
+     *  One job, runs function(data, first, last)
+     */
+    struct Job {
+        JobFunction function;
+        void*       data;
+        int         first,
+                    last;
+        Counter*    counter;
+    };
+
+    static const int dequeSize = 1024;              //Jobs one worker holds, a full deque runs the job inline
+
+private:
+    /**
+     *  Deque of one worker, a ring where the owner works at the back and thieves take from the front
+     */
+    struct Worker {
+        std::mutex       mutex;
+        std::vector<Job> ring;
+        int              front = 0,
+                         size  = 0;
+    };
+
+    std::vector<std::unique_ptr<Worker>> workers;   //Deques, 0 belongs to the owning thread
+    std::vector<std::thread>             threads;
+    std::mutex               sleepMutex;
+    std::condition_variable  wake;
+    std::atomic<int>         queued{ 0 };           //Jobs in all deques
+    std::atomic<long long>   executed{ 0 },
+                             stolen{ 0 };
+    bool    stopping = false;
+
+    bool    push(int worker, const Job& job);
+    void    queue(const Job& job);
+    bool    pop(int worker, Job& job);
+    bool    steal(int thief, Job& job);
+    bool    take(int worker, Job& job)  { return pop(worker, job) || steal(worker, job); };
+    void    execute(const Job& job);
+    void    workerLoop(int index);
+    int     currentWorker();
+    void    wakeWorkers();
+
+    template <typename Body>
+    static void runBody(void* data, int first, int last) { (*static_cast<Body*>(data))(first, last); }
+
+public:
+    JobSystem(int workerCount = 0);
+    ~JobSystem();
+
+    void    submit(const Job& job);
+    void    wait(Counter& counter);
+
+    /**
+     *  Runs body(first, last) over [0, count) in chunks and returns when all are done
+     *
+     *  @param count - items in the range
+     *  @param chunk - items in one job, the last job takes what is left
+     *  @param body  - called as body(first, last), from any worker at once
+     */
+    template <typename Body>
+    void parallelFor(int count, int chunk, Body&& body) {
+        typedef typename std::remove_reference<Body>::type BodyType;
+        if (count <= 0) { return; }
+        if (chunk < 1) { chunk = 1; }
+        if (count <= chunk || workers.size() == 1) { body(0, count); return; }
+        Counter counter;
+        counter.left = (count + chunk - 1) / chunk;
+        for (int first = chunk; first < count; first += chunk) {
+            queue({ &runBody<BodyType>, (void*)&body, first, (first + chunk < count) ? first + chunk : count, &counter });
+        }
+        wakeWorkers();
+        body(0, chunk);
+        counter.left--;
+        wait(counter);
+    }
+
+    void    report();
+    int     getWorkerCount()        { return int(workers.size()); };
+    long long getExecuted()         { return executed; };
+    long long getStolen()           { return stolen; };
+    static int hardwareWorkers();
+};
+
+#endif
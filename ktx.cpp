@@ -0,0 +1,420 @@
+/**
+ *   KTX container reading/writing, mip chain generation and BC1/BC3 encoding
+ *
+ *   @file     ktx.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "ktx.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+
+static const unsigned char ktxIdentifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+/**
+ *  KTX 1.1 header, follows the identifier
+ */
+struct KtxHeader {
+    uint32_t endianness,
+             glType,
+             glTypeSize,
+             glFormat,
+             glInternalFormat,
+             glBaseInternalFormat,
+             pixelWidth,
+             pixelHeight,
+             pixelDepth,
+             numberOfArrayElements,
+             numberOfFaces,
+             numberOfMipmapLevels,
+             bytesOfKeyValueData;
+};
+
+// -----------------------------------------------------------------------------
+// MIP CHAIN
+// -----------------------------------------------------------------------------
+
+/**
+ *  Box filters an RGBA8 image down to half size, odd edges are clamped
+ *
+ *  @param src    - source pixels
+ *  @param width  - source width
+ *  @param height - source height
+ *
+ *  @return returns the next mip level
+ */
+static std::vector<unsigned char> halveImage(const std::vector<unsigned char>& src, int width, int height) {
+    int newWidth  = (width  > 1) ? width  / 2 : 1,
+        newHeight = (height > 1) ? height / 2 : 1;
+    std::vector<unsigned char> dst(size_t(newWidth) * newHeight * 4);
+    for (int y = 0; y < newHeight; y++) {
+        for (int x = 0; x < newWidth; x++) {
+            int x0 = x * 2, x1 = (x0 + 1 < width)  ? x0 + 1 : x0,
+                y0 = y * 2, y1 = (y0 + 1 < height) ? y0 + 1 : y0;
+            for (int c = 0; c < 4; c++) {
+                int sum = src[(size_t(y0) * width + x0) * 4 + c] + src[(size_t(y0) * width + x1) * 4 + c]
+                        + src[(size_t(y1) * width + x0) * 4 + c] + src[(size_t(y1) * width + x1) * 4 + c];
+                dst[(size_t(y) * newWidth + x) * 4 + c] = (unsigned char)((sum + 2) / 4);
+            }
+        }
+    }
+    return dst;
+}
+
+/**
+ *  Bilinear resample of an RGBA8 image, used to fit images into texture array layers
+ *
+ *  @param rgba      - source pixels
+ *  @param width     - source width
+ *  @param height    - source height
+ *  @param newWidth  - destination width
+ *  @param newHeight - destination height
+ *
+ *  @return returns the resampled pixels
+ */
+std::vector<unsigned char> resampleImage(const unsigned char* rgba, int width, int height,
+                                         int newWidth, int newHeight) {
+    std::vector<unsigned char> dst(size_t(newWidth) * newHeight * 4);
+    for (int y = 0; y < newHeight; y++) {
+        float fy = (y + 0.5f) * height / newHeight - 0.5f;
+        if (fy < 0.0f) fy = 0.0f;
+        int   y0 = int(fy), y1 = (y0 + 1 < height) ? y0 + 1 : y0;
+        float ty = fy - y0;
+        for (int x = 0; x < newWidth; x++) {
+            float fx = (x + 0.5f) * width / newWidth - 0.5f;
+            if (fx < 0.0f) fx = 0.0f;
+            int   x0 = int(fx), x1 = (x0 + 1 < width) ? x0 + 1 : x0;
+            float tx = fx - x0;
+            for (int c = 0; c < 4; c++) {
+                float top = rgba[(size_t(y0) * width + x0) * 4 + c] * (1 - tx) + rgba[(size_t(y0) * width + x1) * 4 + c] * tx,
+                      bot = rgba[(size_t(y1) * width + x0) * 4 + c] * (1 - tx) + rgba[(size_t(y1) * width + x1) * 4 + c] * tx;
+                dst[(size_t(y) * newWidth + x) * 4 + c] = (unsigned char)(top * (1 - ty) + bot * ty + 0.5f);
+            }
+        }
+    }
+    return dst;
+}
+
+// -----------------------------------------------------------------------------
+// BLOCK COMPRESSION
+// -----------------------------------------------------------------------------
+
+/**
+ *  Packs an RGB888 color to RGB565
+ */
+static uint16_t pack565(const int rgb[3]) {
+    return uint16_t(((rgb[0] >> 3) << 11) | ((rgb[1] >> 2) << 5) | (rgb[2] >> 3));
+}
+
+/**
+ *  Expands an RGB565 color back to RGB888, the way the hardware does
+ */
+static void unpack565(uint16_t color, int rgb[3]) {
+    int r = (color >> 11) & 31, g = (color >> 5) & 63, b = color & 31;
+    rgb[0] = (r << 3) | (r >> 2);
+    rgb[1] = (g << 2) | (g >> 4);
+    rgb[2] = (b << 3) | (b >> 2);
+}
+
+/**
+ *  Encodes the color half of a block (BC1 layout, four color mode)
+ *
+ *  @param block - 16 RGBA8 pixels
+ *  @param out   - 8 byte destination
+ */
+static void encodeColorBlock(const unsigned char* block, unsigned char* out) {
+    int minC[3] = { 255, 255, 255 }, maxC[3] = { 0, 0, 0 };
+    for (int p = 0; p < 16; p++) {
+        for (int c = 0; c < 3; c++) {
+            if (block[p * 4 + c] < minC[c]) minC[c] = block[p * 4 + c];
+            if (block[p * 4 + c] > maxC[c]) maxC[c] = block[p * 4 + c];
+        }
+    }
+    for (int c = 0; c < 3; c++) {                           //Inset the box to reduce the error at the ends
+        int inset = (maxC[c] - minC[c]) / 16;
+        minC[c] += inset;
+        maxC[c] -= inset;
+    }
+
+    uint16_t c0 = pack565(maxC), c1 = pack565(minC);        //c0 >= c1 since every channel of max >= min
+    uint32_t indices = 0;
+    if (c0 != c1) {
+        int palette[4][3];
+        unpack565(c0, palette[0]);
+        unpack565(c1, palette[1]);
+        for (int c = 0; c < 3; c++) {
+            palette[2][c] = (2 * palette[0][c] + palette[1][c]) / 3;
+            palette[3][c] = (palette[0][c] + 2 * palette[1][c]) / 3;
+        }
+        for (int p = 0; p < 16; p++) {
+            int best = 0, bestDist = 1 << 30;
+            for (int i = 0; i < 4; i++) {
+                int dist = 0;
+                for (int c = 0; c < 3; c++) {
+                    int d = block[p * 4 + c] - palette[i][c];
+                    dist += d * d;
+                }
+                if (dist < bestDist) { bestDist = dist; best = i; }
+            }
+            indices |= uint32_t(best) << (p * 2);
+        }
+    }
+    out[0] = c0 & 0xFF; out[1] = c0 >> 8;
+    out[2] = c1 & 0xFF; out[3] = c1 >> 8;
+    for (int i = 0; i < 4; i++) { out[4 + i] = (indices >> (i * 8)) & 0xFF; }
+}
+
+/**
+ *  Encodes the alpha half of a BC3 block, eight value mode
+ *
+ *  @param block - 16 RGBA8 pixels
+ *  @param out   - 8 byte destination
+ */
+static void encodeAlphaBlock(const unsigned char* block, unsigned char* out) {
+    int a0 = 0, a1 = 255;
+    for (int p = 0; p < 16; p++) {
+        if (block[p * 4 + 3] > a0) a0 = block[p * 4 + 3];
+        if (block[p * 4 + 3] < a1) a1 = block[p * 4 + 3];
+    }
+    uint64_t indices = 0;
+    if (a0 != a1) {
+        int palette[8] = { a0, a1 };
+        for (int i = 1; i < 7; i++) { palette[i + 1] = ((7 - i) * a0 + i * a1) / 7; }
+        for (int p = 0; p < 16; p++) {
+            int best = 0, bestDist = 256;
+            for (int i = 0; i < 8; i++) {
+                int dist = block[p * 4 + 3] - palette[i];
+                if (dist < 0) dist = -dist;
+                if (dist < bestDist) { bestDist = dist; best = i; }
+            }
+            indices |= uint64_t(best) << (p * 3);
+        }
+    }
+    out[0] = (unsigned char)a0;
+    out[1] = (unsigned char)a1;
+    for (int i = 0; i < 6; i++) { out[2 + i] = (indices >> (i * 8)) & 0xFF; }
+}
+
+/**
+ *  Compresses one RGBA8 level, edges of levels smaller than a block are clamped
+ *
+ *  @param rgba           - level pixels
+ *  @param width          - level width
+ *  @param height         - level height
+ *  @param internalFormat - DXT1 or DXT5 enum
+ *
+ *  @return returns the compressed blocks
+ */
+static std::vector<unsigned char> compressLevel(const std::vector<unsigned char>& rgba, int width, int height,
+                                                GLenum internalFormat) {
+    bool alpha = (internalFormat == GL_COMPRESSED_RGBA_S3TC_DXT5_EXT);
+    int blockBytes = alpha ? 16 : 8,
+        blocksX = (width + 3) / 4,
+        blocksY = (height + 3) / 4;
+    std::vector<unsigned char> out(size_t(blocksX) * blocksY * blockBytes);
+    unsigned char block[16 * 4];
+
+    for (int by = 0; by < blocksY; by++) {
+        for (int bx = 0; bx < blocksX; bx++) {
+            for (int p = 0; p < 16; p++) {
+                int x = bx * 4 + (p % 4), y = by * 4 + (p / 4);
+                if (x >= width)  x = width - 1;
+                if (y >= height) y = height - 1;
+                memcpy(&block[p * 4], &rgba[(size_t(y) * width + x) * 4], 4);
+            }
+            unsigned char* dst = &out[(size_t(by) * blocksX + bx) * blockBytes];
+            if (alpha) { encodeAlphaBlock(block, dst); dst += 8; }
+            encodeColorBlock(block, dst);
+        }
+    }
+    return out;
+}
+
+// -----------------------------------------------------------------------------
+// KTX TEXTURE
+// -----------------------------------------------------------------------------
+
+/**
+ *  Builds a full mip chain and encodes it
+ *
+ *  @param rgba           - RGBA8 pixels of level 0
+ *  @param width          - width of level 0
+ *  @param height         - height of level 0
+ *  @param internalFormat - GL_COMPRESSED_RGBA_S3TC_DXT1_EXT, ..._DXT5_EXT or GL_RGBA8
+ *
+ *  @return returns the texture, ready for writeKtx
+ */
+KtxTexture buildKtxTexture(const unsigned char* rgba, int width, int height, GLenum internalFormat) {
+    KtxTexture texture;
+    texture.width = width;
+    texture.height = height;
+    texture.glInternalFormat = internalFormat;
+    if (internalFormat == GL_RGBA8) {
+        texture.glType = GL_UNSIGNED_BYTE;
+        texture.glFormat = GL_RGBA;
+    }
+
+    std::vector<unsigned char> level(rgba, rgba + size_t(width) * height * 4);
+    int w = width, h = height;
+    while (true) {
+        if (texture.compressed()) { texture.levels.push_back(compressLevel(level, w, h, internalFormat)); }
+        else                      { texture.levels.push_back(level); }
+        if (w == 1 && h == 1) { break; }
+        level = halveImage(level, w, h);
+        w = (w > 1) ? w / 2 : 1;
+        h = (h > 1) ? h / 2 : 1;
+    }
+    return texture;
+}
+
+/**
+ *  Checks if any pixel is not fully opaque, decides between BC1 and BC3
+ */
+bool hasTransparency(const unsigned char* rgba, int width, int height) {
+    for (size_t p = 0; p < size_t(width) * height; p++) {
+        if (rgba[p * 4 + 3] != 255) { return true; }
+    }
+    return false;
+}
+
+/**
+ *  Returns the memory used by all levels in bytes
+ */
+size_t ktxByteSize(const KtxTexture& texture) {
+    size_t size = 0;
+    for (auto& level : texture.levels) { size += level.size(); }
+    return size;
+}
+
+/**
+ *  Human readable name of a supported format
+ */
+std::string ktxFormatName(GLenum internalFormat) {
+    switch (internalFormat) {
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: return "BC1";
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return "BC3";
+    case GL_RGBA8:                         return "RGBA8";
+    default:                               return "unknown";
+    }
+}
+
+/**
+ *  Returns the path of the converted sibling of an image, "a/b.png" -> "a/b.ktx"
+ */
+std::string ktxPathFor(const std::string& imagePath) {
+    size_t dot = imagePath.find_last_of('.');
+    size_t slash = imagePath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) { return imagePath + ".ktx"; }
+    return imagePath.substr(0, dot) + ".ktx";
+}
+
+/**
+ *  Returns the bytes one level of a supported format takes
+ *
+ *  @return returns 0 for formats readKtx does not load
+ */
+static size_t ktxLevelSize(GLenum internalFormat, int width, int height) {
+    size_t blocks = size_t((width + 3) / 4) * size_t((height + 3) / 4);
+    switch (internalFormat) {
+    case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT: return blocks * 8;
+    case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT: return blocks * 16;
+    case GL_RGBA8:                         return size_t(width) * size_t(height) * 4;
+    default:                               return 0;
+    }
+}
+
+/**
+ *  Reads a KTX 1.1 file with a single 2D face
+ *
+ *  @param filepath - file to read
+ *  @param texture  - filled with the levels
+ *
+ *  @return returns false if the file is missing, truncated or not something we can upload
+ */
+bool readKtx(const std::string& filepath, KtxTexture& texture) {
+    static const uint32_t maxSize = 16384;
+    std::ifstream in(filepath, std::ios::binary | std::ios::ate);
+    if (!in) { return false; }
+    std::streamoff fileSize = in.tellg();
+    in.seekg(0);
+
+    unsigned char identifier[12];
+    KtxHeader header;
+    in.read((char*)identifier, sizeof(identifier));
+    in.read((char*)&header, sizeof(header));
+    if (!in || memcmp(identifier, ktxIdentifier, sizeof(ktxIdentifier)) != 0
+            || header.endianness != 0x04030201
+            || header.numberOfFaces != 1 || header.pixelDepth != 0 || header.numberOfArrayElements != 0
+            || header.pixelWidth == 0 || header.pixelWidth > maxSize
+            || header.pixelHeight == 0 || header.pixelHeight > maxSize
+            || header.numberOfMipmapLevels > 32
+            || ktxLevelSize(header.glInternalFormat, 1, 1) == 0
+            || (header.glInternalFormat == GL_RGBA8) == (header.glType == 0)) {
+        return false;
+    }
+    in.seekg(header.bytesOfKeyValueData, std::ios::cur);
+
+    texture = KtxTexture();
+    texture.glType = header.glType;
+    texture.glFormat = header.glFormat;
+    texture.glInternalFormat = header.glInternalFormat;
+    texture.width = int(header.pixelWidth);
+    texture.height = int(header.pixelHeight);
+    uint32_t levels = header.numberOfMipmapLevels ? header.numberOfMipmapLevels : 1;
+    int w = texture.width, h = texture.height;
+    for (uint32_t l = 0; l < levels; l++) {
+        //The size must match the format and dimensions and fit in what is left of the file
+        uint32_t imageSize = 0;
+        in.read((char*)&imageSize, sizeof(imageSize));
+        std::streamoff position = in.tellg();
+        if (!in || imageSize != ktxLevelSize(texture.glInternalFormat, w, h)
+                || position < 0 || std::streamoff(imageSize) > fileSize - position) {
+            return false;
+        }
+        std::vector<unsigned char> level(imageSize);
+        in.read((char*)level.data(), imageSize);
+        in.seekg((4 - (imageSize % 4)) % 4, std::ios::cur);  //mipPadding
+        if (!in) { return false; }
+        texture.levels.push_back(std::move(level));
+        w = (w > 1) ? w / 2 : 1;
+        h = (h > 1) ? h / 2 : 1;
+    }
+    return true;
+}
+
+/**
+ *  Writes a KTX 1.1 file
+ *
+ *  @param filepath - file to write
+ *  @param texture  - levels to store
+ *
+ *  @return returns false if the file could not be written
+ */
+bool writeKtx(const std::string& filepath, const KtxTexture& texture) {
+    std::ofstream out(filepath, std::ios::binary);
+    if (!out) { return false; }
+
+    KtxHeader header = {};
+    header.endianness = 0x04030201;
+    header.glType = texture.glType;
+    header.glTypeSize = 1;
+    header.glFormat = texture.glFormat;
+    header.glInternalFormat = texture.glInternalFormat;
+    header.glBaseInternalFormat = GL_RGBA;
+    header.pixelWidth = uint32_t(texture.width);
+    header.pixelHeight = uint32_t(texture.height);
+    header.numberOfFaces = 1;
+    header.numberOfMipmapLevels = uint32_t(texture.levels.size());
+
+    out.write((const char*)ktxIdentifier, sizeof(ktxIdentifier));
+    out.write((const char*)&header, sizeof(header));
+    const char padding[4] = { 0 };
+    for (auto& level : texture.levels) {
+        uint32_t imageSize = uint32_t(level.size());
+        out.write((const char*)&imageSize, sizeof(imageSize));
+        out.write((const char*)level.data(), imageSize);
+        out.write(padding, (4 - (imageSize % 4)) % 4);
+    }
+    return bool(out);
+}
@@ -0,0 +1,47 @@
+/**
+ *   Header for the KTX texture container and block compression helpers.
+ *
+ *   Textures are stored as KTX 1.1 files holding a full mip chain, either
+ *   BC1/BC3 (S3TC DXT1/DXT5) blocks or plain RGBA8. The offline converter in
+ *   tools/texconv.cpp writes them, the game reads them back in decode_image.
+ *
+ *   @file     ktx.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __KTX_H
+#define __KTX_H
+
+#include <glad/glad.h>
+#include <string>
+#include <vector>
+
+/**
+ *  A texture with all of its mip levels, level 0 first
+ */
+struct KtxTexture {
+    GLenum  glType           = 0,   //0 for compressed formats
+            glFormat         = 0,   //0 for compressed formats
+            glInternalFormat = 0;
+    int     width  = 0,
+            height = 0;
+    std::vector<std::vector<unsigned char>> levels;
+
+    bool    compressed() const { return glType == 0; };
+};
+
+// -----------------------------------------------------------------------------
+// FUNCTION PROTOTYPES
+// -----------------------------------------------------------------------------
+
+KtxTexture  buildKtxTexture(const unsigned char* rgba, int width, int height, GLenum internalFormat);
+std::vector<unsigned char> resampleImage(const unsigned char* rgba, int width, int height,
+                                         int newWidth, int newHeight);
+bool        hasTransparency(const unsigned char* rgba, int width, int height);
+size_t      ktxByteSize(const KtxTexture& texture);
+std::string ktxFormatName(GLenum internalFormat);
+std::string ktxPathFor(const std::string& imagePath);
+bool        readKtx(const std::string& filepath, KtxTexture& texture);
+bool        writeKtx(const std::string& filepath, const KtxTexture& texture);
+
+#endif
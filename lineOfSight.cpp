@@ -0,0 +1,171 @@
+/**
+ *   LineOfSight, batched grid raycasts for ghost perception
+ *
+ *   A ray from tile center to tile center crosses the vertical grid lines
+ *   at (0.5 + i) / dx of the way and the horizontal ones at (0.5 + j) / dy.
+ *   Comparing (1 + 2i) * dy with (1 + 2j) * dx tells which comes first
+ *   without division, and both only grow by adding.
+ *
+ *   @file     lineOfSight.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "lineOfSight.h"
+#include "map.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+/**
+ *  Copies the walls of a map and builds the run tables
+ *
+ *  @param map       - loaded map, walls are 1
+ *  @param runTables - build the row and column tables for rays along one axis
+ */
+void LineOfSight::build(Map& map, bool runTables) {
+    auto start = std::chrono::steady_clock::now();
+    std::pair<int, int> size = map.getWidthHeight();
+    width  = size.first;
+    height = size.second;
+    opaque.assign(size_t(width) * height, 0);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) { opaque[size_t(y) * width + x] = (map.getMapVal(x, y) == 1); }
+    }
+
+    axisTable = runTables && width <= 65536 && height <= 65536;
+    rowFirst.clear();
+    rowLast.clear();
+    colFirst.clear();
+    colLast.clear();
+    if (axisTable) {
+        size_t tiles = size_t(width) * height;
+        rowFirst.resize(tiles);
+        rowLast.resize(tiles);
+        colFirst.resize(tiles);
+        colLast.resize(tiles);
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; ) {
+                int end = x;
+                while (end + 1 < width && !isWall(x, y) && !isWall(end + 1, y)) { end++; }
+                for (int run = x; run <= end; run++) {
+                    rowFirst[size_t(y) * width + run] = uint16_t(x);
+                    rowLast[size_t(y) * width + run]  = uint16_t(end);
+                }
+                x = end + 1;
+            }
+        }
+        for (int x = 0; x < width; x++) {
+            for (int y = 0; y < height; ) {
+                int end = y;
+                while (end + 1 < height && !isWall(x, y) && !isWall(x, end + 1)) { end++; }
+                for (int run = y; run <= end; run++) {
+                    colFirst[size_t(run) * width + x] = uint16_t(y);
+                    colLast[size_t(run) * width + x]  = uint16_t(end);
+                }
+                y = end + 1;
+            }
+        }
+    }
+    buildMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+/**
+ *  Answers a ray along one row or column from the run tables
+ *
+ *  @param answer - receives the answer if there was one
+ *
+ *  @return returns true if the tables answered the ray
+ */
+bool LineOfSight::axisVisible(int fromX, int fromY, int toX, int toY, bool& answer) {
+    if (!axisTable) { return false; }
+    size_t from = size_t(fromY) * width + fromX;
+    if (fromY == toY) {
+        answer = !isWall(fromX, fromY) && rowFirst[from] <= toX && toX <= rowLast[from];
+        return true;
+    }
+    if (fromX == toX) {
+        answer = !isWall(fromX, fromY) && colFirst[from] <= toY && toY <= colLast[from];
+        return true;
+    }
+    return false;
+}
+
+/**
+ *  Walks one ray tile by tile
+ *
+ *  @param query - ray with both ends inside the map
+ *
+ *  @return returns true if no wall is on the way, the end tiles included
+ */
+bool LineOfSight::walk(const Query& query) {
+    int dx  = std::abs(query.toX - query.fromX),
+        dy  = std::abs(query.toY - query.fromY),
+        sx  = (query.fromX < query.toX) ? 1 : -1,
+        syW = (query.fromY < query.toY) ? width : -width,
+        left = dx + dy;
+    const uint8_t* at = opaque.data() + size_t(query.fromY) * width + query.fromX;
+    long long ex = dy,      //(1 + 2 * x steps) * dy
+              ey = dx;      //(1 + 2 * y steps) * dx
+    if (*at) { return false; }
+    while (0 < left) {
+        if (ex < ey)      { at += sx;  ex += 2 * dy; left--; }
+        else if (ey < ex) { at += syW; ey += 2 * dx; left--; }
+        else {
+            //Through a corner, both tiles that touch it have to be open
+            if (at[sx] || at[syW]) { return false; }
+            at += sx + syW;
+            ex += 2 * dy;
+            ey += 2 * dx;
+            left -= 2;
+        }
+        if (*at) { return false; }
+    }
+    return true;
+}
+
+/**
+ *  Answers one ray
+ *
+ *  @return returns true if the tiles see each other, false if either is outside the map
+ */
+bool LineOfSight::visible(int fromX, int fromY, int toX, int toY) {
+    if (!inside(fromX, fromY) || !inside(toX, toY)) { return false; }
+    bool answer;
+    if (axisVisible(fromX, fromY, toX, toY, answer)) { return answer; }
+    return walk({ fromX, fromY, toX, toY });
+}
+
+/**
+ *  Answers a batch of rays, same answers as visible()
+ *
+ *  @param queries - rays to answer
+ *  @param visible - receives 1 for every ray that sees its end, 0 otherwise
+ */
+void LineOfSight::trace(const std::vector<Query>& queries, std::vector<uint8_t>& visible) {
+    visible.resize(queries.size());
+    for (size_t q = 0; q < queries.size(); q++) {
+        const Query& query = queries[q];
+        bool answer = false;
+        if (inside(query.fromX, query.fromY) && inside(query.toX, query.toY)
+            && !axisVisible(query.fromX, query.fromY, query.toX, query.toY, answer)) {
+            answer = walk(query);
+        }
+        visible[q] = answer;
+    }
+}
+
+/**
+ *  Returns the bytes held by the wall copy and run tables
+ */
+size_t LineOfSight::getBytes() {
+    return opaque.size()
+         + (rowFirst.size() + rowLast.size() + colFirst.size() + colLast.size()) * sizeof(uint16_t);
+}
+
+/**
+ *  Prints the size of the tables
+ */
+void LineOfSight::report() {
+    printf("Line of sight: %dx%d tiles, %s, %.1f KB, built in %.2f ms\n",
+        width, height, axisTable ? "row and column run tables" : "no run tables", getBytes() / 1024.0, buildMs);
+}
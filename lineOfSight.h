@@ -0,0 +1,68 @@
+/**
+ *   Header for the LineOfSight class.
+ *
+ *   Line of sight between tile centers on a flat copy of the map, where
+ *   only walls block. A ray walks the grid with an integer DDA, so the
+ *   tiles it passes are exact and seeing is symmetric: a ray that goes
+ *   through a corner is blocked if a wall touches the corner on either side.
+ *
+ *   trace() answers a batch of queries. Rays along one row or column are
+ *   answered from run tables when they are built: every tile knows where
+ *   the open run it is in starts and ends, in its row and in its column.
+ *   The rest are walked one after another, most end at the first wall a
+ *   tile or two away, so the walk is kept short and free of setup.
+ *
+ *   @file     lineOfSight.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __LINEOFSIGHT_H
+#define __LINEOFSIGHT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Map;
+
+ // -----------------------------------------------------------------------------
+ // LineOfSight Class header
+ // -----------------------------------------------------------------------------
+class LineOfSight {
+public:
+    /**
+     *  One ray, from the center of one tile to the center of another
+     */
+    struct Query {
+        int fromX, fromY,
+            toX,   toY;
+    };
+
+private:
+    int width  = 0,
+        height = 0;
+    std::vector<uint8_t>  opaque;           //1 for walls, y * width + x
+    bool axisTable = false;
+    std::vector<uint16_t> rowFirst,         //First and last x of the open run a tile is in
+                          rowLast,
+                          colFirst,         //First and last y of the open run a tile is in
+                          colLast;
+    double buildMs = 0.0;
+
+    bool  walk(const Query& query);
+    bool  axisVisible(int fromX, int fromY, int toX, int toY, bool& answer);
+    bool  inside(int x, int y)  { return 0 <= x && 0 <= y && x < width && y < height; };
+
+public:
+    void    build(Map& map, bool runTables = true);
+    void    report();
+    bool    visible(int fromX, int fromY, int toX, int toY);
+    void    trace(const std::vector<Query>& queries, std::vector<uint8_t>& visible);
+
+    bool    isWall(int x, int y)    { return inside(x, y) && opaque[size_t(y) * width + x]; };
+    bool    hasAxisTable()          { return axisTable; };
+    size_t  getBytes();
+    double  getBuildMs()            { return buildMs; };
+};
+
+#endif
@@ -13,230 +13,227 @@
  */
 #define TINYOBJLOADER_IMPLEMENTATION
 #include "initialize.h"
-#include "pacman.h"
-#include "ghost.h"
-#include "pellet.h"
-#include "map.h"
+#include "scene.h"
+#include "profiler.h"
+#include "overlay.h"
+#include "framePacer.h"
+#include "benchmark.h"
+#include "renderStats.h"
+#include "allocTracker.h"
+#include "arena.h"
+#include <cstring>
 
 // -----------------------------------------------------------------------------
 // ENTRY POINT
 // -----------------------------------------------------------------------------
 /**
  *  main function
+ *
+ *  @param argc - argument count
+ *  @param argv - optional --hitch-budget <ms> and --hitch-window <seconds> for the flight recorder,
+ *                --pacing vsync|adaptive|sleep for the frame pacer, --stats-csv <file> to stream
+ *                render statistics, --bench to run the headless benchmark instead of the game
+ *                (see BenchOptions for its flags, --workers sets the job system size for both)
  */
-int main(){
-    //Container definition
-    std::vector<Map*>		Maps;		///< Contains only map, permits adding more maps in the future
-    std::vector<Pacman*>    Pacmans;    ///< Contains only pacman, done for ease of use
-    std::vector<Ghost*>     Ghosts;     ///< Contains ghosts
-    std::vector<Pellet*>    Pellets;    ///< Contains All pellets
-    Camera* cameraAdress = new Camera();
-
-    // Creates coordinates for map
-    auto window = initializeWindow();
-    recieveCamera(cameraAdress);
-    if (window == nullptr) { return EXIT_FAILURE; }
-
-    //Init map
-    Maps.push_back(new Map("../../../../levels/level0"));
-    std::pair<float, float>XYshift = Maps[0]->getXYshift();
-    Maps[0]->getMapCameraPointer(cameraAdress);
-    Maps[0]->compileMapShader();
-    cameraAdress->recieveMap(Maps[0]->getIntMap());
-    //printf("Map Loaded\n");
-
-    //Init pacman
-    Pacmans.push_back(new Pacman(Maps[0]->getPacSpawnPoint(), XYshift));
-    Pacmans[0]->compilePacShader();
-    Pacmans[0]->setWidthHeight(Maps[0]->getWidthHeight());
-    Pacmans[0]->setXYshift(XYshift);
-    Pacmans[0]->getCameraPointer(cameraAdress);
-    Pacmans[0]->setVAO(Pacmans[0]->compilePacman());
-    //printf("Pacman Loaded\n");
-
-    //Init pellets
-    std::pair<int, int> WidthHeight = Maps[0]->getWidthHeight();
-    for (int y = 0; y < WidthHeight.second; y++) {
-        for (int x = 0; x < WidthHeight.first; x++) {
-            if (Maps[0]->getMapVal(x, y) == 0) { Pellets.push_back(new Pellet(x, y, XYshift)); }
-        }
-    }
-    Maps[0]->setPelletAmount(Pellets.size());
-    Pellets[0]->pelletSetWidthHeight(Maps[0]->getWidthHeight());
-    Pellets[0]->getPelletCameraPointer(cameraAdress);
-
-    int pelletStride = 3;
-    std::vector<float> pelletContainer; //initial fill
-    for (auto& it : Pellets) {
-        for (int vert = 0; vert < Pellets[0]->getVertSize(); vert++) {
-            pelletContainer.push_back(it->getVertCoord(vert));
+int main(int argc, char** argv){
+    //Frames over budget write the recent history to hitch_frame<N>.json
+    float hitchBudgetMs = 33.0f,
+          hitchWindowSeconds = 5.0f;
+    FramePacer::Mode pacingMode = FramePacer::VSYNC;
+    bool bench = false;
+    BenchOptions benchOptions;
+    std::string statsCsv;
+    for (int arg = 1; arg < argc; arg++) {
+        std::string flag = argv[arg];
+        bool hasValue = arg + 1 < argc;
+        if (flag == "--bench") { bench = true; }
+        else if (flag == "--hitch-budget" && hasValue) { hitchBudgetMs = std::stof(argv[++arg]); }
+        else if (flag == "--hitch-window" && hasValue) { hitchWindowSeconds = std::stof(argv[++arg]); }
+        else if (flag == "--stats-csv" && hasValue) { statsCsv = argv[++arg]; }
+        else if (flag == "--pacing" && hasValue) {
+            if (!FramePacer::parseMode(argv[++arg], pacingMode)) {
+                printf("Unknown pacing mode %s, expected vsync, adaptive or sleep\n", argv[arg]);
+            }
         }
+        else if (!parseBenchOption(arg, argc, argv, benchOptions)) { printf("Unknown argument %s\n", argv[arg]); }
     }
-    Pellets[0]->callCreatePelletVAO((&pelletContainer[0]), pelletContainer.size() * sizeof(pelletContainer[0]), pelletStride);
-    Pellets[0]->callCompilePelletShader();
-
-    //Pellet collision vector
-    std::vector<std::vector<Pellet*>> pelletMap(WidthHeight.second, std::vector<Pellet*>(WidthHeight.first, nullptr));
-    for (auto& pIT : Pellets) {
-        std::pair<int, int> tempXY = pIT->getPelletXY();
-        pelletMap[tempXY.second][tempXY.first] = pIT;
+    FlightRecorder::attachThread();
+    ALLOC_ATTACH_THREAD();
+    FlightRecorder::configure(hitchBudgetMs, hitchWindowSeconds);
+    if (!statsCsv.empty() && !RenderStats::openCsv(statsCsv)) {
+        printf("Could not write %s\n", statsCsv.c_str());
+        statsCsv.clear();
     }
-    //printf("Pellet Loaded\n");
-
-    //spawn ghosts
-    int ghostAmount = 5;
-    std::vector<int>ghostPos;
-    if (0 < ghostAmount) { ghostPos = Maps[0]->spawnGhost(ghostAmount); 
-    int count = 0,
-        procs = 0;
-        for (auto& it : Pellets) {
-            for (int l = 0; l < ghostAmount; l++) {
-                if (count == ghostPos[l]) {
-                    Ghosts.push_back(new Ghost(it->checkCoords(0), it->checkCoords(1), true, WidthHeight, XYshift, cameraAdress));
-                    procs++;
-                }
-            }
-            if (procs == ghostAmount) { break; }
-            count++;
-        }
-        Ghosts[0]->callLoadModel();
-        Ghosts[0]->compileGhostModelShader();
-        Ghosts[0]->loadGhostSpriteSheet();
-        int insurance = 0;
-        for (auto& initializeAllGhosts : Ghosts) {
-            if (insurance != 0) {
-                initializeAllGhosts->setShader(Ghosts[0]->getShader());
-                initializeAllGhosts->setVAO(Ghosts[0]->getVAO());
-                initializeAllGhosts->setModelSize(Ghosts[0]->getModelSize());
-                //printf("Ghost Loaded: %i\n", insurance);
-            }
-            insurance++;
-        }
 
+    if (bench) { return runBenchmark(benchOptions); }
+
+    srand((unsigned)time(nullptr));
+    Camera* cameraAdress = new Camera();
+    Scene scene(cameraAdress);
+    JobSystem jobs(benchOptions.workers);
+    scene.setJobSystem(&jobs);
+    jobs.report();
+
+    //Start CPU side loading before the window exists, GL work comes back through finishLoading()
+    AssetPipeline assets;
+    scene.startLoading(assets, benchOptions.level);
+
+    // Creates coordinates for map
+    GLFWwindow* window;
+    {
+        StageTimer stage(assets, "window + GL context");
+        window = initializeWindow();
     }
+    recieveCamera(cameraAdress);
+    if (window == nullptr) { return EXIT_FAILURE; }
+    scene.finishLoading(assets);
+    assets.report();
+
+    //GPU pass timings, shown with G
+    GpuTimer& gpuTimer = scene.getGpuTimer();
+    const glm::vec3 passColors[3] = { glm::vec3(0.2f, 0.4f, 1.0f), glm::vec3(0.8f, 0.8f, 0.0f), glm::vec3(1.0f, 0.3f, 0.3f) };
+    const float overlayScaleMs = 4.0f;      //Time that fills a whole bar
+    Overlay overlay;
+    overlay.compileOverlay();
+    bool showGpuTimes  = false,
+         gpuKeyDown    = false;
+    double titleUpdate = 0.0;
+
+    //Render statistics of the previous frame, shown with R
+    const float statScales[4] = { 32.0f, 64.0f, 256.0f, 200000.0f };   //Draws, binds, upload KB, pellet GS primitives
+    RenderStats::Frame lastStats;
+    bool showRenderStats = false,
+         statsKeyDown    = false;
+    RenderStats::setPipelineStats(!statsCsv.empty());
 
     glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
     glEnable(GL_MULTISAMPLE);
 
     double currentTime = 0.0;
     glfwSetTime(0.0);
-    float frequency = currentTime;
-    float deltaTime = 0.0f;	// time between current frame and last frame
-    float lastFrame = 0.0f;
-    float delay     = 0.015f;
+    float delay     = 0.015f;       //Simulation tick
     bool fullscreen = false;
 
     std::pair<int, int> wihi = cameraAdress->getScreenSize();
 
-    while (!glfwWindowShouldClose(window)) {
-        glfwPollEvents();
+    FramePacer pacer(delay, pacingMode);
+    pacer.applyMode();
 
-        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    //With PACMAN_TRACK_ALLOCS, gameplay frames after the warmup must not touch the heap
+    const int allocWarmupFrames = 120;
+    int renderedFrames = 0;
 
-        //update Time
+    while (!glfwWindowShouldClose(window)) {
+        {
+            PROFILE_ZONE("input");
+            pacer.waitForFrame(window, scene.isRunning());
+        }
         currentTime = glfwGetTime();
-        deltaTime = currentTime - lastFrame;
-        lastFrame = currentTime;
-        
-        if (Pacmans[0]->getRun()) {
-            Pacmans[0]->drawPacman();
-
-            //Pellet Collision
-            float pacLerpProg = Pacmans[0]->getLerpProg();
-            if (0.5f <= pacLerpProg && pacLerpProg <= 0.6) {
-                std::pair<int, int> pacXY = Pacmans[0]->getXY();
-                if (pelletMap[pacXY.second][pacXY.first] != nullptr){
-                    if (pelletMap[pacXY.second][pacXY.first]->getPelletXY() == pacXY) {
-                        if (pelletMap[pacXY.second][pacXY.first]->removePellet()) {
-                            Pacmans[0]->updatePelletState(true);
-                            Pacmans[0]->pickupPellet();
-                        }
-                    }
-                }
-            }
 
-            //If pellets has been eaten, update
-            if (Pacmans[0]->updatePelletState(false)) {
-                pelletContainer.clear();
-                for (auto & it: Pellets){
-                    for (int vert = 0; vert < Pellets[0]->getVertSize(); vert++) {
-                        pelletContainer.push_back(it->getVertCoord(vert));
-                    }
-                }
-                Pellets[0]->cleanPelletVAO();
-                Pellets[0]->callCreatePelletVAO((&pelletContainer[0]), pelletContainer.size() * sizeof(pelletContainer[0]), pelletStride);
-                Pacmans[0]->updatePelletState(true);
-                if (Pellets.size() <= Pacmans[0]->getPellets()) {
-                    printf("All Pellets Collected\n");
-                    Pacmans[0]->setRun(false);
-                }
-            }
+        //Fixed simulation ticks, as many as are due
+        for (int tick = 0; tick < pacer.getTicks() && scene.isRunning(); tick++) {
+            scene.tick(delay);
+        }
+        scene.updatePellets();
 
-            //Draws Ghosts
-            if (0 < ghostAmount) {
-                int mengde = 0;
-                for (auto& drawGhostIt : Ghosts) {
-                    drawGhostIt->drawGhostsAsModels(currentTime, WidthHeight);
+        if (pacer.shouldRender()) {
+            RenderStats::beginFrame();
+            scene.render(currentTime, pacer.getTickLead(currentTime));
+
+            overlay.clearBars();
+            if (showGpuTimes) {
+                for (int pass = 0; pass < gpuTimer.getPassCount(); pass++) {
+                    overlay.addBar(float(gpuTimer.getAverageMs(pass)), overlayScaleMs, passColors[pass % 3]);
                 }
             }
-            Maps[0]->drawMap();
-        }
-        
-        //LERP Update
-        if (currentTime > (frequency + delay) && Pacmans[0]->getRun()) {
-            Pellets[0]->drawPellets(Pellets.size());
-            frequency = currentTime;
-            bool animate = false;
-
-            if (Pacmans[0]->getAnimDel() == 0) { animate = true; Pacmans[0]->updateAnimDel(3, true);
-            }  //the effective speed of animation
-            else { Pacmans[0]->updateAnimDel(-1, false); }
-            Pacmans[0]->checkForKeyUpdate();
-            Pacmans[0]->updateLerp();
-
-            if (animate) Pacmans[0]->pacAnimate();
-
-            if (0 < ghostAmount){
-                std::pair<int, int>pacPos = Pacmans[0]->getXY();
-                for (auto& ghostIt : Ghosts) {
-                    ghostIt->updateLerp();
-                    if (animate) ghostIt->ghostAnimate();
-                    if (ghostIt->checkGhostCollision(pacPos.first, pacPos.second, Maps[0]->getXYshift()))
-                    {
-                        printf("Ghost Collision\n"); Pacmans[0]->setRun(false);
-                    }
+            if (showRenderStats) {
+                int binds = lastStats.programBinds + lastStats.vertexArrayBinds + lastStats.textureBinds;
+                overlay.addBar(float(lastStats.drawCalls), statScales[0], glm::vec3(0.3f, 0.9f, 0.3f));
+                overlay.addBar(float(binds), statScales[1], glm::vec3(0.9f, 0.5f, 0.1f));
+                overlay.addBar(float(lastStats.uploadBytes) / 1024.0f, statScales[2], glm::vec3(0.7f, 0.3f, 0.9f));
+                overlay.addBar(float(lastStats.gsPrimitives), statScales[3], glm::vec3(0.8f, 0.8f, 0.0f));
+            }
+            overlay.drawOverlay();
+
+            if ((showGpuTimes || showRenderStats) && currentTime > titleUpdate + 0.5) {
+                char title[384] = "Pacman";
+                size_t length = strlen(title);
+                if (showGpuTimes) {
+                    length += snprintf(title + length, sizeof(title) - length, " | GPU ms  map %.3f  pellets %.3f  ghosts %.3f",
+                                       gpuTimer.getAverageMs(scene.getMapPass()), gpuTimer.getAverageMs(scene.getPelletPass()),
+                                       gpuTimer.getAverageMs(scene.getGhostPass()));
+                }
+                if (showRenderStats && length < sizeof(title)) {
+                    snprintf(title + length, sizeof(title) - length, " | draws %i  verts %lli  binds prog %i vao %i tex %i  upload %.1f KB  pellet GS %lli in %lli out",
+                             lastStats.drawCalls, (long long)lastStats.vertices, lastStats.programBinds,
+                             lastStats.vertexArrayBinds, lastStats.textureBinds, lastStats.uploadBytes / 1024.0,
+                             (long long)lastStats.gsInvocations, (long long)lastStats.gsPrimitives);
                 }
+                glfwSetWindowTitle(window, title);
+                titleUpdate = currentTime;
+            }
+            lastStats = RenderStats::endFrame();
+            {
+                PROFILE_ZONE("swap");
+                glfwSwapBuffers(window);
             }
-            glfwSwapBuffers(window);
+            cameraAdress->getDesDirQueue().markPresented();
+            bool hitchDumped = FlightRecorder::frameMark(!pacer.wasThrottled());
+            renderedFrames++;
+            ALLOC_FRAME_MARK(scene.isRunning() && !pacer.wasThrottled() && !hitchDumped && renderedFrames > allocWarmupFrames);
+            pacer.frameRendered();
         }
-        
+
+        //Everything staged in the frame arena has been uploaded by now
+        Arena::frame().reset();
+        PROFILE_COUNTER("frame arena KB", Arena::frame().getLastUsed() / 1024.0);
+
         if (glfwGetKey(window, GLFW_KEY_ESCAPE) == GLFW_PRESS) {
             break;
         }
 
+        bool gpuKey   = glfwGetKey(window, GLFW_KEY_G) == GLFW_PRESS,
+             statsKey = glfwGetKey(window, GLFW_KEY_R) == GLFW_PRESS;
+        bool toggled  = (gpuKey && !gpuKeyDown) || (statsKey && !statsKeyDown);
+        if (gpuKey && !gpuKeyDown) { showGpuTimes = !showGpuTimes; }
+        if (statsKey && !statsKeyDown) {
+            showRenderStats = !showRenderStats;
+            RenderStats::setPipelineStats(showRenderStats || !statsCsv.empty());
+        }
+        if (toggled) {
+            titleUpdate = 0.0;
+            if (!showGpuTimes && !showRenderStats) { glfwSetWindowTitle(window, "Pacman"); }
+        }
+        gpuKeyDown   = gpuKey;
+        statsKeyDown = statsKey;
+
         if (glfwGetKey(window, GLFW_KEY_F) == GLFW_PRESS) {
+            FLIGHT_EVENT("fullscreen toggle");
             if (!fullscreen) {
                 fullscreen = true;
                 glfwSetWindowMonitor(window, glfwGetPrimaryMonitor(), NULL, NULL, wihi.first, wihi.second, 30);
             }
             else {
-                
+
                 fullscreen = false;
                 glfwSetWindowMonitor(window, NULL, NULL, NULL, wihi.first, wihi.second, 30);
             }
         }
     }
 
-    glUseProgram(0);
-    Maps[0]->cleanMap();
-    Pacmans[0]->cleanCharacter();
-    if (0 < ghostAmount) Ghosts[0]->cleanCharacter();
-    Pellets[0]->cleanPellets();
+    scene.cleanScene();
+    overlay.cleanOverlay();
+    RenderStats::cleanRenderStats();
 
     glfwTerminate();
+    cameraAdress->getDesDirQueue().report();
+    ALLOC_REPORT();
+    Arena::frame().report();
+    Arena::level().report();
+    PROFILE_DUMP("pacman_trace.json");
+    FlightRecorder::shutdown();
 
     return EXIT_SUCCESS;
-    
+
     return 1;
 }
-
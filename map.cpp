@@ -7,16 +7,24 @@
 
 #include "map.h"
 #include "globFunc.h"
+#include "textureArray.h"
+#include "renderStats.h"
+#include "arena.h"
+#include "floodFill.h"
+#include <algorithm>
 
 /**
-*  Recieves lvlVect in to Pacman[0]
+*  Recieves lvlVect in to Pacman[0], does not touch OpenGL so it can be built on a loader thread
 * 
-*   @param filePath - map file filepath
+*   @param filePath     - map file filepath
+*   @param camera       - camera used for coordinate conversion
+*   @param wallLayer    - texture array layer walls are textured with
 * 
 *   @see Map::mapFloatCreate()
-*   @see Map::loadMapSpriteSheet()
 */
-Map::Map(std::string filePath) {
+Map::Map(std::string filePath, Camera* camera, int wallLayer) {
+    mCamHolder = camera;
+    wallTexture = wallLayer;
     // Read from level file;
     std::ifstream inn(filePath);
     if (inn) {
@@ -39,13 +47,12 @@ Map::Map(std::string filePath) {
         mapI = tempMapVect;
         inn.close();
         mapFloatCreate();
-        loadMapSpriteSheet();
     }
     else { printf("\n\nERROR: Couldnt find level file, check that it is in the right place.\n\n"); exit(EXIT_FAILURE); }
 }
 
 /**
- *  Creates map coordinates
+ *  Creates map coordinates from mapI, replacing any earlier mesh
  *
  *  @see GLfloat getCoordsWithInt(int y, int x, int loop);
  *  @see Map::findWhatWalls(const int x, const int y)
@@ -53,12 +60,26 @@ Map::Map(std::string filePath) {
  *  @see Map::handleMapTexCoords(int rep)
  */
 void Map::mapFloatCreate() {
+    mapF.clear();
+    pelletAmount = 0;
+
+    //Every wall face is 4 corners of X Y Z U V layer, reserving them up front saves regrowing mapF
+    size_t faces = 0;
+    for (int i = 0; i < height; i++) {
+        for (int j = 0; j < width; j++) {
+            if (mapI[i][j] == 1) { faces += std::max(howManyWalls(findWhatWalls(j, i)), 0); }
+        }
+    }
+    mapF.reserve(faces * 4 * vertexStride);
+
     for (int i = 0; i < height; i++) { // creates map
         for (int j = 0; j < width; j++) {
             if (mapI[i][j] == 1) {
                 int loop = 0;
                 int wallType = findWhatWalls(j, i);
-                std::vector<int> loopO = loopOrder(wallType);
+                float layer = float(wallTexture);
+                int loopO[16];
+                loopOrder(wallType, loopO);
                 int counter = 0;
                 for (int l = 0; l < howManyWalls(wallType); l++) {
                     float height = 0.0f;
@@ -71,6 +92,7 @@ void Map::mapFloatCreate() {
                             loop++;
                         }
                         handleMapTexCoords(corners);
+                        mapF.push_back(layer);
                     }
                 }
             }
@@ -147,18 +169,19 @@ int Map::howManyWalls(int num) {
 /**
  *  Finds what wall tile draws a wall
  *
- *  @param num - what type of wall
+ *  @param num   - what type of wall
+ *  @param loopy - filled with the corner order of the walls, room for 16
  *
- *  @return returns float order of walls
+ *  @return returns how many entries were written
  * 
  *  not gonna lie, this took time
  */
-std::vector<int> Map::loopOrder(int num) {
+int Map::loopOrder(int num, int* loopy) {
     std::pair<int, int> up = { 3, 6 };
     std::pair<int, int> left = { 0, 3 };
     std::pair<int, int> right = { 0, 9 };   //
     std::pair<int, int> down = { 6, 9 };    //
-    std::vector<int> loopy;
+    int count = 0;
     int rep = 0;
     int push[8] = { 0 };
     switch (num) {
@@ -188,12 +211,12 @@ std::vector<int> Map::loopOrder(int num) {
     }
     for (int i = 0; i < rep * 2; i += 2) {
         for (int o = 0; o < 2; o++) {
-            loopy.push_back(push[i]);
-            loopy.push_back(push[i + 1]);
+            loopy[count++] = push[i];
+            loopy[count++] = push[i + 1];
         }
     }
 
-    return loopy;
+    return count;
 };
 
 /**
@@ -211,13 +234,17 @@ void Map::compileMapShader(){
 
     GLint mPosAttrib = glGetAttribLocation(mapShaderProgram, "mPosition");
     glEnableVertexAttribArray(mPosAttrib);
-    glVertexAttribPointer(mPosAttrib, 3, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), 0);
+    glVertexAttribPointer(mPosAttrib, 3, GL_FLOAT, GL_FALSE, vertexStride * sizeof(GLfloat), 0);
 
     callCreateMapVao();
 
     GLuint mtexAttrib = glGetAttribLocation(mapShaderProgram, "mTexcoord");
     glEnableVertexAttribArray(mtexAttrib);
-    glVertexAttribPointer(mtexAttrib, 2, GL_FLOAT, GL_FALSE, 5 * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+    glVertexAttribPointer(mtexAttrib, 2, GL_FLOAT, GL_FALSE, vertexStride * sizeof(GLfloat), (void*)(3 * sizeof(GLfloat)));
+
+    GLuint mlayerAttrib = glGetAttribLocation(mapShaderProgram, "mLayer");
+    glEnableVertexAttribArray(mlayerAttrib);
+    glVertexAttribPointer(mlayerAttrib, 1, GL_FLOAT, GL_FALSE, vertexStride * sizeof(GLfloat), (void*)(5 * sizeof(GLfloat)));
 }
 
 void Map::callCreateMapVao() {
@@ -238,8 +265,10 @@ void Map::callCreateMapVao() {
  *  @return returns vao of map
  */
 GLuint Map::CreateMap(float size) {
-    std::vector<GLuint> mapIndices;
-    for (int o = 0; o < (size / 3); o += 4) {
+    ArenaVector<GLuint> mapIndices{ ArenaAllocator<GLuint>(Arena::level()) };
+    int vertexCount = int(size) / vertexStride;
+    mapIndices.reserve(size_t(vertexCount / 4 + 1) * 6);
+    for (int o = 0; o < vertexCount; o += 4) {
         for (int m = 0; m < 2; m++) {
             for (int i = o; i < (o + 3); i++) {
                 int hold = getIndices(o, m, i);
@@ -262,67 +291,71 @@ GLuint Map::CreateMap(float size) {
         size * sizeof((mapF)[0]),
         (&mapF[0]),
         GL_STATIC_DRAW);
+    RenderStats::countUpload(size * sizeof((mapF)[0]));
 
     glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * 5, (const void*)0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(GLfloat) * vertexStride, (const void*)0);
 
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
     glBufferData(GL_ELEMENT_ARRAY_BUFFER, mapIndices.size() * sizeof(mapIndices[0]), (&mapIndices[0]), GL_STATIC_DRAW);
+    RenderStats::countUpload(mapIndices.size() * sizeof(mapIndices[0]));
+    mapIndexCount = int(mapIndices.size());
 
     return vao;
 }
 
 /**
- *  Loads texture for map Walls
- *
- *  @see load_opengl_texture(const std::string& filepath, GLuint slot)
- */
-void Map::loadMapSpriteSheet() {
-    mapSpriteSheet = load_opengl_texture("assets/wallTexture.png", 2);
-}
-
-/**
- *  Cleans shader, texturesheet & mapVAO
+ *  Cleans shader & mapVAO, the wall textures belong to the TextureArray
  *
  *  @see CleanVAO(GLuint& vao)
  */
 void Map::cleanMap() {
     glDeleteProgram(mapShaderProgram);
-    glDeleteTextures(1, &mapSpriteSheet);
     CleanVAO(mapVAO);
 }
 
 /**
- *  Handles Ghost spawning
+ *  Handles Ghost spawning, rand() is seeded once in main. Ghosts go on
+ *  distinct pellet tiles pacman can reach, at least minDistance moves from
+ *  his spawn. Closer tiles are only used when there are not enough far ones,
+ *  and ghosts only share a tile when there are fewer tiles than ghosts.
  *
- *  @param ghostCount - amount of ghost points to be spawned
+ *  @param ghostCount  - amount of ghost points to be spawned
+ *  @param flood       - components of this map
+ *  @param minDistance - moves between pacman's spawn and a ghost
  *
- *  @return returns floats for pellet index for ghosts
+ *  @return returns the tiles to spawn ghosts on, empty if pacman reaches no pellet tile
  */
-std::vector<int> Map::spawnGhost(const int ghostCount) {
-    time_t t;
-    srand((unsigned)time(&t));
-    std::vector<int> formerPositions;
-    bool noDouble = false;
-    do {
-        for (int g = 0; g < ghostCount; g++) {
-            int randPos = 0;
-            randPos = rand() % pelletAmount;
-            formerPositions.push_back(randPos);
+std::vector<std::pair<int, int>> Map::spawnGhost(const int ghostCount, FloodFill& flood, const int minDistance) {
+    std::vector<std::pair<int, int>> spawns;
+    int home = flood.componentOf(pacSpawn.first, pacSpawn.second);
+    std::vector<uint64_t> near = flood.emptyBoard();
+    if (0 <= home) {
+        flood.set(near, pacSpawn.first, pacSpawn.second);
+        flood.grow(near, minDistance - 1);
+    }
+
+    std::vector<std::pair<int, int>> far, close;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (mapI[y][x] != 0 || flood.componentOf(x, y) < 0) { continue; }
+            if (0 <= home && flood.componentOf(x, y) != home) { continue; }  //Without pacman anywhere will do
+            if (flood.isSet(near, x, y)) { close.push_back({ x, y }); }
+            else                         { far.push_back({ x, y }); }
         }
-        noDouble = true;
-        if (1 < ghostCount) {
-            for (int n = 0; n < ghostCount; n++) {
-                for (int m = (n + 1); m < (ghostCount); m++) {
-                    if (formerPositions[n] == formerPositions[m]) {
-                        noDouble = false;
-                        formerPositions.clear();
-                    }
-                }
-            }
+    }
+
+    //Partial shuffle, every tile is drawn at most once
+    auto draw = [&](std::vector<std::pair<int, int>>& pool) {
+        for (size_t i = 0; i < pool.size() && int(spawns.size()) < ghostCount; i++) {
+            std::swap(pool[i], pool[i + rand() % (pool.size() - i)]);
+            spawns.push_back(pool[i]);
         }
-    } while (!noDouble);
-    return formerPositions;
+    };
+    draw(far);
+    draw(close);
+    for (size_t i = 0; !spawns.empty() && int(spawns.size()) < ghostCount; i++) { spawns.push_back(spawns[i]); }
+    return spawns;
 };
 
 /**
@@ -336,8 +369,11 @@ std::vector<int> Map::spawnGhost(const int ghostCount) {
 void Map::drawMap() {
     auto mapTextureLocation = glGetUniformLocation(mapShaderProgram, "u_mapTexture");
     glUseProgram(mapShaderProgram);
-    glUniform1i(mapTextureLocation, 2);
+    RenderStats::countProgramBind();
+    glUniform1i(mapTextureLocation, TextureArray::textureUnit);
     mCamHolder->applycamera(mapShaderProgram, XYshift.first, XYshift.second);
     glBindVertexArray(mapVAO);
-    glDrawElements(GL_TRIANGLES, mapF.size(), GL_UNSIGNED_INT, (const void*)0);
+    RenderStats::countVertexArrayBind();
+    glDrawElements(GL_TRIANGLES, mapIndexCount, GL_UNSIGNED_INT, (const void*)0);
+    RenderStats::countDraw(mapIndexCount);
 }
\ No newline at end of file
@@ -10,16 +10,19 @@
 
 #include "include.h"
 #include "camera.h"
+
+class FloodFill;
  /**
   *  Map
   */
 class Map {
 private:
     std::vector<std::vector<int>> mapI;     //Holds the level0 map in Pacman[0]
-    std::vector<float> mapF;                //Holds the level0 map coordinates in Pacman[0]
+    std::vector<float> mapF;                //Holds the level0 map coordinates in Pacman[0], X Y Z T1 T2 Layer
+    int    wallTexture = 0;                 //Texture array layer of the walls
     GLuint mapShaderProgram;
     GLuint mapVAO;
-    GLuint mapSpriteSheet;
+    int    mapIndexCount = 0;
     std::pair<int, int> pacSpawn = {0,0};
     std::pair<float, float> XYshift{0,0};
     int pelletAmount = 0,
@@ -28,22 +31,22 @@ private:
     Camera* mCamHolder;
 public:
     Map() {};
-    Map(std::string filePath);
+    static const int vertexStride = 6;
+
+    Map(std::string filePath, Camera* camera, int wallLayer = 0);
     void   mapFloatCreate();
     void   handleMapTexCoords(int rep);
     int    findWhatWalls(const int x, const int y);
     int    howManyWalls(int num);
-    std::vector<int> loopOrder(int num);
+    int    loopOrder(int num, int* loopy);
     void   compileMapShader();
     void   callCreateMapVao();
     GLuint CreateMap(float size);
-    void   loadMapSpriteSheet();
     void   cleanMap();
-    std::vector<int> spawnGhost(const int ghostCount);
+    std::vector<std::pair<int, int>> spawnGhost(const int ghostCount, FloodFill& flood, const int minDistance);
     //Getters
     GLuint getMapShader()   { return mapShaderProgram; };
     GLuint getMapVAO()      { return mapVAO; };
-    GLuint getMapSprite()   { return mapSpriteSheet; };
     int    getMapSize()     { return mapF.size(); };
     int    getMapVal(int x, int y) { return mapI[y][x]; };
     void   setPelletAmount(int size) { pelletAmount = size; }
@@ -0,0 +1,183 @@
+/**
+ *   MotionBatch, time based segments for many characters with SIMD sampling
+ *
+ *   The sampling kernel is in motionKernel.cpp.
+ *
+ *   @file     motionBatch.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "motionBatch.h"
+#include "jobSystem.h"
+#include "motionKernel.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+typedef std::greater<std::pair<float, int>> LatestFirst;  //Earliest pops first from the back of due and the front of late, ties by slot
+
+/**
+ *  Returns the first wheel tick at or after a time, the tick where that segment end is due
+ */
+uint32_t MotionBatch::eventTick(float time) {
+    double tick = std::ceil(double(time) * ticksPerSecond);
+    return (tick <= 0.0) ? 0 : uint32_t(tick);
+}
+
+/**
+ *  Adds a character on its first segment
+ *
+ *  @param start        - segment start XY
+ *  @param stop         - segment stop XY
+ *  @param segmentStart - time the segment started, may be in the past
+ *  @param duration     - seconds from start to stop
+ *
+ *  @return returns the slot of the character
+ */
+int MotionBatch::add(const float start[2], const float stop[2], float segmentStart, float duration) {
+    int slot = size();
+    startX.push_back(0.0f); startY.push_back(0.0f);
+    stopX.push_back(0.0f);  stopY.push_back(0.0f);
+    startTime.push_back(0.0f);
+    invDuration.push_back(0.0f);
+    eventTime.push_back(0.0f);
+    posX.push_back(start[0]); posY.push_back(start[1]);
+    wheel.resize(size());
+    expired.reserve(startX.size());         //Every slot can be due at once, nextEvent() never allocates
+    due.reserve(startX.size());
+    late.reserve(startX.size());
+    setSegment(slot, start, stop, segmentStart, duration);
+    return slot;
+}
+
+/**
+ *  Removes every character
+ */
+void MotionBatch::clear() {
+    startX.clear(); startY.clear();
+    stopX.clear();  stopY.clear();
+    startTime.clear();
+    invDuration.clear();
+    eventTime.clear();
+    posX.clear();   posY.clear();
+    wheel.resize(0);
+    wheel.clear();
+    due.clear();
+    late.clear();
+    dueUntil = 0;
+    started  = false;
+}
+
+/**
+ *  Starts a new segment and schedules its end. A segment with start == stop
+ *  keeps the character in place for the duration.
+ *
+ *  @param slot         - slot from add()
+ *  @param start        - segment start XY
+ *  @param stop         - segment stop XY
+ *  @param segmentStart - time the segment starts
+ *  @param duration     - seconds from start to stop, more than 0
+ */
+void MotionBatch::setSegment(int slot, const float start[2], const float stop[2], float segmentStart, float duration) {
+    startX[slot] = start[0]; startY[slot] = start[1];
+    stopX[slot]  = stop[0];  stopY[slot]  = stop[1];
+    startTime[slot]   = segmentStart;
+    invDuration[slot] = 1.0f / duration;
+    eventTime[slot]   = segmentStart + duration;
+
+    //Ends in ticks already taken from the wheel are due right away
+    uint32_t tick = eventTick(eventTime[slot]);
+    if (started && tick <= dueUntil) {
+        wheel.cancel(slot);
+        late.push_back({ eventTime[slot], slot });
+        std::push_heap(late.begin(), late.end(), LatestFirst());
+    }
+    else {
+        wheel.schedule(slot, tick);
+    }
+}
+
+/**
+ *  Takes the earliest segment end that is due. The owner may take several
+ *  ends before calling setSegment() for them, as GhostCrowd does with a
+ *  round: handed out ends only get later, and an end that a setSegment()
+ *  replaced is skipped when it comes up.
+ *
+ *  Ends are due once now has reached the wheel tick after them, so which
+ *  events a call returns depends only on the times, not the tick length.
+ *
+ *  @param now  - current time
+ *  @param slot - receives the slot
+ *  @param time - receives the exact time the segment ended
+ *
+ *  @return returns false when no segment ends at or before now
+ */
+bool MotionBatch::nextEvent(float now, int& slot, float& time) {
+    double nowTick = std::floor(double(now) * ticksPerSecond);
+    if (0.0 <= nowTick && (!started || dueUntil < uint32_t(nowTick))) {
+        started  = true;
+        dueUntil = uint32_t(nowTick);
+        expired.clear();
+        wheel.advance(dueUntil, expired);
+        for (int id : expired) { due.push_back({ eventTime[id], id }); }
+        std::sort(due.begin(), due.end(), LatestFirst());
+    }
+    while (!due.empty() || !late.empty()) {
+        std::pair<float, int> event;
+        if (!late.empty() && (due.empty() || late.front() < due.back())) {
+            event = late.front();
+            std::pop_heap(late.begin(), late.end(), LatestFirst());
+            late.pop_back();
+        }
+        else {
+            event = due.back();
+            due.pop_back();
+        }
+        if (eventTime[event.second] != event.first) { continue; }  //Replaced by a later setSegment()
+        slot = event.second;
+        time = event.first;
+        return true;
+    }
+    return false;
+}
+
+/**
+ *  Evaluates every position at a point in time, segments are clamped at both ends
+ *
+ *  @param time - time to sample
+ *  @param jobs - workers to spread the slots over, nullptr runs them on the caller
+ */
+void MotionBatch::interpolate(float time, JobSystem* jobs) {
+    sampleTime = time;
+    if (jobs) { jobs->parallelFor(size(), interpolateChunk, [&](int first, int last) { interpolateRange(time, first, last); }); }
+    else { interpolateRange(time, 0, size()); }
+}
+
+/**
+ *  Evaluates the positions of slots [first, last)
+ */
+void MotionBatch::interpolateRange(float time, int first, int last) {
+    MotionArrays arrays = { startX.data(), startY.data(), stopX.data(), stopY.data(),
+                            startTime.data(), invDuration.data(), posX.data(), posY.data() };
+    motionInterpolate(arrays, time, first, last);
+}
+
+/**
+ *  Returns how far along its segment a character was at the last interpolate()
+ *
+ *  @param slot - slot from add()
+ *
+ *  @return returns 0 at the start and 1 at the stop
+ */
+float MotionBatch::getProgress(int slot) {
+    float p = (sampleTime - startTime[slot]) * invDuration[slot];
+    p = (p > 0.0f) ? p : 0.0f;
+    return (p < 1.0f) ? p : 1.0f;
+}
+
+/**
+ *  Returns which kernel the build uses, for benchmark reports
+ */
+const char* MotionBatch::kernelName() {
+    return motionKernelName();
+}
@@ -0,0 +1,73 @@
+/**
+ *   Header for the MotionBatch class.
+ *
+ *   Tile to tile movement of many characters at once. Each character moves
+ *   along a segment, from a start to a stop coordinate beginning at a given
+ *   time and taking a given duration, so its position is a function of time
+ *   and interpolate() can evaluate all of them at any moment with AVX, SSE2
+ *   or plain loops, whatever the build targets. The only per character work
+ *   is at the end of a segment: nextEvent() hands out characters in the
+ *   order their segments end and the owner sets the next one. Segment ends
+ *   wait in a TimingWheel with millisecond ticks, so a tick only touches
+ *   the characters whose segment ended.
+ *
+ *   With a JobSystem, interpolate() evaluates slots in chunks on its
+ *   workers, each slot is written by one chunk only.
+ *
+ *   Times are float seconds since the level started. A float steps by at most
+ *   0.25 ms up to 68 minutes, by 0.5 ms up to 2.3 hours and by 1 ms up to
+ *   4.6 hours, segment ends round to that step.
+ *
+ *   @file     motionBatch.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __MOTIONBATCH_H
+#define __MOTIONBATCH_H
+
+#include "timingWheel.h"
+#include <utility>
+#include <vector>
+
+class JobSystem;
+
+ // -----------------------------------------------------------------------------
+ // MotionBatch Class header
+ // -----------------------------------------------------------------------------
+class MotionBatch {
+private:
+    std::vector<float>  startX, startY,     //Segment start coords
+                        stopX,  stopY,      //Segment stop coords
+                        startTime,          //When the segment started
+                        invDuration,        //1 / seconds from start to stop
+                        eventTime,          //When the segment ends and the owner picks the next
+                        posX,   posY;       //Position at sampleTime
+    TimingWheel         wheel;              //Pending segment ends, by eventTick()
+    std::vector<int>    expired;            //Scratch for TimingWheel::advance
+    std::vector<std::pair<float, int>> due, //Ends taken from the wheel, latest first
+                        late;               //Min heap of ends set after their tick was taken
+    uint32_t            dueUntil = 0;       //Last wheel tick moved into due
+    bool                started = false;
+    float               sampleTime = 0.0f;
+
+    static uint32_t eventTick(float time);
+    void    interpolateRange(float time, int first, int last);
+
+public:
+    static const int ticksPerSecond = 1000;
+    static const int interpolateChunk = 8192;   //Slots in one JobSystem job, a multiple of 8
+
+    int     add(const float start[2], const float stop[2], float segmentStart, float duration);
+    void    clear();
+    void    setSegment(int slot, const float start[2], const float stop[2], float segmentStart, float duration);
+    bool    nextEvent(float now, int& slot, float& time);
+    void    interpolate(float time, JobSystem* jobs = nullptr);
+    float   getProgress(int slot);
+
+    int     size()              { return int(startX.size()); };
+    float   getX(int slot)      { return posX[slot]; };
+    float   getY(int slot)      { return posY[slot]; };
+    static const char* kernelName();
+};
+
+#endif
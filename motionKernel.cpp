@@ -0,0 +1,80 @@
+/**
+ *   MotionBatch sampling kernel, SIMD with a scalar loop for the tail
+ *
+ *   The scalar loop also handles the tail, so the SIMD and scalar paths give
+ *   bit identical results. Keep library headers out of this file, see
+ *   motionKernel.h.
+ *
+ *   @file     motionKernel.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "motionKernel.h"
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define MOTION_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define MOTION_SSE2 1
+#endif
+
+/**
+ *  Evaluates the positions of slots [first, last), segments are clamped at both ends
+ *
+ *  @param arrays - segment arrays to read and positions to write
+ *  @param time   - time to sample
+ *  @param first  - first slot
+ *  @param last   - one past the last slot
+ */
+void motionInterpolate(const MotionArrays& arrays, float time, int first, int last) {
+    const float *startX    = arrays.startX,    *startY      = arrays.startY,
+                *stopX     = arrays.stopX,     *stopY       = arrays.stopY,
+                *startTime = arrays.startTime, *invDuration = arrays.invDuration;
+    float       *posX      = arrays.posX,      *posY        = arrays.posY;
+    int count = last,
+        slot  = first;
+#if MOTION_AVX
+    const __m256 zero = _mm256_setzero_ps(),
+                 one  = _mm256_set1_ps(1.0f),
+                 now  = _mm256_set1_ps(time);
+    for (; slot + 8 <= count; slot += 8) {
+        __m256 p    = _mm256_mul_ps(_mm256_sub_ps(now, _mm256_loadu_ps(&startTime[slot])), _mm256_loadu_ps(&invDuration[slot]));
+        p           = _mm256_min_ps(_mm256_max_ps(p, zero), one);
+        __m256 rest = _mm256_sub_ps(one, p);
+        _mm256_storeu_ps(&posX[slot], _mm256_add_ps(_mm256_mul_ps(rest, _mm256_loadu_ps(&startX[slot])), _mm256_mul_ps(p, _mm256_loadu_ps(&stopX[slot]))));
+        _mm256_storeu_ps(&posY[slot], _mm256_add_ps(_mm256_mul_ps(rest, _mm256_loadu_ps(&startY[slot])), _mm256_mul_ps(p, _mm256_loadu_ps(&stopY[slot]))));
+    }
+#elif MOTION_SSE2
+    const __m128 zero = _mm_setzero_ps(),
+                 one  = _mm_set1_ps(1.0f),
+                 now  = _mm_set1_ps(time);
+    for (; slot + 4 <= count; slot += 4) {
+        __m128 p    = _mm_mul_ps(_mm_sub_ps(now, _mm_loadu_ps(&startTime[slot])), _mm_loadu_ps(&invDuration[slot]));
+        p           = _mm_min_ps(_mm_max_ps(p, zero), one);
+        __m128 rest = _mm_sub_ps(one, p);
+        _mm_storeu_ps(&posX[slot], _mm_add_ps(_mm_mul_ps(rest, _mm_loadu_ps(&startX[slot])), _mm_mul_ps(p, _mm_loadu_ps(&stopX[slot]))));
+        _mm_storeu_ps(&posY[slot], _mm_add_ps(_mm_mul_ps(rest, _mm_loadu_ps(&startY[slot])), _mm_mul_ps(p, _mm_loadu_ps(&stopY[slot]))));
+    }
+#endif
+    for (; slot < count; slot++) {
+        float p = (time - startTime[slot]) * invDuration[slot];
+        p = (p > 0.0f) ? p : 0.0f;
+        p = (p < 1.0f) ? p : 1.0f;
+        posX[slot] = ((1 - p) * startX[slot]) + (p * stopX[slot]);
+        posY[slot] = ((1 - p) * startY[slot]) + (p * stopY[slot]);
+    }
+}
+
+/**
+ *  Returns which kernel the build uses, for benchmark reports
+ */
+const char* motionKernelName() {
+#if MOTION_AVX
+    return "AVX";
+#elif MOTION_SSE2
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
@@ -0,0 +1,35 @@
+/**
+ *   Header for the MotionBatch sampling kernel.
+ *
+ *   The kernel lives in its own file so a build can compile it alone for
+ *   another instruction set (PACMAN_AVX). It only uses intrinsics and plain
+ *   loops over the arrays it is given, no library headers, so the file holds
+ *   no inline or template code the linker could pick over the plain copy
+ *   other files use.
+ *
+ *   @file     motionKernel.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __MOTIONKERNEL_H
+#define __MOTIONKERNEL_H
+
+/**
+ *  Segment arrays of a MotionBatch, one float per slot
+ */
+struct MotionArrays {
+    const float *startX, *startY,
+                *stopX,  *stopY,
+                *startTime,
+                *invDuration;
+    float       *posX,   *posY;     //Written by the kernel
+};
+
+// -----------------------------------------------------------------------------
+// FUNCTION PROTOTYPES
+// -----------------------------------------------------------------------------
+
+void        motionInterpolate(const MotionArrays& arrays, float time, int first, int last);
+const char* motionKernelName();
+
+#endif
@@ -0,0 +1,139 @@
+/**
+ *   NavGraph, junction graph and legal move masks of a level
+ *
+ *   @file     navGraph.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "navGraph.h"
+#include "map.h"
+#include <cstdio>
+
+static const int directions[4] = { 2, 4, 3, 9 };   //By direction index
+
+/**
+ *  Returns the mask bit of a direction, 0 for anything that is not a direction
+ */
+int NavGraph::bitOf(int dir) {
+    switch (dir) {
+    case 2: return upBit;
+    case 4: return downBit;
+    case 3: return leftBit;
+    case 9: return rightBit;
+    }
+    return 0;
+}
+
+/**
+ *  Returns the direction of the lowest bit set in a mask, 0 for an empty mask
+ */
+int NavGraph::dirOf(int bit) {
+    if (bit & upBit)    { return 2; }
+    if (bit & downBit)  { return 4; }
+    if (bit & leftBit)  { return 3; }
+    if (bit & rightBit) { return 9; }
+    return 0;
+}
+
+/**
+ *  Returns the opposite direction, 0 for anything that is not a direction
+ */
+int NavGraph::reverseOf(int dir) {
+    switch (dir) {
+    case 2: return 4;
+    case 4: return 2;
+    case 3: return 9;
+    case 9: return 3;
+    }
+    return 0;
+}
+
+/**
+ *  Returns 0 - 3 for up, down, left and right, the order edges are stored in
+ */
+int NavGraph::indexOf(int dir) {
+    switch (dir) {
+    case 2: return 0;
+    case 4: return 1;
+    case 3: return 2;
+    }
+    return 3;
+}
+
+/**
+ *  Builds masks, nodes and edges for a map
+ *
+ *  @param map - loaded map, walls are 1
+ *
+ *  @see Character::getLegalDir(int dir)
+ */
+void NavGraph::build(Map& map) {
+    std::pair<int, int> size = map.getWidthHeight();
+    width  = size.first;
+    height = size.second;
+    masks.assign(size_t(width) * height, 0);
+    tileNode.assign(size_t(width) * height, -1);
+    nodeTile.clear();
+
+    //Same rules as getLegalDir: the top row and everything outside the map are off limits.
+    //Nobody stands in a wall, so walls get no moves and a mask of 0 means not walkable
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (map.getMapVal(x, y) == 1) { continue; }
+            int mask = 0;
+            for (int d = 0; d < 4; d++) {
+                int nx = x + ((directions[d] == 9) ? 1 : (directions[d] == 3) ? -1 : 0),
+                    ny = y + ((directions[d] == 2) ? 1 : (directions[d] == 4) ? -1 : 0);
+                if (0 <= nx && 0 <= ny && nx < width && ny < height - 1 && map.getMapVal(nx, ny) != 1) {
+                    mask |= bitOf(directions[d]);
+                }
+            }
+            masks[y * width + x] = uint8_t(mask);
+        }
+    }
+
+    //Anything walkable but a straight corridor piece is a node
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            int mask = masks[y * width + x];
+            if (map.getMapVal(x, y) == 1) { continue; }
+            if (mask == (upBit | downBit) || mask == (leftBit | rightBit)) { continue; }
+            tileNode[y * width + x] = int(nodeTile.size());
+            nodeTile.push_back(y * width + x);
+        }
+    }
+
+    //Walk every exit straight on until the next node
+    edgeTarget.assign(nodeTile.size() * 4, -1);
+    edgeLength.assign(nodeTile.size() * 4, 0);
+    edgeCount = 0;
+    for (int node = 0; node < getNodeCount(); node++) {
+        for (int d = 0; d < 4; d++) {
+            int x = nodeTile[node] % width,
+                y = nodeTile[node] / width,
+                length = 0;
+            int bit = bitOf(directions[d]);
+            if (!(masks[y * width + x] & bit)) { continue; }
+            do {
+                x += (directions[d] == 9) ? 1 : (directions[d] == 3) ? -1 : 0;
+                y += (directions[d] == 2) ? 1 : (directions[d] == 4) ? -1 : 0;
+                length++;
+            } while (tileNode[y * width + x] < 0 && (masks[y * width + x] & bit));
+            edgeLength[node * 4 + d] = length;
+            edgeTarget[node * 4 + d] = tileNode[y * width + x];
+            if (0 <= tileNode[y * width + x]) { edgeCount++; }
+        }
+    }
+}
+
+/**
+ *  Prints the size of the graph
+ */
+void NavGraph::report() {
+    int junctions = 0;
+    for (int tile : nodeTile) { junctions += (3 <= exitCount(masks[tile])); }
+    size_t bytes = masks.size() * sizeof(uint8_t)
+                 + (tileNode.size() + nodeTile.size() + edgeTarget.size() + edgeLength.size()) * sizeof(int);
+    printf("Nav graph: %d nodes (%d junctions), %d edges, %.1f KB\n",
+        getNodeCount(), junctions, edgeCount, bytes / 1024.0);
+}
@@ -0,0 +1,76 @@
+/**
+ *   Header for the NavGraph class.
+ *
+ *   Navigation layer precomputed from the tile map when a level loads.
+ *   Every tile gets a 4 bit mask of the moves Character::getLegalDir allows
+ *   from it, walls get none. Walkable tiles that are not a straight piece of
+ *   corridor, that is junctions, corners and dead ends, become nodes, and
+ *   each node knows which node it reaches in every direction and how many
+ *   tiles away. Edges are therefore straight runs, a character leaving a
+ *   node only has to think again at the other end.
+ *
+ *   Directions are the game's own (2 up, 4 down, 3 left, 9 right), masks
+ *   use bitOf() for them.
+ *
+ *   @file     navGraph.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __NAVGRAPH_H
+#define __NAVGRAPH_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+class Map;
+
+ // -----------------------------------------------------------------------------
+ // NavGraph Class header
+ // -----------------------------------------------------------------------------
+class NavGraph {
+public:
+    static const int upBit    = 1,
+                     downBit  = 2,
+                     leftBit  = 4,
+                     rightBit = 8;
+
+private:
+    int width  = 0,
+        height = 0;
+    std::vector<uint8_t> masks;         //Legal moves per tile, y * width + x
+    std::vector<int>     tileNode,      //Node of a tile, -1 for corridor tiles and walls
+                         nodeTile,      //Tile of a node
+                         edgeTarget,    //Node reached from node * 4 + direction index, -1 if none
+                         edgeLength;    //Tiles walked along that edge
+    int edgeCount = 0;
+
+public:
+    void    build(Map& map);
+    void    report();
+
+    static int  bitOf(int dir);
+    static int  dirOf(int bit);
+    static int  reverseOf(int dir);
+    static int  indexOf(int dir);
+    static int  exitCount(int mask)     { return ((mask >> 0) & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1); };
+
+    int     legalMask(int x, int y) {
+        if (x < 0 || y < 0 || width <= x || height <= y) { return 0; }
+        return masks[y * width + x];
+    };
+    bool    canMove(int x, int y, int dir)  { return (legalMask(x, y) & bitOf(dir)) != 0; };
+    bool    isJunction(int x, int y)        { return 3 <= exitCount(legalMask(x, y)); };
+    int     nodeAt(int x, int y) {
+        if (x < 0 || y < 0 || width <= x || height <= y) { return -1; }
+        return tileNode[y * width + x];
+    };
+    int     getEdgeTarget(int node, int dir)    { return edgeTarget[node * 4 + indexOf(dir)]; };
+    int     getEdgeLength(int node, int dir)    { return edgeLength[node * 4 + indexOf(dir)]; };
+    std::pair<int, int> getNodeXY(int node)     { return { nodeTile[node] % width, nodeTile[node] / width }; };
+    int     getNodeCount()                      { return int(nodeTile.size()); };
+    int     getEdgeCount()                      { return edgeCount; };
+    std::pair<int, int> getWidthHeight()        { return { width, height }; };
+};
+
+#endif
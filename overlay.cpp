@@ -0,0 +1,96 @@
+/**
+ *   Overlay, screen space bars drawn after the scene
+ *
+ *   @file     overlay.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "overlay.h"
+#include "globFunc.h"
+#include "renderStats.h"
+#include <algorithm>
+
+/**
+ *  Compiles the overlay shader and allocates room for maxBars bars
+ */
+void Overlay::compileOverlay() {
+    overlayShaderProgram = CompileShader(overlayVertexShaderSrc, overlayFragmentShaderSrc);
+    vertices.reserve(maxBars * 2 * 6 * vertexStride);
+
+    glGenVertexArrays(1, &overlayVAO);
+    glBindVertexArray(overlayVAO);
+    glGenBuffers(1, &overlayVBO);
+    glBindBuffer(GL_ARRAY_BUFFER, overlayVBO);
+    glBufferData(GL_ARRAY_BUFFER, vertices.capacity() * sizeof(GLfloat), nullptr, GL_DYNAMIC_DRAW);
+
+    GLint posAttrib = glGetAttribLocation(overlayShaderProgram, "oPosition");
+    glEnableVertexAttribArray(posAttrib);
+    glVertexAttribPointer(posAttrib, 2, GL_FLOAT, GL_FALSE, vertexStride * sizeof(GLfloat), 0);
+
+    GLint colorAttrib = glGetAttribLocation(overlayShaderProgram, "oColor");
+    glEnableVertexAttribArray(colorAttrib);
+    glVertexAttribPointer(colorAttrib, 3, GL_FLOAT, GL_FALSE, vertexStride * sizeof(GLfloat), (const void*)(2 * sizeof(GLfloat)));
+
+    glBindVertexArray(0);
+}
+
+/**
+ *  Appends two triangles covering a rectangle
+ */
+void Overlay::pushQuad(float x0, float y0, float x1, float y1, const glm::vec3& color) {
+    const float corners[6][2] = { {x0, y0}, {x1, y0}, {x1, y1}, {x0, y0}, {x1, y1}, {x0, y1} };
+    for (auto& corner : corners) {
+        vertices.push_back(corner[0]);
+        vertices.push_back(corner[1]);
+        vertices.push_back(color.r);
+        vertices.push_back(color.g);
+        vertices.push_back(color.b);
+    }
+}
+
+/**
+ *  Adds a bar below the previous one, bars past maxBars are ignored
+ *
+ *  @param value    - length of the filled part
+ *  @param maxValue - value that fills the whole bar, longer values are clamped
+ *  @param color    - color of the filled part
+ */
+void Overlay::addBar(float value, float maxValue, const glm::vec3& color) {
+    if (barCount == maxBars) { return; }
+    const float left = -0.98f, width = 0.6f, height = 0.03f, gap = 0.01f;
+    float top  = 0.98f - barCount * (height + gap),
+          fill = (maxValue > 0.0f) ? std::min(value / maxValue, 1.0f) : 0.0f;
+
+    pushQuad(left, top - height, left + width, top, glm::vec3(0.15f));
+    pushQuad(left, top - height, left + width * fill, top, color);
+    barCount++;
+}
+
+/**
+ *  Draws the bars added since clearBars on top of everything
+ */
+void Overlay::drawOverlay() {
+    if (vertices.empty()) { return; }
+    glDisable(GL_DEPTH_TEST);
+    glUseProgram(overlayShaderProgram);
+    RenderStats::countProgramBind();
+    glBindVertexArray(overlayVAO);
+    RenderStats::countVertexArrayBind();
+    glBindBuffer(GL_ARRAY_BUFFER, overlayVBO);
+    glBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size() * sizeof(GLfloat), vertices.data());
+    RenderStats::countUpload(vertices.size() * sizeof(GLfloat));
+    glDrawArrays(GL_TRIANGLES, 0, GLsizei(vertices.size() / vertexStride));
+    RenderStats::countDraw(GLsizei(vertices.size() / vertexStride));
+    glBindVertexArray(0);
+    RenderStats::countVertexArrayBind();
+    glEnable(GL_DEPTH_TEST);
+}
+
+/**
+ *  Deletes the overlay shader and buffers
+ */
+void Overlay::cleanOverlay() {
+    glDeleteProgram(overlayShaderProgram);
+    glDeleteBuffers(1, &overlayVBO);
+    glDeleteVertexArrays(1, &overlayVAO);
+}
@@ -0,0 +1,40 @@
+/**
+ *   Header for the Overlay class.
+ *
+ *   Draws flat colored bars in the top left corner of the screen on top of
+ *   the scene, used for showing timings while the game runs.
+ *
+ *   @file     overlay.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __OVERLAY_H
+#define __OVERLAY_H
+
+#include "include.h"
+
+ // -----------------------------------------------------------------------------
+ // Overlay Class header
+ // -----------------------------------------------------------------------------
+class Overlay {
+public:
+    static const int maxBars      = 16;
+    static const int vertexStride = 5;      //X Y R G B
+
+private:
+    std::vector<GLfloat> vertices;          //Rebuilt every frame, capacity reserved once
+    GLuint  overlayShaderProgram = 0,
+            overlayVAO = 0,
+            overlayVBO = 0;
+    int     barCount = 0;
+
+    void    pushQuad(float x0, float y0, float x1, float y1, const glm::vec3& color);
+public:
+    void    compileOverlay();
+    void    clearBars()     { vertices.clear(); barCount = 0; };
+    void    addBar(float value, float maxValue, const glm::vec3& color);
+    void    drawOverlay();
+    void    cleanOverlay();
+};
+
+#endif
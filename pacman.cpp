@@ -125,22 +125,6 @@ int  Pacman::getCard() {
     return cardDir;
 }
 
-/**
- *  loads Pacman spritesheet, not used due to first person
- *
- *  @see GLuint load_opengl_texture(const std::string& filepath, GLuint slot)
- */
-void Pacman::loadPacSpriteSheet() {
-    pacSpriteSheet = load_opengl_texture("assets/pacman.png", 0);
-}
-
-/**
- *  Deletes sprite sheet
- */
-void Pacman::deletePacSpriteSheet() {
-    glDeleteTextures(1, &pacSpriteSheet);
-}
-
 /**
  *   updates wheter pellets are to be updated
  */
@@ -226,11 +210,12 @@ void Pacman::moveCamera(float x, float y) {
 }
 
 /**
- *  Checks camera for wheter or not a key has been pressed
+ *  Applies the first legal key press waiting in the camera input queue,
+ *  illegal presses before it are dropped and later ones wait for the next tick
  *
  *  @see setCard(int card)
  *  @see Camera::getCard()
- *  @see Camera::getNewDesDir()
+ *  @see InputQueue::peek(InputEvent& out)
  *  @see Character::getLegalDir(int dir)
  *  @see Pacman::updateDir(int outDir)
  *  @see Pacman::changeDir()
@@ -238,11 +223,15 @@ void Pacman::moveCamera(float x, float y) {
 void Pacman::checkForKeyUpdate() {
     setCard(CamHolder->getCard());
 
-    int newPotDir = CamHolder->getNewDesDir();
-    if (newPotDir != -10){
-        if (getLegalDir(newPotDir)) {
-            updateDir(newPotDir);
+    InputQueue& input = CamHolder->getDesDirQueue();
+    InputEvent event;
+    while (input.peek(event)) {
+        input.pop();
+        if (getLegalDir(event.dir)) {
+            updateDir(event.dir);
             changeDir();
+            input.markApplied(event);
+            break;
         };
     }
 }
\ No newline at end of file
@@ -19,7 +19,6 @@ private:
         collected   = 0,
         animDelay   = 10,
         animVal     = 0;                //A number between 0 - 3 used to define
-    GLuint pacSpriteSheet;
     bool updatePellet = false,
          run = true;
 public:
@@ -35,8 +34,6 @@ public:
     void updateCard(int newDir);
     int  getCard();
     void setCard(int card) { cardDir = card; };
-    void loadPacSpriteSheet();
-    void deletePacSpriteSheet();
     bool updatePelletState(bool change);
     void pickupPellet() { collected++; };
     int  getPellets()   { return collected; };
@@ -1,167 +1,152 @@
 // -----------------------------------------------------------------------------
-// Pellet Class
+// PelletPool Class
 // -----------------------------------------------------------------------------
 
 #include "pellet.h"
 #include "globFunc.h"
+#include "renderStats.h"
 
 /**
- *  Initializes pellet with x and y
+ *  Empties the pool and sizes the tile table for a map
  *
- *  @param    x - pellets designated x
- *  @param    y - pellets designated y
- *  @see      Pellet::initCoords();
+ *  @param widthHeight - width and height of the map in tiles
+ *  @param shift       - size of one tile
+ *  @param camera      - camera used for coordinates and drawing
  */
-Pellet::Pellet(int x, int y, std::pair<float, float> shift) {
-    XYshift = shift;
-    XYpos[0] = x; XYpos[1] = y;
-    initCoords();
-};
+void PelletPool::init(std::pair<int, int> widthHeight, std::pair<float, float> shift, Camera* camera) {
+    WidthHeight = widthHeight;
+    XYshift     = shift;
+    pCamHolder  = camera;
+    posZ        = shift.second / 2.0f;
+    posX.clear();
+    posY.clear();
+    tile.clear();
+    present.clear();
+    tileToPellet.assign(size_t(widthHeight.first) * widthHeight.second, -1);
+    remaining = drawCount = 0;
+}
 
 /**
- *  Initializes pellet vertices
+ *  Adds a pellet in the middle of a tile
+ *
+ *  @param x - tile x
+ *  @param y - tile y
  *
  *  @see   GLfloat getCoordsWithInt(int y,   int x,   int type);
+ *
+ *  @return returns the index of the new pellet
  */
-void Pellet::initCoords() {
-    int loop = 0;
-    float Xquart = XYshift.first  / 2.0f;
-    float Yquart = XYshift.second / 2.0f;
-    for (int x = 0; x < 3; x++) {
-        vertices[loop] = (pCamHolder->getCoordsWithInt(XYpos[1], XYpos[0], loop, 0.0f, XYshift));
-        switch (loop) {
-        case 0:  vertices[loop] += Xquart; break;
-        case 1:  vertices[loop] += Yquart; break;
-        default: vertices[loop] =  Yquart; break;
-        }
-        loop++;
-    }
+int PelletPool::add(int x, int y) {
+    int index = size();
+    posX.push_back(pCamHolder->getCoordsWithInt(y, x, 0, 0.0f, XYshift) + XYshift.first  / 2.0f);
+    posY.push_back(pCamHolder->getCoordsWithInt(y, x, 1, 0.0f, XYshift) + XYshift.second / 2.0f);
+    tile.push_back(y * WidthHeight.first + x);
+    if ((index & 63) == 0) { present.push_back(0); }
+    present[index >> 6] |= uint64_t(1) << (index & 63);
+    tileToPellet[tile.back()] = index;
+    remaining++;
+    return index;
 }
 
 /**
- *  sets Pellet vertices to 0, effectively removing it
+ *  Removes a pellet, it stays in the pool but is no longer drawn or collided with
+ *
+ *  @param index - pellet index
+ *
+ *  @return returns true if the pellet was still there
  */
-bool Pellet::removePellet() {
-    if (enabled) {
-        for (auto& it : vertices) {
-            it = 0.0f;
-        }
-        enabled = false;
-        return true;
-    }
-    return false;
+bool PelletPool::remove(int index) {
+    uint64_t bit = uint64_t(1) << (index & 63);
+    if (!(present[index >> 6] & bit)) { return false; }
+    present[index >> 6] &= ~bit;
+    remaining--;
+    return true;
 }
 
 /**
- *  Returns desired vertex from pellet
+ *  Returns the pellet on a tile
  *
- *  @param    index - desired vertex
+ *  @param x - tile x
+ *  @param y - tile y
  *
- *  @return   pellets desired vertex
+ *  @return returns the pellet index, or -1 if the tile never had one
  */
-GLfloat Pellet::getVertCoord(int index) {
-    return vertices[index];
+int PelletPool::at(int x, int y) {
+    if (x < 0 || y < 0 || WidthHeight.first <= x || WidthHeight.second <= y) { return -1; }
+    return tileToPellet[size_t(y) * WidthHeight.first + x];
 }
 
 /**
- *  Returns XYpos if pellet is enabled
+ *  Creates the pellet VAO, its buffer is sized for count pellets and never grows
  *
- *  @param    XY - either x or y
+ *  @param object - pellet vertices from gatherVertices
+ *  @param count  - pellets in object
  *
- *  @return either pellet XY or -1 if disabled
+ *  @see CreateObject(GLfloat* object, int size, const int stride, bool noEbo)
  */
-int Pellet::checkCoords(int XY) {
-    if (enabled) return XYpos[XY];
-    return -1;
+void PelletPool::createPelletVAO(const GLfloat* object, int count) {
+    pelletVAO = CreateObject(const_cast<GLfloat*>(object), count * stride * int(sizeof(GLfloat)), stride, true);
+    GLint vbo = 0;
+    glGetVertexAttribiv(0, GL_VERTEX_ATTRIB_ARRAY_BUFFER_BINDING, &vbo);
+    pelletVBO = GLuint(vbo);
+    drawCount = count;
 }
 
 /**
- *  Returns if pellet is enabled
+ *  Overwrites the start of the pellet buffer, later draws only use count pellets
  *
- *  @return if the pellet is enabeled or not
+ *  @param object - pellet vertices from gatherVertices
+ *  @param count  - pellets in object, not more than createPelletVAO was given
  */
-bool Pellet::isEnabled() {
-    return enabled;
+void PelletPool::updatePelletVBO(const GLfloat* object, int count) {
+    int size = count * stride * int(sizeof(GLfloat));
+    if (0 < size) {
+        glBindBuffer(GL_ARRAY_BUFFER, pelletVBO);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, object);
+        RenderStats::countUpload(size);
+    }
+    drawCount = count;
 }
 
 /**
- *  CAlls compileshader with pellets shaders and sets vertecie values
+ *  Compiles the pellet shaders and points pelPosition at the bound VAO
  *
  *  @see CompileShader(const std::string& vertexShaderSrc,
                      const std::string& fragmentShaderSrc,
                      const std::string& geometryShaderSrc)
  */
-void Pellet::callCompilePelletShader() {
+void PelletPool::compilePelletShader() {
     pelletShaderProgram = CompileShader(pelletVertexShaderSrc,
             pelletFragmentShaderSrc, pelletGeometryShaderSrc);
 
     GLint pelposAttrib = glGetAttribLocation(pelletShaderProgram, "pelPosition");
     glEnableVertexAttribArray(pelposAttrib);
-    glVertexAttribPointer(pelposAttrib, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), 0); 
+    glVertexAttribPointer(pelposAttrib, 3, GL_FLOAT, GL_FALSE, stride * sizeof(GLfloat), 0);
 }
 
 /**
- *  Draws Pellets
+ *  Draws every pellet of the last upload, one point each that the geometry shader turns into a sphere
  *
  *  @see Camera::applycamera(const GLuint shader, const float width, const float height)
- * 
- *  @param shader - shaderprogram to use for drawing
- *  @param vao    - vao of object
- */ 
-void Pellet::drawPellets(const int size) {
+ */
+void PelletPool::drawPellets() {
     auto pelletVertexColorLocation = glGetUniformLocation(pelletShaderProgram, "u_Color");
     glUseProgram(pelletShaderProgram);
+    RenderStats::countProgramBind();
     pCamHolder->applycamera(pelletShaderProgram, WidthHeight.second, WidthHeight.first );
     glBindVertexArray(pelletVAO);
+    RenderStats::countVertexArrayBind();
     glUniform4f(pelletVertexColorLocation, 0.8f, 0.8f, 0.0f, 1.0f);
-    glDrawArrays(GL_POINTS, 0, int(6 * size));
+    glDrawArrays(GL_POINTS, 0, drawCount);
+    RenderStats::countDraw(drawCount);
 }
 
 /**
- *  Cleans all pellet values
+ *  Deletes the pellet shader and VAO
  *
  *  @see CleanVAO(GLuint& vao)
  */
-void Pellet::cleanPellets() {
+void PelletPool::cleanPellets() {
     glDeleteProgram(pelletShaderProgram);
     CleanVAO(pelletVAO);
 }
-
-/**
- *  Cleans pellet VAO
- *
- *  @see CleanVAO(GLuint& vao)
- */
-void Pellet::cleanPelletVAO() { 
-    CleanVAO(pelletVAO); 
-};
-
-/**
- *   Calls createObject for pellet
- *
- *  @see CreateObject(GLfloat* object, int size, const int stride, bool noEbo)
- */
-void Pellet::callCreatePelletVAO(GLfloat* object, int size, const int stride) {
-    pelletVAO = CreateObject(object, size, stride, true);
-};
-
-/**
- *  Sets pelletVAO
- */
-void Pellet::setVAO(const GLuint vao) {
-    pelletVAO = vao;
-}
-
-/**
- *  returns pelletVAO
- */
-GLuint Pellet::getVAO() {
-    return pelletVAO;
-}
-
-/**
- *  returns pelletShader
- */
-GLuint Pellet::getShader() {
-    return pelletShaderProgram;
-}
\ No newline at end of file
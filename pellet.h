@@ -1,4 +1,11 @@
 /**
+ *   Header for the PelletPool class.
+ *
+ *   All pellets of a level in structure of arrays form, addressed by index
+ *   in the order they were added. Whether a pellet is still there is one bit
+ *   in a bitset, and a per tile table maps a tile to its pellet. The GL
+ *   objects exist once for the whole pool.
+ *
  *   @file     pellet.h
  *   @author   Axel Jacobsen
  */
@@ -8,45 +15,68 @@
 
 #include "include.h"
 #include "camera.h"
+#include <cstdint>
 
-class Pellet {
+ // -----------------------------------------------------------------------------
+ // PelletPool Class header
+ // -----------------------------------------------------------------------------
+class PelletPool {
 private:
-    int     XYpos[2];                   //Pellets XY
-    const int pVerticeAmmount = 4 * 3;
-    bool    enabled = true;             //Decides whether to do collision or not
-    GLfloat vertices[4 * 3] = { 0.0f }; //Hold pellets vertices X Y Z
-    std::vector<int> test;
-    GLuint pelletShaderProgram;
-    GLuint pelletVAO;
+    std::vector<float>    posX,             //Pellet centre, z is the same for every pellet
+                          posY;
+    std::vector<int>      tile;             //y * width + x
+    std::vector<uint64_t> present;          //One bit per pellet, set until eaten
+    std::vector<int>      tileToPellet;     //Pellet index per tile, -1 for none
+    float   posZ = 0.0f;
+    int     remaining = 0,
+            drawCount = 0;                  //Pellets in the buffer since the last upload
+
+    GLuint  pelletShaderProgram = 0,
+            pelletVAO = 0,
+            pelletVBO = 0;
     std::pair<float, float> XYshift{ 0,0 };
     std::pair<int, int> WidthHeight{ 0,0 };
-    
-    Camera* pCamHolder;
+    Camera* pCamHolder = nullptr;
 
 public:
-    Pellet() {};
-    Pellet(int x, int y, std::pair<float, float> shift);
-    ~Pellet() {
-        delete vertices;
-        delete XYpos;
-    };
-    void initCoords();
-    GLfloat getVertCoord(int index);
-    bool removePellet();
-    int  checkCoords(int XY);
-    bool isEnabled();
-    void callCompilePelletShader();
-    void drawPellets(const int size);
+    static const int stride = 3;            //Floats per pellet in the buffer, X Y Z
+
+    void init(std::pair<int, int> widthHeight, std::pair<float, float> shift, Camera* camera);
+    int  add(int x, int y);
+    bool remove(int index);
+    int  at(int x, int y);
+
+    int  size()                 { return int(posX.size()); };
+    int  getRemaining()         { return remaining; };
+    bool isPresent(int index)   { return (present[index >> 6] >> (index & 63)) & 1u; };
+    std::pair<int, int> getXY(int index) { return { tile[index] % WidthHeight.first, tile[index] / WidthHeight.first }; };
+
+    template <typename Container>
+    void gatherVertices(Container& container);
+    void createPelletVAO(const GLfloat* object, int count);
+    void updatePelletVBO(const GLfloat* object, int count);
+    void compilePelletShader();
+    void drawPellets();
     void cleanPellets();
-    void cleanPelletVAO();
-    int  getVertSize() { return sizeof(vertices) / sizeof(vertices[0]); }
-    void callCreatePelletVAO(GLfloat* object, int size, const int stride);
-    void   setVAO(const GLuint vao);
-    GLuint getVAO();
-    GLuint getShader();
-    void  getPelletCameraPointer(Camera* newCamera) { pCamHolder = newCamera; };
-    void  pelletSetWidthHeight(std::pair<int, int> widthHeidht) { WidthHeight = widthHeidht; };
-    std::pair<int, int> getPelletXY() { std::pair<int, int>pelXyRet = { XYpos[0],XYpos[1] }; return pelXyRet; }
 };
 
+/**
+ *  Packs X Y Z of every pellet still present, in index order
+ *
+ *  @param container - float vector, cleared and filled with stride floats per pellet
+ */
+template <typename Container>
+void PelletPool::gatherVertices(Container& container) {
+    container.clear();
+    for (size_t word = 0; word < present.size(); word++) {
+        int index = int(word * 64);
+        for (uint64_t bits = present[word]; bits; bits >>= 1, index++) {      //Eaten runs of 64 are skipped whole
+            if (!(bits & 1u)) { continue; }
+            container.push_back(posX[index]);
+            container.push_back(posY[index]);
+            container.push_back(posZ);
+        }
+    }
+}
+
 #endif
@@ -0,0 +1,141 @@
+/**
+ *   CPU profiler, per thread event rings and Chrome trace export
+ *
+ *   @file     profiler.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "profiler.h"
+
+#if PACMAN_PROFILE
+
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+static const uint32_t eventCapacity = 1 << 16;     //Per thread, the oldest events are overwritten
+
+/**
+ *  Events of one thread, only that thread writes to it
+ */
+struct ThreadBuffer {
+    Profiler::Event       events[eventCapacity];
+    std::atomic<uint32_t> written{ 0 };             //Total events ever recorded, wraps the ring
+    int                   threadId = 0;
+    std::string           name;
+};
+
+static std::mutex                                  registryMutex;  //Only taken when a thread records its first event
+static std::vector<std::unique_ptr<ThreadBuffer>>  registry;
+static thread_local ThreadBuffer*                  localBuffer = nullptr;
+
+/**
+ *  Returns this threads buffer, registering it on first use
+ */
+static ThreadBuffer* threadBuffer() {
+    if (!localBuffer) {
+        std::unique_ptr<ThreadBuffer> buffer(new ThreadBuffer());
+        std::lock_guard<std::mutex> lock(registryMutex);
+        buffer->threadId = int(registry.size());
+        buffer->name = (buffer->threadId == 0) ? "main" : "thread " + std::to_string(buffer->threadId);
+        localBuffer = buffer.get();
+        registry.push_back(std::move(buffer));
+    }
+    return localBuffer;
+}
+
+/**
+ *  Nanoseconds since the program started, the same clock as the flight recorder
+ */
+int64_t Profiler::now() {
+    return FlightRecorder::now();
+}
+
+/**
+ *  Stores a finished zone in the calling threads ring
+ *
+ *  @param name    - zone name, must outlive the profiler (string literal)
+ *  @param startNs - start from Profiler::now()
+ *  @param stopNs  - stop from Profiler::now()
+ */
+void Profiler::record(const char* name, int64_t startNs, int64_t stopNs) {
+    ThreadBuffer* buffer = threadBuffer();
+    uint32_t index = buffer->written.load(std::memory_order_relaxed);
+    Event& event = buffer->events[index % eventCapacity];
+    event.name = name;
+    event.startNs = startNs;
+    event.durationNs = stopNs - startNs;
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+/**
+ *  Stores a counter sample, shown as a graph track in the trace
+ *
+ *  @param name  - counter name, must outlive the profiler (string literal)
+ *  @param value - sample value
+ */
+void Profiler::counter(const char* name, double value) {
+    ThreadBuffer* buffer = threadBuffer();
+    uint32_t index = buffer->written.load(std::memory_order_relaxed);
+    Event& event = buffer->events[index % eventCapacity];
+    event.name = name;
+    event.startNs = now();
+    event.durationNs = -1;
+    event.value = value;
+    buffer->written.store(index + 1, std::memory_order_release);
+}
+
+/**
+ *  Names the calling thread in the trace
+ */
+void Profiler::setThreadName(const char* name) {
+    ThreadBuffer* buffer = threadBuffer();
+    std::lock_guard<std::mutex> lock(registryMutex);
+    buffer->name = name;
+}
+
+/**
+ *  Writes every buffered event as Chrome trace JSON
+ *
+ *  @param filepath - file to write
+ *
+ *  @return returns false if the file could not be written
+ */
+bool Profiler::writeChromeTrace(const std::string& filepath) {
+    std::ofstream out(filepath);
+    if (!out) { return false; }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    char line[256];
+    for (auto& buffer : registry) {
+        snprintf(line, sizeof(line), "%s{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":%i,\"args\":{\"name\":\"%s\"}}",
+                 first ? "" : ",\n", buffer->threadId, buffer->name.c_str());
+        out << line;
+        first = false;
+
+        uint32_t written = buffer->written.load(std::memory_order_acquire),
+                 count = (written < eventCapacity) ? written : eventCapacity;
+        for (uint32_t i = written - count; i != written; i++) {
+            const Event& event = buffer->events[i % eventCapacity];
+            if (event.durationNs < 0) {
+                snprintf(line, sizeof(line), ",\n{\"ph\":\"C\",\"name\":\"%s\",\"pid\":1,\"tid\":%i,\"ts\":%.3f,\"args\":{\"value\":%.4f}}",
+                         event.name, buffer->threadId, event.startNs / 1000.0, event.value);
+                out << line;
+                continue;
+            }
+            snprintf(line, sizeof(line), ",\n{\"ph\":\"X\",\"name\":\"%s\",\"pid\":1,\"tid\":%i,\"ts\":%.3f,\"dur\":%.3f}",
+                     event.name, buffer->threadId, event.startNs / 1000.0, event.durationNs / 1000.0);
+            out << line;
+        }
+    }
+    out << "\n]}\n";
+    printf("Profiler trace written to %s\n", filepath.c_str());
+    return bool(out);
+}
+
+#endif
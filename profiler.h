@@ -0,0 +1,101 @@
+/**
+ *   Header for the CPU profiler.
+ *
+ *   Zones and counters are recorded into a fixed size ring buffer owned by each thread, so
+ *   recording never takes a lock. The buffers are written out as Chrome trace
+ *   JSON (chrome://tracing, ui.perfetto.dev) by PROFILE_DUMP.
+ *
+ *   Everything compiles away unless PACMAN_PROFILE is set to 1, see the
+ *   PACMAN_PROFILE option in CMakeLists.txt. Zones are always handed to the
+ *   FlightRecorder, which is cheap enough to stay on in every build.
+ *   PROFILE_ZONE expands to one declaration, one object times and tracks the zone.
+ *
+ *   @file     profiler.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __PROFILER_H
+#define __PROFILER_H
+
+#include "flightRecorder.h"
+#include "allocTracker.h"
+
+#ifndef PACMAN_PROFILE
+#define PACMAN_PROFILE 0
+#endif
+
+#define PROFILE_CONCAT_INNER(a, b)  a##b
+#define PROFILE_CONCAT(a, b)        PROFILE_CONCAT_INNER(a, b)
+
+#if PACMAN_PROFILE
+
+#include <cstdint>
+#include <string>
+
+ // -----------------------------------------------------------------------------
+ // Profiler Class header
+ // -----------------------------------------------------------------------------
+class Profiler {
+public:
+    /**
+     *  One finished zone or counter sample, name must be a string literal
+     */
+    struct Event {
+        const char* name;
+        int64_t     startNs,
+                    durationNs;     //-1 marks a counter sample
+        double      value;          //Counter value, unused by zones
+    };
+
+    static int64_t now();
+    static void    record(const char* name, int64_t startNs, int64_t stopNs);
+    static void    counter(const char* name, double value);
+    static void    setThreadName(const char* name);
+    static bool    writeChromeTrace(const std::string& filepath);
+};
+
+/**
+ *  Records the lifetime of the enclosing scope in the profiler and the flight
+ *  recorder, and counts its allocations with PACMAN_TRACK_ALLOCS
+ */
+class ProfileZone {
+private:
+    const char* name;
+    int64_t     start;
+    AllocZone   allocZone;
+public:
+    ProfileZone(const char* zoneName) : name(zoneName), start(Profiler::now()), allocZone(zoneName) {};
+    ~ProfileZone() {
+        int64_t stop = Profiler::now();
+        Profiler::record(name, start, stop);
+        FlightRecorder::record(name, start, stop);
+    };
+};
+
+#define PROFILE_ZONE(name)          ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_COUNTER(name, value) Profiler::counter(name, value)
+#define PROFILE_THREAD_NAME(name)   Profiler::setThreadName(name)
+#define PROFILE_DUMP(filepath)      Profiler::writeChromeTrace(filepath)
+
+#else
+
+/**
+ *  Records the lifetime of the enclosing scope in the flight recorder, and
+ *  counts its allocations with PACMAN_TRACK_ALLOCS
+ */
+class ProfileZone {
+private:
+    FlightZone  flightZone;
+    AllocZone   allocZone;
+public:
+    ProfileZone(const char* zoneName) : flightZone(zoneName), allocZone(zoneName) {};
+};
+
+#define PROFILE_ZONE(name)          ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#define PROFILE_COUNTER(name, value)
+#define PROFILE_THREAD_NAME(name)
+#define PROFILE_DUMP(filepath)
+
+#endif
+
+#endif
@@ -0,0 +1,205 @@
+/**
+ *   RenderStats, per frame draw call, state change and upload counters
+ *
+ *   @file     renderStats.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "renderStats.h"
+
+static const int pipelineLatency = 4;      //Frames of pipeline queries in flight
+
+static RenderStats::Frame frame;
+static GLuint primitivesQuery = 0;
+static bool   querying = false;
+
+static bool   pipelineEnabled = false;
+static GLuint pipelineQueries[pipelineLatency][2] = {};
+static bool   pipelinePending[pipelineLatency] = {};
+static int    pipelineSlot = 0;
+static bool   pipelineActive = false;
+static int64_t lastInvocations = -1,
+               lastEmitted     = -1;
+
+static FILE*  csv = nullptr;
+static int64_t csvFrame = 0;
+
+/**
+ *  Counts one draw call, call next to every glDraw*
+ *
+ *  @param vertexCount - vertices the draw call submits
+ */
+void RenderStats::countDraw(GLsizei vertexCount) {
+    frame.drawCalls++;
+    frame.vertices += vertexCount;
+}
+
+/**
+ *  Counts one glUseProgram
+ */
+void RenderStats::countProgramBind() {
+    frame.programBinds++;
+}
+
+/**
+ *  Counts one glBindVertexArray
+ */
+void RenderStats::countVertexArrayBind() {
+    frame.vertexArrayBinds++;
+}
+
+/**
+ *  Counts one glBindTexture
+ */
+void RenderStats::countTextureBind() {
+    frame.textureBinds++;
+}
+
+/**
+ *  Counts data handed to glBufferData, glBufferSubData or a texture upload
+ *
+ *  @param bytes - size of the data
+ */
+void RenderStats::countUpload(size_t bytes) {
+    frame.uploadBytes += int64_t(bytes);
+}
+
+/**
+ *  Starts counting a frame
+ *
+ *  @param queryPrimitives - also count generated primitives on the GPU, endFrame then waits for the GPU
+ */
+void RenderStats::beginFrame(bool queryPrimitives) {
+    frame = Frame();
+    querying = queryPrimitives;
+    if (querying) {
+        if (primitivesQuery == 0) { glGenQueries(1, &primitivesQuery); }
+        glBeginQuery(GL_PRIMITIVES_GENERATED, primitivesQuery);
+    }
+}
+
+/**
+ *  Stops counting a frame and writes it to the CSV stream if one is open
+ *
+ *  @return returns the totals of the frame
+ */
+RenderStats::Frame RenderStats::endFrame() {
+    if (querying) {
+        glEndQuery(GL_PRIMITIVES_GENERATED);
+        GLuint64 primitives = 0;
+        glGetQueryObjectui64v(primitivesQuery, GL_QUERY_RESULT, &primitives);
+        frame.primitives = int64_t(primitives);
+        querying = false;
+    }
+    frame.gsInvocations = lastInvocations;
+    frame.gsPrimitives  = lastEmitted;
+
+    if (csv) {
+        fprintf(csv, "%lli,%i,%lli,%lli,%i,%i,%i,%lli,%lli,%lli\n", (long long)csvFrame++, frame.drawCalls,
+                (long long)frame.vertices, (long long)frame.primitives, frame.programBinds, frame.vertexArrayBinds,
+                frame.textureBinds, (long long)frame.uploadBytes, (long long)frame.gsInvocations, (long long)frame.gsPrimitives);
+    }
+    return frame;
+}
+
+/**
+ *  Returns whether the driver has the geometry shader pipeline statistics
+ */
+bool RenderStats::pipelineStatsSupported() {
+    return GLAD_GL_VERSION_4_6 || GLAD_GL_ARB_pipeline_statistics_query;
+}
+
+/**
+ *  Turns the pellet pass pipeline queries on or off, they cost a little GPU time
+ *
+ *  @param enable - true to issue the queries
+ */
+void RenderStats::setPipelineStats(bool enable) {
+    pipelineEnabled = enable && pipelineStatsSupported();
+    if (!pipelineEnabled) { lastInvocations = lastEmitted = -1; }
+}
+
+/**
+ *  Reads a pipeline query pair if the GPU is done with it
+ *
+ *  @param slot - ring slot to read
+ *
+ *  @return returns true if the slot is free to reuse
+ */
+static bool collectPipelineSlot(int slot) {
+    if (!pipelinePending[slot]) { return true; }
+    //Both queries, GL does not promise they finish in the order they ended
+    for (int query = 0; query < 2; query++) {
+        GLint available = 0;
+        glGetQueryObjectiv(pipelineQueries[slot][query], GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) { return false; }
+    }
+    GLuint64 invocations = 0, emitted = 0;
+    glGetQueryObjectui64v(pipelineQueries[slot][0], GL_QUERY_RESULT, &invocations);
+    glGetQueryObjectui64v(pipelineQueries[slot][1], GL_QUERY_RESULT, &emitted);
+    lastInvocations = int64_t(invocations);
+    lastEmitted     = int64_t(emitted);
+    pipelinePending[slot] = false;
+    return true;
+}
+
+/**
+ *  Starts the pipeline queries, call before the pellet draw
+ */
+void RenderStats::beginPipelineStats() {
+    if (!pipelineEnabled) { return; }
+    if (pipelineQueries[0][0] == 0) { glGenQueries(pipelineLatency * 2, &pipelineQueries[0][0]); }
+
+    //Skips the frame rather than wait when every slot is still in flight
+    if (!collectPipelineSlot(pipelineSlot)) { return; }
+    GLuint* queries = pipelineQueries[pipelineSlot];
+    glBeginQuery(GL_GEOMETRY_SHADER_INVOCATIONS, queries[0]);
+    glBeginQuery(GL_GEOMETRY_SHADER_PRIMITIVES_EMITTED, queries[1]);
+    pipelineActive = true;
+}
+
+/**
+ *  Ends the pipeline queries and reads the oldest finished pair
+ */
+void RenderStats::endPipelineStats() {
+    if (!pipelineActive) { return; }
+    glEndQuery(GL_GEOMETRY_SHADER_PRIMITIVES_EMITTED);
+    glEndQuery(GL_GEOMETRY_SHADER_INVOCATIONS);
+    pipelineActive = false;
+    pipelinePending[pipelineSlot] = true;
+    pipelineSlot = (pipelineSlot + 1) % pipelineLatency;
+
+    //The slot written next is the oldest one in flight
+    collectPipelineSlot(pipelineSlot);
+}
+
+/**
+ *  Streams every following frame to a CSV file
+ *
+ *  @param path - file to write, replaced if it exists
+ *
+ *  @return returns false if the file could not be opened
+ */
+bool RenderStats::openCsv(const std::string& path) {
+    if (csv) { fclose(csv); }
+    csv = fopen(path.c_str(), "w");
+    if (!csv) { return false; }
+    csvFrame = 0;
+    fprintf(csv, "frame,drawCalls,vertices,primitives,programBinds,vertexArrayBinds,textureBinds,uploadBytes,gsInvocations,gsPrimitives\n");
+    return true;
+}
+
+/**
+ *  Deletes the queries and closes the CSV stream
+ */
+void RenderStats::cleanRenderStats() {
+    if (primitivesQuery != 0) { glDeleteQueries(1, &primitivesQuery); }
+    primitivesQuery = 0;
+    if (pipelineQueries[0][0] != 0) { glDeleteQueries(pipelineLatency * 2, &pipelineQueries[0][0]); }
+    for (int slot = 0; slot < pipelineLatency; slot++) {
+        pipelineQueries[slot][0] = pipelineQueries[slot][1] = 0;
+        pipelinePending[slot] = false;
+    }
+    if (csv) { fclose(csv); }
+    csv = nullptr;
+}
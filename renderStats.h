@@ -0,0 +1,65 @@
+/**
+ *   Header for the RenderStats class.
+ *
+ *   Counts what the renderer submits each frame: draw calls, vertices,
+ *   program/VAO/texture binds and bytes uploaded to buffers and textures.
+ *   Call the count functions next to the GL call they count.
+ *
+ *   Where GL_ARB_pipeline_statistics_query (core in 4.6) is available the
+ *   pellet pass is wrapped in geometry shader invocation and emitted
+ *   primitive queries. Those are read a few frames late so they never wait
+ *   for the GPU. The benchmark also wraps the frame in a
+ *   GL_PRIMITIVES_GENERATED query, which does wait.
+ *
+ *   Frames can be streamed to a CSV file, one line per endFrame().
+ *
+ *   @file     renderStats.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __RENDERSTATS_H
+#define __RENDERSTATS_H
+
+#include "include.h"
+#include <cstdint>
+#include <string>
+
+ // -----------------------------------------------------------------------------
+ // RenderStats Class header
+ // -----------------------------------------------------------------------------
+class RenderStats {
+public:
+    /**
+     *  Totals for one frame
+     */
+    struct Frame {
+        int     drawCalls        = 0;
+        int64_t vertices         = 0;   //Vertices submitted by draw calls
+        int64_t primitives       = 0;   //Primitives after the geometry shader, only with queryPrimitives
+        int     programBinds     = 0;
+        int     vertexArrayBinds = 0;
+        int     textureBinds     = 0;
+        int64_t uploadBytes      = 0;   //Buffer and texture data sent to the driver
+        int64_t gsInvocations    = -1;  //Pellet geometry shader, -1 when not supported or not read yet
+        int64_t gsPrimitives     = -1;
+    };
+
+    static void  countDraw(GLsizei vertexCount);
+    static void  countProgramBind();
+    static void  countVertexArrayBind();
+    static void  countTextureBind();
+    static void  countUpload(size_t bytes);
+
+    static void  beginFrame(bool queryPrimitives = false);
+    static Frame endFrame();
+
+    static void  setPipelineStats(bool enable);
+    static bool  pipelineStatsSupported();
+    static void  beginPipelineStats();
+    static void  endPipelineStats();
+
+    static bool  openCsv(const std::string& path);
+    static void  cleanRenderStats();
+};
+
+#endif
@@ -0,0 +1,341 @@
+/**
+ *   Scene, level objects, simulation tick and render passes
+ *
+ *   @file     scene.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "scene.h"
+#include "profiler.h"
+#include "renderStats.h"
+
+/**
+ *  Registers the scene textures, nothing is loaded yet
+ *
+ *  @param camera - camera shared with input and every object in the scene
+ *  @param ghosts - amount of ghosts to spawn
+ */
+Scene::Scene(Camera* camera, int ghosts) : cameraAdress(camera), ghostAmount(ghosts) {
+    wallLayer  = textures.addLayer("assets/wallTexture.png");
+    ghostLayer = textures.addLayer("assets/ghostModelShader.png");
+}
+
+/**
+ *  Queues the CPU side loading, can run before a GL context exists
+ *
+ *  @param assets    - pipeline running the loader threads
+ *  @param levelPath - level file to load
+ */
+void Scene::startLoading(AssetPipeline& assets, const std::string& levelPath) {
+    Camera* camera = cameraAdress;
+    int     layer  = wallLayer;
+    assets.submit<Map*>("level0 parse + mesh",
+        [camera, layer, levelPath]() { return new Map(levelPath, camera, layer); },
+        [this](Map*& map) { loadedMap = map; });
+    for (int layer = 0; layer < textures.getLayerCount(); layer++) {
+        assets.submit("decode " + textures.getPath(layer),
+            [this, layer]() { textures.decodeLayer(layer); });
+    }
+    assets.submit<std::vector<Ghost::Vertex>>("parse ghostModel.obj",
+        []() { return Ghost::parseModel("assets/model/ghost", "/ghostModel.obj"); },
+        [this](std::vector<Ghost::Vertex>& vertices) { ghostModel = Ghost::uploadModel(vertices); });
+}
+
+/**
+ *  Waits for the loaders and creates every GL object, must run on the GL thread
+ *
+ *  @param assets - pipeline started by startLoading
+ */
+void Scene::finishLoading(AssetPipeline& assets) {
+    assets.finish();
+    Arena::level().reset();     //Load time buffers of the previous level
+    {
+        StageTimer stage(assets, "texture array upload");
+        textures.upload();
+    }
+
+    //Init map
+    {
+        StageTimer stage(assets, "map shader + VAO");
+        Maps.push_back(loadedMap);
+        Maps[0]->compileMapShader();
+    }
+    std::pair<float, float>XYshift = Maps[0]->getXYshift();
+    cameraAdress->recieveMap(Maps[0]->getIntMap());
+    {
+        StageTimer stage(assets, "nav graph");
+        nav.build(*Maps[0]);
+    }
+    nav.report();
+    {
+        StageTimer stage(assets, "flood fill");
+        flood.build(*Maps[0]);
+    }
+    flood.report();
+    {
+        StageTimer stage(assets, "line of sight");
+        sight.build(*Maps[0]);
+    }
+    sight.report();
+    {
+        StageTimer stage(assets, "distance oracle");
+        paths.build(nav);
+    }
+    paths.report();
+    if (!paths.hasTable()) {
+        {
+            StageTimer stage(assets, "hpa");
+            hpa.build(nav);
+        }
+        hpa.report();
+    }
+
+    //Init pacman
+    {
+        StageTimer stage(assets, "pacman shader + VAO");
+        Pacmans.push_back(new Pacman(Maps[0]->getPacSpawnPoint(), XYshift));
+        Pacmans[0]->compilePacShader();
+        Pacmans[0]->setWidthHeight(Maps[0]->getWidthHeight());
+        Pacmans[0]->setXYshift(XYshift);
+        Pacmans[0]->getCameraPointer(cameraAdress);
+        Pacmans[0]->setNavGraph(&nav);
+        Pacmans[0]->setVAO(Pacmans[0]->compilePacman());
+    }
+
+    //Init pellets
+    WidthHeight = Maps[0]->getWidthHeight();
+    {
+        StageTimer stage(assets, "pellets + shader");
+        pellets.init(WidthHeight, XYshift, cameraAdress);
+        for (int y = 0; y < WidthHeight.second; y++) {
+            for (int x = 0; x < WidthHeight.first; x++) {
+                if (Maps[0]->getMapVal(x, y) == 0) { pellets.add(x, y); }
+            }
+        }
+        Maps[0]->setPelletAmount(pellets.size());
+
+        //A pellet outside pacman's component can never be eaten
+        std::pair<int, int> pacSpawn = Maps[0]->getPacSpawnPoint();
+        int home = flood.componentOf(pacSpawn.first, pacSpawn.second),
+            unreachable = 0;
+        std::pair<int, int> first = { 0, 0 };
+        for (int pellet = 0; pellet < pellets.size(); pellet++) {
+            std::pair<int, int> tile = pellets.getXY(pellet);
+            if (flood.componentOf(tile.first, tile.second) != home && unreachable++ == 0) { first = tile; }
+        }
+        if (0 < unreachable) {
+            printf("Warning: %d of %d pellets can not be reached from pacman's spawn, the first at %d, %d\n",
+                unreachable, pellets.size(), first.first, first.second);
+        }
+
+        ArenaVector<float> pelletVertices{ ArenaAllocator<float>(Arena::level()) };
+        pelletVertices.reserve(size_t(pellets.size()) * PelletPool::stride);
+        pellets.gatherVertices(pelletVertices);
+        pellets.createPelletVAO(pelletVertices.data(), pellets.size());
+        pellets.compilePelletShader();
+    }
+
+    //spawn ghosts
+    if (0 < ghostAmount) {
+        StageTimer stage(assets, "ghosts + shader");
+        std::vector<std::pair<int, int>> ghostPos = Maps[0]->spawnGhost(ghostAmount, flood, ghostSpawnDistance);
+        Ghosts.reserve(ghostAmount);
+        for (auto& spawn : ghostPos) {
+            Ghosts.emplace_back(spawn.first, spawn.second, true, WidthHeight, XYshift, cameraAdress);
+        }
+        //Small or walled off levels may not have a tile for every ghost
+        if (int(Ghosts.size()) < ghostAmount) { printf("Room for %zu of %i ghosts\n", Ghosts.size(), ghostAmount); }
+        ghostAmount = int(Ghosts.size());
+        if (0 < ghostAmount) {
+            Ghosts[0].setVAO(ghostModel.first);
+            Ghosts[0].setModelSize(ghostModel.second);
+            Ghosts[0].compileGhostModelShader();
+            for (auto& ghost : Ghosts) {
+                ghost.setNavGraph(&nav);
+                ghost.setOracle(&paths);
+                if (!paths.hasTable()) { ghost.setPathfinder(&hpa); }
+                ghost.bindMotion(ghostMotion, float(simTime));
+                ghost.setTextureLayer(ghostLayer);
+                ghost.setShader(Ghosts[0].getShader());
+                ghost.setVAO(Ghosts[0].getVAO());
+                ghost.setModelSize(Ghosts[0].getModelSize());
+            }
+            lod.clear();
+            lod.setCollisionReach(XYshift);
+        }
+    }
+
+    mapPass    = gpuTimer.addPass("gpu map");
+    pelletPass = gpuTimer.addPass("gpu pellets");
+    ghostPass  = gpuTimer.addPass("gpu ghosts");
+}
+
+/**
+ *  Runs one simulation tick: input, movement, animation and collisions
+ *
+ *  @param seconds - simulated time since the last tick. Ghosts move by time
+ *                   at any tick length, pacman and animations step once per tick.
+ */
+void Scene::tick(float seconds) {
+    PROFILE_ZONE("tick");
+    bool animate = false;
+    simTime += seconds;
+
+    {
+        PROFILE_ZONE("updateLerp");
+        if (Pacmans[0]->getAnimDel() == 0) { animate = true; Pacmans[0]->updateAnimDel(3, true);
+        }  //the effective speed of animation
+        else { Pacmans[0]->updateAnimDel(-1, false); }
+        Pacmans[0]->checkForKeyUpdate();
+        Pacmans[0]->updateLerp();
+
+        if (animate) Pacmans[0]->pacAnimate();
+
+        //Far ghosts keep their target and only look for pacman when the tiers are refreshed
+        bool lodRefresh = (0 < ghostAmount) && lod.due(Pacmans[0]->getLerpStep(), seconds * Ghosts[0].getTilesPerSecond());
+
+        //The first ghost chases pacman and the second cuts him off, the rest wander until they see him
+        std::pair<int, int> pacTile = Pacmans[0]->getXY();
+        if (0 < ghostAmount && (lodRefresh || !lod.isFar(0))) { Ghosts[0].setTarget(pacTile); }
+        if (1 < ghostAmount && (lodRefresh || !lod.isFar(1))) { Ghosts[1].setTarget(ambushTile()); }
+        if (2 < ghostAmount) {
+            sightQueries.clear();
+            sightGhosts.clear();
+            auto look = [&](int g) {
+                std::pair<int, int> from = Ghosts[g].currentTile();
+                sightQueries.push_back({ from.first, from.second, pacTile.first, pacTile.second });
+                sightGhosts.push_back(g);
+            };
+            if (lodRefresh) {
+                for (int g = 2; g < ghostAmount; g++) { look(g); }
+            }
+            else {
+                for (int g : lod.getNear()) {
+                    if (2 <= g) { look(g); }
+                }
+            }
+            sight.trace(sightQueries, sightResults);
+            for (size_t q = 0; q < sightGhosts.size(); q++) { Ghosts[sightGhosts[q]].perceive(sightResults[q] != 0, pacTile); }
+        }
+
+        //Ghost positions are a function of time, only ghosts that reached a node are visited
+        crowd.step(Ghosts, ghostMotion, float(simTime));
+        if (lodRefresh) { lod.refresh(Ghosts, &paths, pacTile); }
+        if (animate && 0 < ghostAmount) { lod.animate(Ghosts, crowd.getJobSystem()); }
+    }
+
+    //Pellet Collision
+    {
+        PROFILE_ZONE("collision pellets");
+        float pacLerpProg = Pacmans[0]->getLerpProg();
+        if (0.5f <= pacLerpProg && pacLerpProg <= 0.6) {
+            std::pair<int, int> pacXY = Pacmans[0]->getXY();
+            int pellet = pellets.at(pacXY.first, pacXY.second);
+            if (0 <= pellet && pellets.remove(pellet)) {
+                Pacmans[0]->updatePelletState(true);
+                Pacmans[0]->pickupPellet();
+                FLIGHT_EVENT("pellet eaten");
+            }
+        }
+    }
+
+    if (0 < ghostAmount){
+        PROFILE_ZONE("collision ghosts");
+        std::pair<int, int>pacPos = Pacmans[0]->getXY();
+        const std::vector<int>& hits = crowd.collide(Ghosts, lod.getCollision(), pacPos, Maps[0]->getXYshift());
+        for (size_t hit = 0; hit < hits.size(); hit++) {
+            ghostHits++;
+            FLIGHT_EVENT("ghost collision");
+            if (!invulnerable) { printf("Ghost Collision\n"); Pacmans[0]->setRun(false); }
+        }
+    }
+}
+
+/**
+ *  Returns the tile a few steps ahead of pacman, as far as the corridor goes
+ *
+ *  @return returns the tile XY
+ */
+std::pair<int, int> Scene::ambushTile() {
+    std::pair<int, int> tile = Pacmans[0]->getXY();
+    int dir = Pacmans[0]->getDir();
+    for (int step = 0; step < ambushTiles && nav.canMove(tile.first, tile.second, dir); step++) {
+        tile.first  += (dir == 9) ? 1 : (dir == 3) ? -1 : 0;
+        tile.second += (dir == 2) ? 1 : (dir == 4) ? -1 : 0;
+    }
+    return tile;
+}
+
+/**
+ *  Rebuilds the pellet buffer if pellets were eaten since the last call
+ */
+void Scene::updatePellets() {
+    //If pellets has been eaten, update
+    if (Pacmans[0]->updatePelletState(false)) {
+        PROFILE_ZONE("pellet rebuild");
+        //Staging copy, gone when the frame arena is reset
+        ArenaVector<float> pelletVertices{ ArenaAllocator<float>(Arena::frame()) };
+        pelletVertices.reserve(size_t(pellets.getRemaining()) * PelletPool::stride);
+        pellets.gatherVertices(pelletVertices);
+        pellets.updatePelletVBO(pelletVertices.data(), pellets.getRemaining());
+        Pacmans[0]->updatePelletState(true);
+        if (pellets.getRemaining() == 0 && !invulnerable) {
+            printf("All Pellets Collected\n");
+            FLIGHT_EVENT("all pellets collected");
+            Pacmans[0]->setRun(false);
+        }
+    }
+}
+
+/**
+ *  Draws the scene into the bound framebuffer, each pass timed on the GPU
+ *
+ *  @param currentTime - seconds used by the ghost animation
+ *  @param tickLead    - seconds the frame is shown after the last tick, ghosts are drawn that far ahead
+ */
+void Scene::render(double currentTime, double tickLead) {
+    glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    {
+        PROFILE_ZONE("draw pacman");
+        Pacmans[0]->drawPacman();
+    }
+
+    //Draws Ghosts
+    if (0 < ghostAmount) {
+        PROFILE_ZONE("draw ghosts");
+        GpuTimerScope gpuScope(gpuTimer, ghostPass);
+        bool ahead = isRunning() && 0.0 < tickLead;
+        if (ahead) { ghostMotion.interpolate(float(simTime + tickLead), crowd.getJobSystem()); }
+        for (auto& ghost : Ghosts) {
+            ghost.drawGhostsAsModels(currentTime, WidthHeight);
+        }
+        //Ticks read tiles from these positions, they must not depend on when frames are shown
+        if (ahead) { ghostMotion.interpolate(float(simTime), crowd.getJobSystem()); }
+    }
+    {
+        PROFILE_ZONE("draw map");
+        GpuTimerScope gpuScope(gpuTimer, mapPass);
+        Maps[0]->drawMap();
+    }
+    {
+        PROFILE_ZONE("draw pellets");
+        GpuTimerScope gpuScope(gpuTimer, pelletPass);
+        RenderStats::beginPipelineStats();
+        pellets.drawPellets();
+        RenderStats::endPipelineStats();
+    }
+    gpuTimer.collect();
+}
+
+/**
+ *  Deletes every GL object of the scene
+ */
+void Scene::cleanScene() {
+    glUseProgram(0);
+    Maps[0]->cleanMap();
+    Pacmans[0]->cleanCharacter();
+    if (0 < ghostAmount) Ghosts[0].cleanCharacter();
+    pellets.cleanPellets();
+    textures.cleanTextureArray();
+    gpuTimer.cleanGpuTimer();
+}
@@ -0,0 +1,108 @@
+/**
+ *   Header for the Scene class.
+ *
+ *   Owns everything in a running level: map, pacman, ghosts, pellets and
+ *   their textures, and runs the simulation tick and the render passes.
+ *   The interactive window and the headless benchmark both drive a Scene,
+ *   so they draw exactly the same thing.
+ *
+ *   @file     scene.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __SCENE_H
+#define __SCENE_H
+
+#include "pacman.h"
+#include "ghost.h"
+#include "pellet.h"
+#include "map.h"
+#include "assetPipeline.h"
+#include "textureArray.h"
+#include "gpuTimer.h"
+#include "arena.h"
+#include "navGraph.h"
+#include "distanceOracle.h"
+#include "hpaPathfinder.h"
+#include "floodFill.h"
+#include "lineOfSight.h"
+#include "ghostLod.h"
+#include "ghostCrowd.h"
+
+ // -----------------------------------------------------------------------------
+ // Scene Class header
+ // -----------------------------------------------------------------------------
+class Scene {
+private:
+    //Container definition
+    std::vector<Map*>		Maps;		///< Contains only map, permits adding more maps in the future
+    std::vector<Pacman*>    Pacmans;    ///< Contains only pacman, done for ease of use
+    //Ghosts are an array of objects, not split into arrays per field. What every
+    //tick reads for every ghost, segment times and positions, is already split
+    //into arrays in ghostMotion. Tile, direction and speed are only read for
+    //ghosts that reach a node or are near pacman, and Ghost shares them with
+    //Pacman through Character, so splitting them would not shorten a full loop.
+    std::vector<Ghost>      Ghosts;     ///< Contains ghosts, contiguous and addressed by index
+    MotionBatch             ghostMotion;///< Movement segments of every ghost, slot == index in Ghosts
+    double                  simTime = 0.0;  ///< Simulated seconds since the level was loaded
+    PelletPool              pellets;    ///< Contains All pellets
+    NavGraph                nav;        ///< Legal moves and junctions of the loaded map
+    FloodFill               flood;      ///< Connected components, checks pellets and ghost spawns
+    DistanceOracle          paths;      ///< Shortest paths between tiles, ghost targets use it
+    HpaPathfinder           hpa;        ///< Ghost targets on levels too big for the paths table
+    LineOfSight             sight;      ///< Which wandering ghosts see pacman
+    std::vector<LineOfSight::Query> sightQueries;   ///< One ray per wandering ghost that looks this tick
+    std::vector<int>        sightGhosts;    ///< Ghost index of each ray
+    std::vector<uint8_t>    sightResults;
+    GhostLod                lod;        ///< Far ghosts look, retarget and animate less, see tick
+    GhostCrowd              crowd;      ///< Runs ghost decisions, movement and collisions on the job system
+    Camera* cameraAdress;
+
+    //All textures share one array, layers are fixed before loading starts
+    TextureArray textures;
+    int     wallLayer,
+            ghostLayer;
+    Map*    loadedMap = nullptr;
+    std::pair<GLuint, int> ghostModel = { 0, 0 };
+    std::pair<int, int> WidthHeight;
+
+    int     ghostAmount;
+    bool    invulnerable = false;       //Ghost collisions are counted but do not end the game
+    int     ghostHits = 0;
+
+    static const int ambushTiles = 4;   //How far ahead of pacman the ambusher aims
+    static const int ghostSpawnDistance = 8;    //Fewest moves between pacman and a ghost at spawn
+
+    GpuTimer gpuTimer;
+    int     mapPass    = -1,
+            pelletPass = -1,
+            ghostPass  = -1;
+
+    std::pair<int, int> ambushTile();
+
+public:
+    Scene(Camera* camera, int ghosts = 5);
+    void    startLoading(AssetPipeline& assets, const std::string& levelPath);
+    void    finishLoading(AssetPipeline& assets);
+    void    tick(float seconds);
+    void    updatePellets();
+    void    render(double currentTime, double tickLead = 0.0);
+    void    cleanScene();
+
+    bool    isRunning()                 { return Pacmans[0]->getRun(); };
+    void    setInvulnerable(bool on)    { invulnerable = on; };
+    void    setJobSystem(JobSystem* jobs)   { crowd.setJobSystem(jobs); };
+    int     getGhostHits()              { return ghostHits; };
+    double  getSimTime()                { return simTime; };
+    int     getPelletsEaten()           { return Pacmans[0]->getPellets(); };
+    Map*    getMap()                    { return Maps[0]; };
+    NavGraph& getNavGraph()             { return nav; };
+    DistanceOracle& getPaths()          { return paths; };
+    Pacman* getPacman()                 { return Pacmans[0]; };
+    GpuTimer& getGpuTimer()             { return gpuTimer; };
+    int     getMapPass()                { return mapPass; };
+    int     getPelletPass()             { return pelletPass; };
+    int     getGhostPass()              { return ghostPass; };
+};
+
+#endif
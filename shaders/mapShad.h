@@ -9,6 +9,7 @@ static const std::string mapVertexShaderSrc = R"(
 /** Inputs */
 in vec3 mPosition;
 in vec2 mTexcoord;
+in float mLayer;
 
 /** Uniform */
 uniform mat4 view;
@@ -16,11 +17,13 @@ uniform mat4 projection;
 
 /** Outputs */
 out vec2 mapTexcoord;
+flat out float mapLayer;
 
 void main()
 {
 //We multiply our matrices with our position to change the positions of vertices to their final destinations.
 mapTexcoord = mTexcoord;
+mapLayer = mLayer;
 gl_Position = projection * view * vec4(mPosition, 1.0f);
 }
 )";
@@ -30,15 +33,16 @@ static const std::string mapFragmentShaderSrc = R"(
 
 /** Inputs */
 in vec2 mapTexcoord;
+flat in float mapLayer;
 
 /** Outputs */
 out vec4 color;
 
-uniform sampler2D u_mapTexture;
+uniform sampler2DArray u_mapTexture;	//Every wall variant lives in a layer of the same array
 
 void main()
 {
-	vec4 textColorM = texture(u_mapTexture, mapTexcoord);
+	vec4 textColorM = texture(u_mapTexture, vec3(mapTexcoord, mapLayer));
 	color = textColorM;
 }
 )";
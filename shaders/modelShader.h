@@ -61,7 +61,8 @@ uniform vec3 u_LightColor;
 uniform vec3 u_LightDirection;
 uniform float u_Specularity;
 
-uniform sampler2D u_modelTexture;
+uniform sampler2DArray u_modelTexture;
+uniform int u_layer;
 
 //A new function for computing how shadowed a fragment is
 float ShadowCalculation(
@@ -124,7 +125,7 @@ float shadow = ShadowCalculation(FragPosLightSpace,normals);
 
 vec3 light = DirectionalLight(u_LightColor,u_LightDirection,shadow);
 
-vec4 textColorMod = texture(u_modelTexture, modTexture);
+vec4 textColorMod = texture(u_modelTexture, vec3(modTexture, u_layer));
 
 color = u_Color * textColorMod * vec4(light, 1.0);
 }
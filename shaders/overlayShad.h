@@ -0,0 +1,36 @@
+#ifndef __OVERLAYSHAD_H_
+#define __OVERLAYSHAD_H_
+
+#include <string>
+
+static const std::string overlayVertexShaderSrc = R"(
+#version 430 core
+
+/** Inputs */
+in vec2 oPosition;		//Already in normalized device coordinates
+in vec3 oColor;
+
+/** Outputs */
+out vec3 vsColor;
+
+void main()
+{
+vsColor = oColor;
+gl_Position = vec4(oPosition, 0.0f, 1.0f);
+}
+)";
+
+static const std::string overlayFragmentShaderSrc = R"(
+#version 430 core
+
+in vec3 vsColor;
+
+out vec4 color;
+
+void main()
+{
+color = vec4(vsColor, 1.0f);
+}
+)";
+
+#endif // __OVERLAYSHAD_H_
@@ -0,0 +1,102 @@
+/**
+ *   distance_oracle_test, headless checks of the all pairs table against its fallback
+ *
+ *   Small levels get a table of every distance, big ones a few cached
+ *   distance fields. Ghosts must walk the same way either way, so both are
+ *   built on the same levels and asked about every pair of tiles: the
+ *   distances must be the exact breadth first ones, the next moves the same
+ *   and every next move legal and one step closer.
+ *
+ *   Usage: distance_oracle_test [level file], exits with 1 if a check fails
+ *
+ *   @file     distanceOracleTest.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+#include "../map.h"
+#include "../navGraph.h"
+#include "../distanceOracle.h"
+#include "testLevels.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+/**
+ *  Asks the table and the fallback about every pair of walkable tiles
+ *
+ *  @param name - level name for the report
+ *  @return returns true if the check passed
+ */
+static bool tableMatchesFallback(const std::string& name, NavGraph& nav) {
+    int width = nav.getWidthHeight().first;
+    std::vector<int> tiles = walkableTiles(nav);
+    DistanceOracle table, fallback;
+    table.build(nav, int(tiles.size()));
+    fallback.build(nav, 0);
+    if (!table.hasTable() || fallback.hasTable()) {
+        printf("FAIL oracle_%s: table %i, fallback %i\n", name.c_str(), int(table.hasTable()), int(fallback.hasTable()));
+        return false;
+    }
+
+    //Target by target so the fallback builds each field once
+    long long pairs = 0;
+    for (int to : tiles) {
+        int toX = to % width, toY = to / width;
+        std::vector<int> exact = bfsDistances(nav, toX, toY);
+        for (int from : tiles) {
+            int fromX = from % width, fromY = from / width;
+            int fromTable = table.distance(fromX, fromY, toX, toY),
+                fromField = fallback.distance(fromX, fromY, toX, toY),
+                dirTable  = table.nextDir(fromX, fromY, toX, toY),
+                dirField  = fallback.nextDir(fromX, fromY, toX, toY);
+            if (fromTable != exact[from] || fromField != exact[from] || dirTable != dirField) {
+                printf("FAIL oracle_%s: %i,%i to %i,%i table %i dir %i, fallback %i dir %i, exact %i\n", name.c_str(),
+                    fromX, fromY, toX, toY, fromTable, dirTable, fromField, dirField, exact[from]);
+                return false;
+            }
+            if (0 < exact[from]) {
+                std::pair<int, int> next = stepTile({ fromX, fromY }, dirTable);
+                if (!nav.canMove(fromX, fromY, dirTable) || exact[next.second * width + next.first] != exact[from] - 1) {
+                    printf("FAIL oracle_%s: %i,%i to %i,%i moves %i, not one step closer\n", name.c_str(),
+                        fromX, fromY, toX, toY, dirTable);
+                    return false;
+                }
+            } else if (dirTable != 0) {
+                printf("FAIL oracle_%s: %i,%i to %i,%i moves %i with no way to go\n", name.c_str(),
+                    fromX, fromY, toX, toY, dirTable);
+                return false;
+            }
+            pairs++;
+        }
+    }
+    printf("ok   oracle_%s: %zu tiles, %lld pairs agree\n", name.c_str(), tiles.size(), pairs);
+    return true;
+}
+
+/**
+ *  Loads a level file and runs the check on it
+ *
+ *  @param removeFile - true to delete the file once loaded
+ *  @return returns true if the check passed
+ */
+static bool checkLevel(const std::string& name, const std::string& path, bool removeFile) {
+    Camera camera;
+    Map map(path, &camera);
+    if (removeFile) { remove(path.c_str()); }
+    NavGraph nav;
+    nav.build(map);
+    return tableMatchesFallback(name, nav);
+}
+
+/**
+ *  Main function
+ */
+int main(int argc, char** argv) {
+    bool passed = true;
+    if (1 < argc) { passed &= checkLevel("level0", argv[1], false); }
+    passed &= checkLevel("pillars_56x72", writePillars("distance_oracle", 56, 72), true);
+    passed &= checkLevel("snake_40x40", writeSnake("distance_oracle", 40, 40), true);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
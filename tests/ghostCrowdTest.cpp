@@ -0,0 +1,149 @@
+/**
+ *   ghost_crowd_test, headless checks that ghost ticks do not depend on the worker count
+ *
+ *   GhostCrowd lets ghosts decide on JobSystem workers. Every ghost only
+ *   reads shared tables and its own random stream, so thousands of ghosts
+ *   must end up on the same positions, bit for bit, on one worker, on four
+ *   and when each segment end is handled on its own with
+ *   Ghost::tileBoundary. Checked with the all pairs table, where ghosts
+ *   decide in parallel, and with HPA* on a maze, where chasing ghosts
+ *   decide on the calling thread.
+ *
+ *   Usage: ghost_crowd_test, exits with 1 if a check fails
+ *
+ *   @file     ghostCrowdTest.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+#include "../map.h"
+#include "../ghost.h"
+#include "../ghostCrowd.h"
+#include "../jobSystem.h"
+#include "../navGraph.h"
+#include "../distanceOracle.h"
+#include "../hpaPathfinder.h"
+#include "../motionBatch.h"
+#include "testLevels.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const int ghostCount = 4096,
+                 ticks      = 200;
+
+/**
+ *  Ticks a crowd of ghosts, half of them chasing pacman's spawn
+ *
+ *  @param workers - JobSystem workers, 0 to hand each end to Ghost::tileBoundary instead
+ *  @return returns a hash of every position and collision after each tick
+ */
+static std::vector<uint64_t> runCrowd(Camera& camera, Map& map, NavGraph& nav, DistanceOracle* paths,
+                                      HpaPathfinder* hpa, int workers) {
+    std::vector<int> tiles = walkableTiles(nav);
+    int width = nav.getWidthHeight().first;
+    std::pair<int, int> pacTile = { 1, map.getWidthHeight().second - 2 };
+    if (hpa) { hpa->clearCache(); }    //Every run starts cold, like a new level
+    srand(unsigned(ghostCount));
+    std::vector<Ghost> ghosts;
+    ghosts.reserve(ghostCount);
+    for (int g = 0; g < ghostCount; g++) {
+        int tile = tiles[(size_t(g) * 7919) % tiles.size()];
+        ghosts.emplace_back(tile % width, tile / width, true, map.getWidthHeight(), map.getXYshift(), &camera);
+    }
+    MotionBatch motion;
+    std::vector<int> everyone(ghostCount);
+    for (int g = 0; g < ghostCount; g++) {
+        ghosts[g].setNavGraph(&nav);
+        ghosts[g].setOracle(paths);
+        ghosts[g].setPathfinder(hpa);
+        if (g % 2 == 0) { ghosts[g].setTarget(pacTile); }
+        ghosts[g].bindMotion(motion, 0.0f);
+        everyone[g] = g;
+    }
+
+    JobSystem  jobs(std::max(1, workers));
+    GhostCrowd crowd;
+    crowd.setJobSystem(&jobs);
+    std::vector<uint64_t> hashes;
+    double now = 0.0;
+    for (int t = 0; t < ticks; t++) {
+        now += 0.015;
+        if (workers == 0) {
+            int   slot;
+            float eventTime;
+            while (motion.nextEvent(float(now), slot, eventTime)) { ghosts[slot].tileBoundary(eventTime); }
+            motion.interpolate(float(now));
+        }
+        else { crowd.step(ghosts, motion, float(now)); }
+        uint64_t hash = 1469598103934665603ull;
+        for (int g = 0; g < ghostCount; g++) {
+            float position[2] = { motion.getX(g), motion.getY(g) };
+            uint32_t bits[2];
+            memcpy(bits, position, sizeof(bits));
+            hash = (hash ^ bits[0]) * 1099511628211ull;
+            hash = (hash ^ bits[1]) * 1099511628211ull;
+        }
+        for (int hit : crowd.collide(ghosts, everyone, pacTile, map.getXYshift())) { hash = (hash ^ uint32_t(hit)) * 1099511628211ull; }
+        hashes.push_back(hash);
+    }
+    return hashes;
+}
+
+/**
+ *  Runs the same crowd on one and four workers and one end at a time
+ *
+ *  @param name - check name for the report
+ *  @return returns true if the check passed
+ */
+static bool sameOnAnyWorkers(const std::string& name, Camera& camera, Map& map, NavGraph& nav,
+                             DistanceOracle* paths, HpaPathfinder* hpa) {
+    std::vector<uint64_t> alone = runCrowd(camera, map, nav, paths, hpa, 0);
+    for (int workers : { 1, 4 }) {
+        std::vector<uint64_t> hashes = runCrowd(camera, map, nav, paths, hpa, workers);
+        for (int t = 0; t < ticks; t++) {
+            if (hashes[t] != alone[t]) {
+                printf("FAIL %s: %i workers moved %i ghosts differently at tick %i\n", name.c_str(), workers, ghostCount, t + 1);
+                return false;
+            }
+        }
+    }
+    printf("ok   %s: %i ghosts in the same places for %i ticks on 1 and 4 workers\n", name.c_str(), ghostCount, ticks);
+    return true;
+}
+
+/**
+ *  Main function
+ */
+int main() {
+    bool passed = true;
+    {
+        std::string path = writePillars("ghost_crowd", 56, 72);
+        Camera camera;
+        Map map(path, &camera);
+        remove(path.c_str());
+        camera.recieveMap(map.getIntMap());
+        NavGraph nav;
+        nav.build(map);
+        DistanceOracle paths;
+        paths.build(nav, int(walkableTiles(nav).size()));
+        passed &= sameOnAnyWorkers("crowd_table", camera, map, nav, &paths, nullptr);
+    }
+    {
+        std::string path = writeMaze("ghost_crowd", 201, 201);
+        Camera camera;
+        Map map(path, &camera);
+        remove(path.c_str());
+        camera.recieveMap(map.getIntMap());
+        NavGraph nav;
+        nav.build(map);
+        HpaPathfinder hpa;
+        hpa.build(nav);
+        passed &= sameOnAnyWorkers("crowd_hpa", camera, map, nav, nullptr, &hpa);
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
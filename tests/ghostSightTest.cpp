@@ -0,0 +1,98 @@
+/**
+ *   ghost_sight_test, headless checks of what wandering ghosts do with what they see
+ *
+ *   A ghost that saw pacman in the middle of a corridor has to give up the
+ *   chase once it walks over that tile. With a NavGraph the ghost only
+ *   decides at the corridor ends, so the check must use the tile it is on
+ *   and not the end of its segment.
+ *
+ *   Usage: ghost_sight_test, exits with 1 if a check fails
+ *
+ *   @file     ghostSightTest.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "../map.h"
+#include "../ghost.h"
+#include "../navGraph.h"
+#include "../motionBatch.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+/**
+ *  Writes a straight corridor between two dead ends, walls all around
+ *
+ *  @return returns the file path
+ */
+static std::string writeCorridor(int length) {
+    std::string path = "ghost_sight_corridor";
+    int width = length + 2;
+    FILE* out = fopen(path.c_str(), "w");
+    fprintf(out, "%ix5\n", width);
+    for (int y = 0; y < 5; y++) {
+        for (int x = 0; x < width; x++) {
+            int value = (y == 2 && 0 < x && x < width - 1) ? 0 : 1;
+            if (y == 2 && x == width - 2) { value = 2; }
+            fprintf(out, "%i%s", value, (x + 1 < width) ? " " : "\n");
+        }
+    }
+    fclose(out);
+    return path;
+}
+
+/**
+ *  Pacman is seen once halfway down the corridor, then lost. The ghost walks
+ *  from one dead end past that tile and must wander again when it gets there.
+ *
+ *  @return returns true if the check passed
+ */
+static bool seenMidCorridor(Camera& camera, Map& map, NavGraph& nav, int length) {
+    std::pair<int, int> seenAt = { length / 2 + 1, 2 };
+    Ghost ghost(1, 2, true, map.getWidthHeight(), map.getXYshift(), &camera);
+    ghost.setNavGraph(&nav);
+    MotionBatch motion;
+    ghost.bindMotion(motion, 0.0f);
+
+    ghost.perceive(true, seenAt);
+    double now = 0.0;
+    const int ticks = 2000;
+    for (int tick = 0; tick < ticks; tick++) {
+        now += 0.015;
+        int   slot;
+        float eventTime;
+        while (motion.nextEvent(float(now), slot, eventTime)) { ghost.tileBoundary(eventTime); }
+        motion.interpolate(float(now));
+        ghost.perceive(false, seenAt);
+        if (!ghost.isSearching()) {
+            std::pair<int, int> tile = ghost.currentTile();
+            if (tile != seenAt || ghost.getTarget().first != -1) {
+                printf("FAIL seen_mid_corridor: stopped searching on tile %i,%i, pacman was seen on %i,%i\n",
+                    tile.first, tile.second, seenAt.first, seenAt.second);
+                return false;
+            }
+            printf("ok   seen_mid_corridor: gave up on tile %i,%i after %i ticks\n", tile.first, tile.second, tick + 1);
+            return true;
+        }
+    }
+    printf("FAIL seen_mid_corridor: still heading for %i,%i after %i ticks\n", seenAt.first, seenAt.second, ticks);
+    return false;
+}
+
+/**
+ *  Main function
+ */
+int main() {
+    const int length = 9;
+    std::string path = writeCorridor(length);
+    Camera camera;
+    Map map(path, &camera);
+    remove(path.c_str());
+    camera.recieveMap(map.getIntMap());
+    NavGraph nav;
+    nav.build(map);
+
+    bool passed = seenMidCorridor(camera, map, nav, length);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,125 @@
+/**
+ *   hpa_pathfinder_test, headless checks of HPA* paths against exact distances
+ *
+ *   HpaPathfinder may take a few tiles more than the shortest way but never
+ *   an illegal step. Random pairs of tiles on open, folded and maze levels
+ *   are refined to whole paths and compared with a breadth first search:
+ *   the path must start and end on the right tiles, move one legal step at
+ *   a time, exist exactly when the search finds a way and never be shorter
+ *   than it. On average it may be at most maxExcess longer.
+ *
+ *   Usage: hpa_pathfinder_test [level file], exits with 1 if a check fails
+ *
+ *   @file     hpaPathfinderTest.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+#include "../map.h"
+#include "../navGraph.h"
+#include "../hpaPathfinder.h"
+#include "testLevels.h"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+static const int    pairCount = 3000;
+static const double maxExcess = 0.01;       //Extra tiles over the shortest, summed over every pair
+
+/**
+ *  Checks one refined path step by step
+ *
+ *  @return returns an empty string if the path is fine, else what is wrong
+ */
+static std::string checkPath(NavGraph& nav, const std::vector<int>& tiles, int from, int to, int length) {
+    int width = nav.getWidthHeight().first;
+    if (tiles.empty() || tiles.front() != from || tiles.back() != to) { return "wrong endpoints"; }
+    if (length != int(tiles.size()) - 1) { return "length does not match the tiles"; }
+    for (size_t t = 1; t < tiles.size(); t++) {
+        std::pair<int, int> tile = { tiles[t - 1] % width, tiles[t - 1] / width };
+        bool legal = false;
+        for (int dir : { 2, 4, 3, 9 }) {
+            std::pair<int, int> next = stepTile(tile, dir);
+            if (next.second * width + next.first == tiles[t]) { legal = nav.canMove(tile.first, tile.second, dir); }
+        }
+        if (!legal) { return "illegal step from " + std::to_string(tile.first) + "," + std::to_string(tile.second); }
+    }
+    return "";
+}
+
+/**
+ *  Refines paths between random pairs of walkable tiles
+ *
+ *  @param name - level name for the report
+ *  @return returns true if the check passed
+ */
+static bool pathsMatchBfs(const std::string& name, NavGraph& nav) {
+    int width = nav.getWidthHeight().first;
+    std::vector<int> tiles = walkableTiles(nav), path;
+    HpaPathfinder hpa;
+    hpa.build(nav);
+
+    unsigned seed = 2024;
+    auto next = [&]() { seed = seed * 1103515245u + 12345u; return int((seed >> 8) & 0xFFFFFF); };
+    long long exactSum = 0, pathSum = 0;
+    int reachable = 0;
+    for (int p = 0; p < pairCount; p++) {
+        int from = tiles[next() % tiles.size()],
+            to   = tiles[next() % tiles.size()];
+        int fromX = from % width, fromY = from / width,
+            toX   = to % width,   toY   = to / width;
+        int exact  = bfsDistances(nav, fromX, fromY)[to],
+            length = hpa.findPath(fromX, fromY, toX, toY, path);
+        if ((exact < 0) != (length < 0) || (0 <= length && length < exact)) {
+            printf("FAIL hpa_%s: %i,%i to %i,%i took %i, exact %i\n", name.c_str(), fromX, fromY, toX, toY, length, exact);
+            return false;
+        }
+        if (exact < 0) { continue; }
+        std::string problem = checkPath(nav, path, from, to, length);
+        if (problem.empty() && hpa.distance(fromX, fromY, toX, toY) != length) { problem = "distance() does not match the path"; }
+        if (problem.empty() && (0 < exact) != (hpa.nextDir(fromX, fromY, toX, toY) != 0)) { problem = "nextDir() does not move"; }
+        if (!problem.empty()) {
+            printf("FAIL hpa_%s: %i,%i to %i,%i %s\n", name.c_str(), fromX, fromY, toX, toY, problem.c_str());
+            return false;
+        }
+        exactSum += exact;
+        pathSum  += length;
+        reachable++;
+    }
+    double excess = (0 < exactSum) ? double(pathSum - exactSum) / double(exactSum) : 0.0;
+    if (maxExcess < excess) {
+        printf("FAIL hpa_%s: paths %.2f%% longer than the shortest on average\n", name.c_str(), excess * 100.0);
+        return false;
+    }
+    printf("ok   hpa_%s: %i of %i pairs reachable, paths %.2f%% longer than the shortest\n",
+        name.c_str(), reachable, pairCount, excess * 100.0);
+    return true;
+}
+
+/**
+ *  Loads a level file and runs the check on it
+ *
+ *  @param removeFile - true to delete the file once loaded
+ *  @return returns true if the check passed
+ */
+static bool checkLevel(const std::string& name, const std::string& path, bool removeFile) {
+    Camera camera;
+    Map map(path, &camera);
+    if (removeFile) { remove(path.c_str()); }
+    NavGraph nav;
+    nav.build(map);
+    return pathsMatchBfs(name, nav);
+}
+
+/**
+ *  Main function
+ */
+int main(int argc, char** argv) {
+    bool passed = true;
+    if (1 < argc) { passed &= checkLevel("level0", argv[1], false); }
+    passed &= checkLevel("pillars_56x72", writePillars("hpa_pathfinder", 56, 72), true);
+    passed &= checkLevel("snake_60x60", writeSnake("hpa_pathfinder", 60, 60), true);
+    passed &= checkLevel("maze_201x201", writeMaze("hpa_pathfinder", 201, 201), true);
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,163 @@
+/**
+ *   Level files and exact distances shared by the headless checks.
+ *
+ *   The writers put a level file in the working directory and return its
+ *   path, the caller loads it into a Map and removes it. The file name
+ *   starts with the test name since ctest may run the tests side by side.
+ *   Pacman always spawns on an open tile so every level loads.
+ *
+ *   @file     testLevels.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __TESTLEVELS_H
+#define __TESTLEVELS_H
+
+#include "../navGraph.h"
+#include <cstdio>
+#include <string>
+#include <vector>
+
+/**
+ *  Writes a grid to a level file
+ *
+ *  @return returns the file path
+ */
+inline std::string writeGrid(const std::string& path, const std::vector<int>& grid, int width, int height) {
+    FILE* out = fopen(path.c_str(), "w");
+    fprintf(out, "%ix%i\n", width, height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) { fprintf(out, "%i%s", grid[y * width + x], (x + 1 < width) ? " " : "\n"); }
+    }
+    fclose(out);
+    return path;
+}
+
+/**
+ *  Writes an open level with a pillar on every even tile, walls around and
+ *  pacman in the bottom left corner, the layout the benchmarks scale up
+ *
+ *  @return returns the file path
+ */
+inline std::string writePillars(const std::string& test, int width, int height) {
+    std::vector<int> grid(size_t(width) * height, 0);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            bool border = (x == 0 || y == 0 || x == width - 1 || y == height - 1),
+                 pillar = (x % 2 == 0 && y % 2 == 0);
+            grid[y * width + x] = (border || pillar) ? 1 : 0;
+        }
+    }
+    grid[(height - 2) * width + 1] = 2;
+    return writeGrid(test + "_pillars", grid, width, height);
+}
+
+/**
+ *  Writes one long corridor folded back and forth across the level, the
+ *  worst case for anything that assumes the way is roughly straight
+ *
+ *  @return returns the file path
+ */
+inline std::string writeSnake(const std::string& test, int width, int height) {
+    std::vector<int> grid(size_t(width) * height, 1);
+    for (int y = 1; y < height - 2; y += 2) {
+        for (int x = 1; x < width - 1; x++) { grid[y * width + x] = 0; }
+        if (y + 2 < height - 2) { grid[(y + 1) * width + (((y / 2) % 2 == 0) ? width - 2 : 1)] = 0; }
+    }
+    grid[1 * width + 1] = 2;
+    return writeGrid(test + "_snake", grid, width, height);
+}
+
+/**
+ *  Writes a maze carved from a fixed seed with one wall in 40 knocked out
+ *  so there are loops, same as the benchmark maze
+ *
+ *  @return returns the file path
+ */
+inline std::string writeMaze(const std::string& test, int width, int height) {
+    std::vector<int> grid(size_t(width) * height, 1);
+    int cellsX = (width - 1) / 2, cellsY = (height - 2) / 2;
+    std::vector<char> visited(size_t(cellsX) * cellsY, 0);
+    std::vector<int> stack = { 0 };
+    unsigned seed = 12345;
+    auto next = [&]() { seed = seed * 1103515245u + 12345u; return int((seed >> 16) & 0x7FFF); };
+    visited[0] = 1;
+    grid[1 * width + 1] = 0;
+    while (!stack.empty()) {
+        int cell = stack.back(), cx = cell % cellsX, cy = cell / cellsX;
+        int options[4], count = 0;
+        if (0 < cx && !visited[cell - 1])                { options[count++] = cell - 1; }
+        if (cx + 1 < cellsX && !visited[cell + 1])       { options[count++] = cell + 1; }
+        if (0 < cy && !visited[cell - cellsX])           { options[count++] = cell - cellsX; }
+        if (cy + 1 < cellsY && !visited[cell + cellsX])  { options[count++] = cell + cellsX; }
+        if (count == 0) { stack.pop_back(); continue; }
+        int to = options[next() % count], tx = to % cellsX, ty = to / cellsX;
+        visited[to] = 1;
+        grid[(2 * ty + 1) * width + 2 * tx + 1] = 0;
+        grid[(cy + ty + 1) * width + cx + tx + 1] = 0;
+        stack.push_back(to);
+    }
+    for (int knock = 0; knock < width * height / 40; knock++) {
+        int x = 1 + next() % (width - 2), y = 1 + next() % (height - 3);
+        bool across = (grid[y * width + x - 1] == 0 && grid[y * width + x + 1] == 0)
+                   || (grid[(y - 1) * width + x] == 0 && grid[(y + 1) * width + x] == 0);
+        if (across) { grid[y * width + x] = 0; }
+    }
+    grid[(height - 2) * width + 1] = 2;
+    return writeGrid(test + "_maze", grid, width, height);
+}
+
+/**
+ *  Every tile a ghost can stand on, as y * width + x
+ */
+inline std::vector<int> walkableTiles(NavGraph& nav) {
+    std::pair<int, int> size = nav.getWidthHeight();
+    std::vector<int> tiles;
+    for (int y = 0; y < size.second; y++) {
+        for (int x = 0; x < size.first; x++) {
+            if (nav.legalMask(x, y) != 0) { tiles.push_back(y * size.first + x); }
+        }
+    }
+    return tiles;
+}
+
+/**
+ *  Moves a tile one step in a direction
+ *
+ *  @param dir - 2, 4, 3 or 9 like everywhere else
+ */
+inline std::pair<int, int> stepTile(std::pair<int, int> tile, int dir) {
+    switch (dir) {
+    case 9: return { tile.first + 1, tile.second };
+    case 3: return { tile.first - 1, tile.second };
+    case 2: return { tile.first, tile.second + 1 };
+    case 4: return { tile.first, tile.second - 1 };
+    }
+    return tile;
+}
+
+/**
+ *  Exact steps from one tile to every tile by breadth first search over the
+ *  legal moves, -1 where there is no way
+ */
+inline std::vector<int> bfsDistances(NavGraph& nav, int fromX, int fromY) {
+    static const int dirs[4] = { 2, 4, 3, 9 };
+    std::pair<int, int> size = nav.getWidthHeight();
+    std::vector<int> dist(size_t(size.first) * size.second, -1);
+    std::vector<int> queue = { fromY * size.first + fromX };
+    dist[queue[0]] = 0;
+    for (size_t head = 0; head < queue.size(); head++) {
+        std::pair<int, int> tile = { queue[head] % size.first, queue[head] / size.first };
+        for (int dir : dirs) {
+            if (!nav.canMove(tile.first, tile.second, dir)) { continue; }
+            std::pair<int, int> to = stepTile(tile, dir);
+            int index = to.second * size.first + to.first;
+            if (dist[index] != -1) { continue; }
+            dist[index] = dist[queue[head]] + 1;
+            queue.push_back(index);
+        }
+    }
+    return dist;
+}
+
+#endif
@@ -0,0 +1,174 @@
+/**
+ *   timing_wheel_test, headless checks of the order segment ends come out in
+ *
+ *   MotionBatch keeps segment ends in a TimingWheel and hands them out with
+ *   nextEvent(). Whatever the frame rate, the ends must come out in (time,
+ *   slot) order, including ends set after their wheel tick was taken and
+ *   ends far enough ahead to cascade down the wheel levels. Ghosts then
+ *   make the same choices in the same order, so their paths must not
+ *   depend on how often the game ticks either.
+ *
+ *   Usage: timing_wheel_test [level file], exits with 1 if a check fails
+ *
+ *   @file     timingWheelTest.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#define TINYOBJLOADER_IMPLEMENTATION
+#include "tiny_obj_loader.h"
+#include "../map.h"
+#include "../ghost.h"
+#include "../navGraph.h"
+#include "../distanceOracle.h"
+#include "../motionBatch.h"
+#include "testLevels.h"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static const double tickSeconds[2] = { 0.005, 0.015 };
+
+struct Event {
+    int   slot;
+    float time;
+    int   tileX, tileY;     //Where the owner stands after handling it, -1 when there is no owner
+    bool operator==(const Event& other) const {
+        return slot == other.slot && memcmp(&time, &other.time, sizeof(time)) == 0
+            && tileX == other.tileX && tileY == other.tileY;
+    }
+};
+
+/**
+ *  Seconds until the next end of a slot, the same for every tick length.
+ *  Mostly short hops, some under a millisecond so they land on a tick that
+ *  was already taken and some far enough ahead to cascade.
+ */
+static float nextDuration(int slot, int count) {
+    uint32_t hash = uint32_t(slot) * 2654435761u ^ uint32_t(count) * 40503u;
+    hash ^= hash >> 15;
+    hash *= 2246822519u;
+    hash ^= hash >> 13;
+    switch (hash % 64) {
+    case 0:  return 70.0f;
+    case 1:  case 2:  case 3:  case 4:  return 0.0004f;
+    case 5:  case 6:  case 7:  case 8:  return 0.3f + float(hash % 1000) * 0.001f;
+    }
+    return 0.01f + float(hash % 200) * 0.001f;
+}
+
+/**
+ *  Runs segments of many slots back to back
+ *
+ *  @return returns every end in the order nextEvent() handed it out
+ */
+static std::vector<Event> runSegments(int slots, float seconds, double tick) {
+    MotionBatch motion;
+    std::vector<int> count(slots, 0);
+    float start[2] = { 0.0f, 0.0f }, stop[2] = { 1.0f, 0.0f };
+    for (int s = 0; s < slots; s++) { motion.add(start, stop, 0.0f, nextDuration(s, count[s]++)); }
+    std::vector<Event> events;
+    for (int t = 1; t * tick <= seconds; t++) {
+        int   slot;
+        float eventTime;
+        while (motion.nextEvent(float(t * tick), slot, eventTime)) {
+            events.push_back({ slot, eventTime, -1, -1 });
+            motion.setSegment(slot, stop, start, eventTime, nextDuration(slot, count[slot]++));
+        }
+        motion.interpolate(float(t * tick));
+    }
+    return events;
+}
+
+/**
+ *  Lets ghosts roam level0, half of them chasing pacman's spawn
+ *
+ *  @return returns every end in the order nextEvent() handed it out, with the tile the ghost turned on
+ */
+static std::vector<Event> runGhosts(Camera& camera, Map& map, NavGraph& nav, DistanceOracle& paths,
+                                    int count, float seconds, double tick) {
+    std::vector<int> tiles = walkableTiles(nav);
+    int width = nav.getWidthHeight().first;
+    srand(7);
+    std::vector<Ghost> ghosts;
+    ghosts.reserve(count);
+    for (int g = 0; g < count; g++) {
+        int tile = tiles[(size_t(g) * 7919) % tiles.size()];
+        ghosts.emplace_back(tile % width, tile / width, true, map.getWidthHeight(), map.getXYshift(), &camera);
+    }
+    MotionBatch motion;
+    for (int g = 0; g < count; g++) {
+        ghosts[g].setNavGraph(&nav);
+        ghosts[g].setOracle(&paths);
+        if (g % 2 == 0) { ghosts[g].setTarget({ tiles.back() % width, tiles.back() / width }); }
+        ghosts[g].bindMotion(motion, 0.0f);
+    }
+    std::vector<Event> events;
+    for (int t = 1; t * tick <= seconds; t++) {
+        int   slot;
+        float eventTime;
+        while (motion.nextEvent(float(t * tick), slot, eventTime)) {
+            ghosts[slot].tileBoundary(eventTime);
+            std::pair<int, int> tile = ghosts[slot].currentTile();
+            events.push_back({ slot, eventTime, tile.first, tile.second });
+        }
+        motion.interpolate(float(t * tick));
+    }
+    return events;
+}
+
+/**
+ *  Checks the ends came out in (time, slot) order and the same at every tick length
+ *
+ *  @param name  - check name for the report
+ *  @param until - ends after this time are left out, the last tick of each run differs a little
+ *  @return returns true if the check passed
+ */
+static bool sameOrder(const std::string& name, std::vector<Event> runs[2], float until) {
+    for (int r = 0; r < 2; r++) {
+        for (size_t e = 1; e < runs[r].size(); e++) {
+            const Event& before = runs[r][e - 1];
+            const Event& after  = runs[r][e];
+            if (after.time < before.time || (after.time == before.time && after.slot <= before.slot)) {
+                printf("FAIL %s: at %.0f ms ticks slot %i at %.4f came before slot %i at %.4f\n", name.c_str(),
+                    tickSeconds[r] * 1000.0, before.slot, before.time, after.slot, after.time);
+                return false;
+            }
+        }
+        while (!runs[r].empty() && until < runs[r].back().time) { runs[r].pop_back(); }
+    }
+    for (size_t e = 0; e < runs[0].size() || e < runs[1].size(); e++) {
+        if (e == runs[0].size() || e == runs[1].size() || !(runs[0][e] == runs[1][e])) {
+            printf("FAIL %s: %.0f ms and %.0f ms ticks part at end %zu of %zu and %zu\n", name.c_str(),
+                tickSeconds[0] * 1000.0, tickSeconds[1] * 1000.0, e, runs[0].size(), runs[1].size());
+            return false;
+        }
+    }
+    printf("ok   %s: %zu ends in the same order at %.0f ms and %.0f ms ticks\n", name.c_str(),
+        runs[0].size(), tickSeconds[0] * 1000.0, tickSeconds[1] * 1000.0);
+    return true;
+}
+
+/**
+ *  Main function
+ */
+int main(int argc, char** argv) {
+    bool passed = true;
+    std::vector<Event> runs[2];
+    for (int r = 0; r < 2; r++) { runs[r] = runSegments(512, 150.0f, tickSeconds[r]); }
+    passed &= sameOrder("segment_ends", runs, 149.9f);
+
+    if (1 < argc) {
+        Camera camera;
+        Map map(argv[1], &camera);
+        camera.recieveMap(map.getIntMap());
+        NavGraph nav;
+        nav.build(map);
+        DistanceOracle paths;
+        paths.build(nav);
+        for (int r = 0; r < 2; r++) { runs[r] = runGhosts(camera, map, nav, paths, 64, 60.0f, tickSeconds[r]); }
+        passed &= sameOrder("ghost_paths", runs, 59.9f);
+    }
+    return passed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,124 @@
+/**
+ *   TextureArray, every game texture behind one binding
+ *
+ *   @file     textureArray.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "textureArray.h"
+#include "renderStats.h"
+
+/**
+ *  Registers an image as the next layer, call before loading starts
+ *
+ *  @param filepath - image to load into the layer
+ *
+ *  @return returns the layer index shaders use for this image
+ */
+int TextureArray::addLayer(const std::string& filepath) {
+    paths.push_back(filepath);
+    layers.push_back(DecodedImage());
+    return int(paths.size()) - 1;
+}
+
+/**
+ *  Decodes one layer and fits it to the layer size, safe to call from loader threads
+ *
+ *  @param layer - layer index from addLayer
+ *
+ *  @see decode_image(const std::string& filepath)
+ *  @see resampleImage(const unsigned char* rgba, int width, int height, int newWidth, int newHeight)
+ */
+void TextureArray::decodeLayer(int layer) {
+    DecodedImage image = decode_image(paths[layer]);
+    if (image.pixels.empty()) {
+        image.pixels.assign(size_t(layerWidth) * layerHeight * 4, 255);    //Missing images show up white
+    }
+    else if (image.width != layerWidth || image.height != layerHeight) {
+        image.pixels = resampleImage(image.pixels.data(), image.width, image.height, layerWidth, layerHeight);
+    }
+    image.width = layerWidth;
+    image.height = layerHeight;
+    layers[layer] = std::move(image);
+}
+
+/**
+ *  Checks if every layer has a converted mip chain that fits the array
+ */
+bool TextureArray::canUsePrecompressed() {
+    if (!GLAD_GL_EXT_texture_compression_s3tc) { return false; }
+    for (auto& layer : layers) {
+        const KtxTexture& ktx = layer.precompressed;
+        if (ktx.levels.empty() || !ktx.compressed()
+                || ktx.width != layerWidth || ktx.height != layerHeight
+                || ktx.glInternalFormat != layers[0].precompressed.glInternalFormat
+                || ktx.levels.size() != layers[0].precompressed.levels.size()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ *  Uploads all layers and binds the array to textureUnit, must run on the GL thread
+ */
+void TextureArray::upload() {
+    int layerCount = getLayerCount(),
+        levels = 1;
+    while ((layerWidth >> levels) > 0 || (layerHeight >> levels) > 0) { levels++; }
+
+    glGenTextures(1, &texture);
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(GL_TEXTURE_2D_ARRAY, texture);
+    RenderStats::countTextureBind();
+
+    bool precompressed = canUsePrecompressed();
+    if (precompressed) {
+        const KtxTexture& first = layers[0].precompressed;
+        levels = int(first.levels.size());
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, first.glInternalFormat, layerWidth, layerHeight, layerCount);
+        memoryBytes = 0;
+        for (int layer = 0; layer < layerCount; layer++) {
+            const KtxTexture& ktx = layers[layer].precompressed;
+            int w = layerWidth, h = layerHeight;
+            for (int level = 0; level < levels; level++) {
+                glCompressedTexSubImage3D(GL_TEXTURE_2D_ARRAY, level, 0, 0, layer, w, h, 1, ktx.glInternalFormat,
+                                          GLsizei(ktx.levels[level].size()), ktx.levels[level].data());
+                w = (w > 1) ? w / 2 : 1;
+                h = (h > 1) ? h / 2 : 1;
+            }
+            memoryBytes += ktxByteSize(ktx);
+            RenderStats::countUpload(ktxByteSize(ktx));
+        }
+    }
+    else {
+        glTexStorage3D(GL_TEXTURE_2D_ARRAY, levels, GL_RGBA8, layerWidth, layerHeight, layerCount);
+        for (int layer = 0; layer < layerCount; layer++) {
+            glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, layerWidth, layerHeight, 1,
+                            GL_RGBA, GL_UNSIGNED_BYTE, layers[layer].pixels.data());
+            RenderStats::countUpload(layers[layer].pixels.size());
+        }
+        glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+        memoryBytes = (size_t(layerWidth) * layerHeight * 4 * layerCount * 4) / 3;
+    }
+
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    printf("Texture array: %i layers of %ix%i, %s, %.1f KiB on the GPU\n", layerCount, layerWidth, layerHeight,
+           precompressed ? ktxFormatName(layers[0].precompressed.glInternalFormat).c_str() : "RGBA8 fallback",
+           memoryBytes / 1024.0);
+
+    //CPU copies are no longer needed
+    for (auto& layer : layers) { layer = DecodedImage(); }
+}
+
+/**
+ *  Deletes the array texture
+ */
+void TextureArray::cleanTextureArray() {
+    glDeleteTextures(1, &texture);
+    texture = 0;
+}
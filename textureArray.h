@@ -0,0 +1,44 @@
+/**
+ *   Header for the TextureArray class.
+ *
+ *   Holds every game texture as a layer of one GL_TEXTURE_2D_ARRAY bound to
+ *   a single texture unit, shaders pick their image with a layer index.
+ *
+ *   @file     textureArray.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __TEXTUREARRAY_H
+#define __TEXTUREARRAY_H
+
+#include "globFunc.h"
+
+ // -----------------------------------------------------------------------------
+ // TextureArray Class header
+ // -----------------------------------------------------------------------------
+class TextureArray {
+private:
+    std::vector<std::string>  paths;
+    std::vector<DecodedImage> layers;       //Filled by decodeLayer, one slot per layer
+    GLuint  texture = 0;
+    int     layerWidth,
+            layerHeight;
+    size_t  memoryBytes = 0;
+
+    bool    canUsePrecompressed();
+public:
+    //Unit 0 is left alone, unbound samplers in the model shader (u_ShadowMap) default to it
+    static const GLuint textureUnit = 1;
+
+    TextureArray(int width = 256, int height = 256) : layerWidth(width), layerHeight(height) {};
+    int     addLayer(const std::string& filepath);
+    void    decodeLayer(int layer);
+    void    upload();
+    void    cleanTextureArray();
+    int     getLayerCount()     { return int(paths.size()); };
+    const std::string& getPath(int layer) { return paths[layer]; };
+    size_t  getMemoryBytes()    { return memoryBytes; };
+    GLuint  getTexture()        { return texture; };
+};
+
+#endif
@@ -0,0 +1,137 @@
+/**
+ *   TimingWheel, hierarchical timer scheduling
+ *
+ *   Level L slot S holds the timers whose due tick has S in bits
+ *   8L .. 8L+7 and that are less than 256^(L+1) ticks ahead of current
+ *   when placed. Each time current crosses a multiple of 256^L the matching
+ *   level L slot is emptied and its timers placed again, lower down.
+ *
+ *   @file     timingWheel.cpp
+ *   @author   Axel Jacobsen
+ */
+
+#include "timingWheel.h"
+
+/**
+ *  Creates an empty wheel, call resize() before scheduling
+ */
+TimingWheel::TimingWheel() {
+    for (auto& head : heads) { head = unlisted; }
+}
+
+/**
+ *  Makes room for ids 0 .. capacity-1, pending timers are kept
+ *
+ *  @param capacity - number of ids
+ */
+void TimingWheel::resize(int capacity) {
+    next.resize(capacity, unlisted);
+    prev.resize(capacity, unlisted);
+    list.resize(capacity, unlisted);
+    due.resize(capacity, 0);
+}
+
+/**
+ *  Cancels every timer and rewinds to tick 0
+ */
+void TimingWheel::clear() {
+    for (auto& head : heads) { head = unlisted; }
+    for (auto& index : list) { index = unlisted; }
+    current = 0;
+}
+
+/**
+ *  Pushes an id at the front of a list
+ */
+void TimingWheel::link(int id, int listIndex) {
+    prev[id] = unlisted;
+    next[id] = heads[listIndex];
+    if (heads[listIndex] != unlisted) { prev[heads[listIndex]] = id; }
+    heads[listIndex] = id;
+    list[id] = listIndex;
+}
+
+/**
+ *  Takes an id out of its list
+ */
+void TimingWheel::unlink(int id) {
+    if (prev[id] != unlisted) { next[prev[id]] = next[id]; }
+    else                      { heads[list[id]] = next[id]; }
+    if (next[id] != unlisted) { prev[next[id]] = prev[id]; }
+    list[id] = unlisted;
+}
+
+/**
+ *  Puts an id in the slot for its due tick, relative to current
+ */
+void TimingWheel::place(int id) {
+    uint32_t tick  = (due[id] < current) ? current : due[id],
+             delta = tick - current;
+    int level = 0;
+    while (level < levels - 1 && (delta >> (levelBits * (level + 1))) != 0) { level++; }
+    link(id, level * slotCount + int((tick >> (levelBits * level)) & (slotCount - 1)));
+}
+
+/**
+ *  Places every timer of a list again, they land in lower levels
+ */
+void TimingWheel::cascade(int listIndex) {
+    int id = heads[listIndex];
+    heads[listIndex] = unlisted;
+    while (id != unlisted) {
+        int following = next[id];
+        list[id] = unlisted;
+        place(id);
+        id = following;
+    }
+}
+
+/**
+ *  Schedules or moves the timer of an id
+ *
+ *  @param id   - timer id
+ *  @param tick - tick to expire at, ticks before current expire on the next advance()
+ */
+void TimingWheel::schedule(int id, uint32_t tick) {
+    if (list[id] != unlisted) { unlink(id); }
+    due[id] = tick;
+    place(id);
+}
+
+/**
+ *  Cancels the timer of an id, if it has one
+ *
+ *  @param id - timer id
+ */
+void TimingWheel::cancel(int id) {
+    if (list[id] != unlisted) { unlink(id); }
+}
+
+/**
+ *  Expires every timer due at or before a tick
+ *
+ *  @param now     - last tick to process
+ *  @param expired - receives the expired ids, tick by tick but in no order within a tick
+ */
+void TimingWheel::advance(uint32_t now, std::vector<int>& expired) {
+    while (current <= now) {
+        //Entering a new turn of a level pulls its next slot down, top level first
+        if ((current & (slotCount - 1)) == 0) {
+            for (int level = levels - 1; 1 <= level; level--) {
+                if ((current & ((uint32_t(1) << (levelBits * level)) - 1)) != 0) { continue; }
+                cascade(level * slotCount + int((current >> (levelBits * level)) & (slotCount - 1)));
+            }
+        }
+
+        int listIndex = int(current & (slotCount - 1));
+        for (int id = heads[listIndex]; id != unlisted; ) {
+            int following = next[id];
+            list[id] = unlisted;
+            expired.push_back(id);
+            id = following;
+        }
+        heads[listIndex] = unlisted;
+        if (current == UINT32_MAX) { break; }
+        current++;
+    }
+}
@@ -0,0 +1,60 @@
+/**
+ *   Header for the TimingWheel class.
+ *
+ *   Hierarchical timing wheel for scheduling many timers by integer tick.
+ *   Scheduling, cancelling and expiring a timer are O(1), and advancing the
+ *   wheel costs one slot visit per tick plus a cascade every 256 ticks, no
+ *   matter how many timers are pending. Timers are identified by small ids
+ *   (0 .. capacity-1) and an id has at most one pending timer, scheduling it
+ *   again moves it. Nothing allocates after resize().
+ *
+ *   Four levels of 256 slots cover the whole 32 bit tick range, and timers
+ *   less than 256 ticks ahead go straight into the bottom level.
+ *
+ *   @file     timingWheel.h
+ *   @author   Axel Jacobsen
+ */
+
+#ifndef __TIMINGWHEEL_H
+#define __TIMINGWHEEL_H
+
+#include <cstdint>
+#include <vector>
+
+ // -----------------------------------------------------------------------------
+ // TimingWheel Class header
+ // -----------------------------------------------------------------------------
+class TimingWheel {
+public:
+    static const int levelBits = 8,
+                     slotCount = 1 << levelBits,    //Slots per level
+                     levels    = 4;
+
+private:
+    static constexpr int unlisted = -1;
+
+    std::vector<int>      next, prev,       //Doubly linked list per slot, by id
+                          list;             //List an id is in, unlisted if not scheduled
+    std::vector<uint32_t> due;              //Tick an id expires at
+    int      heads[levels * slotCount];
+    uint32_t current = 0;                   //Next tick to be processed, every earlier tick has expired
+
+    void     link(int id, int listIndex);
+    void     unlink(int id);
+    void     place(int id);
+    void     cascade(int listIndex);
+
+public:
+    TimingWheel();
+    void     resize(int capacity);
+    void     clear();
+    void     schedule(int id, uint32_t tick);
+    void     cancel(int id);
+    void     advance(uint32_t now, std::vector<int>& expired);
+
+    bool     isScheduled(int id)    { return list[id] != unlisted; };
+    uint32_t getDue(int id)         { return due[id]; };
+    uint32_t getCurrent()           { return current; };
+};
+
+#endif
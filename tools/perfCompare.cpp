@@ -0,0 +1,339 @@
+/**
+ *   Performance regression check
+ *
+ *   Compares benchmark results against a stored baseline and fails when a
+ *   metric got slower by more than the threshold. Reads pacman_bench output
+ *   (median and MAD per case) and `Pacman --bench` reports. When several
+ *   reports of a kind are given, each metric becomes the median and MAD
+ *   across the runs.
+ *
+ *   A metric only counts as regressed when it is over the threshold AND the
+ *   difference is larger than --noise times the bigger MAD, so a noisy case
+ *   does not fail the check on its own.
+ *
+ *   A baseline metric the results lack, or a result the baseline lacks, also
+ *   fails the check, so a benchmark cannot be added, renamed or dropped
+ *   without a new baseline. --allow takes a key prefix that may be missing
+ *   on either side, e.g. "frame/" when there is no GPU to run Pacman --bench.
+ *
+ *   Usage: PerfCompare --baseline <baseline.json> [--threshold percent] [--noise factor]
+ *                      [--allow prefix]... [--update] <result.json>...
+ *
+ *   --update writes the results as the new baseline instead of comparing.
+ *
+ *   @file     perfCompare.cpp
+ *   @author   Axel Jacobsen
+ */
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+/**
+ *  Just enough JSON for the files written by the benchmarks
+ */
+struct JsonValue {
+    enum Type { NUL, NUMBER, STRING, ARRAY, OBJECT } type = NUL;
+    double number = 0.0;
+    std::string string;
+    std::vector<JsonValue> items;
+    std::vector<std::pair<std::string, JsonValue>> members;
+
+    const JsonValue* find(const std::string& key) const {
+        for (auto& member : members) { if (member.first == key) { return &member.second; } }
+        return nullptr;
+    }
+};
+
+/**
+ *  Recursive descent parser, sets ok to false on malformed input
+ */
+class JsonReader {
+private:
+    const std::string& text;
+    size_t pos = 0;
+
+    void skipSpace() { while (pos < text.size() && isspace((unsigned char)text[pos])) { pos++; } }
+
+    bool expect(char c) {
+        skipSpace();
+        if (pos < text.size() && text[pos] == c) { pos++; return true; }
+        ok = false;
+        return false;
+    }
+
+    std::string readString() {
+        std::string out;
+        if (!expect('"')) { return out; }
+        while (pos < text.size() && text[pos] != '"') {
+            if (text[pos] == '\\' && pos + 1 < text.size()) { pos++; }
+            out += text[pos++];
+        }
+        expect('"');
+        return out;
+    }
+
+public:
+    bool ok = true;
+
+    JsonReader(const std::string& source) : text(source) {};
+
+    JsonValue read() {
+        JsonValue value;
+        skipSpace();
+        if (pos >= text.size()) { ok = false; return value; }
+        char c = text[pos];
+        if (c == '{') {
+            value.type = JsonValue::OBJECT;
+            pos++;
+            skipSpace();
+            if (pos < text.size() && text[pos] == '}') { pos++; return value; }
+            while (ok) {
+                std::string key = readString();
+                expect(':');
+                value.members.push_back({ key, read() });
+                skipSpace();
+                if (pos < text.size() && text[pos] == ',') { pos++; continue; }
+                expect('}');
+                break;
+            }
+        }
+        else if (c == '[') {
+            value.type = JsonValue::ARRAY;
+            pos++;
+            skipSpace();
+            if (pos < text.size() && text[pos] == ']') { pos++; return value; }
+            while (ok) {
+                value.items.push_back(read());
+                skipSpace();
+                if (pos < text.size() && text[pos] == ',') { pos++; continue; }
+                expect(']');
+                break;
+            }
+        }
+        else if (c == '"') {
+            value.type = JsonValue::STRING;
+            value.string = readString();
+        }
+        else if (text.compare(pos, 4, "null") == 0) { pos += 4; }
+        else {
+            char* end;
+            value.type = JsonValue::NUMBER;
+            value.number = strtod(text.c_str() + pos, &end);
+            if (end == text.c_str() + pos) { ok = false; }
+            pos = end - text.c_str();
+        }
+        return value;
+    }
+};
+
+/**
+ *  One compared value, times are in the unit the benchmark wrote
+ */
+struct Metric {
+    double median = 0.0,
+           mad    = 0.0;
+    std::string unit;
+};
+
+typedef std::map<std::string, Metric> Metrics;
+
+/**
+ *  Returns the median, values is reordered
+ */
+static double median(std::vector<double> values) {
+    if (values.empty()) { return 0.0; }
+    size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    return values[mid];
+}
+
+/**
+ *  Returns the median absolute deviation
+ */
+static double medianDeviation(const std::vector<double>& values) {
+    double center = median(values);
+    std::vector<double> deviations;
+    for (auto& value : values) { deviations.push_back(std::fabs(value - center)); }
+    return median(deviations);
+}
+
+/**
+ *  Reads a JSON file
+ *
+ *  @return returns false if the file is missing or malformed
+ */
+static bool loadJson(const std::string& path, JsonValue& root) {
+    std::ifstream file(path);
+    if (!file) { printf("ERROR: Couldnt open %s\n", path.c_str()); return false; }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+    JsonReader reader(text);
+    root = reader.read();
+    if (!reader.ok || root.type != JsonValue::OBJECT) { printf("ERROR: %s is not valid JSON\n", path.c_str()); return false; }
+    return true;
+}
+
+/**
+ *  Adds every case of a pacman_bench report, keyed name/param=value/...
+ *
+ *  @param benchmarks - "benchmarks" array of the report
+ *  @param runs       - per key, the median and MAD of each report read so far
+ */
+static void addMicroBenchmarks(const JsonValue& benchmarks, std::map<std::string, std::vector<std::pair<double, double>>>& runs) {
+    for (auto& entry : benchmarks.items) {
+        const JsonValue* name   = entry.find("name");
+        const JsonValue* params = entry.find("params");
+        const JsonValue* med    = entry.find("medianNs");
+        const JsonValue* mad    = entry.find("madNs");
+        if (!name || !med) { continue; }
+        std::string key = name->string;
+        if (params) {
+            for (auto& param : params->members) {
+                char value[32];
+                snprintf(value, sizeof(value), "%g", param.second.number);
+                key += "/" + param.first + "=" + value;
+            }
+        }
+        runs[key].push_back({ med->number, mad ? mad->number : 0.0 });
+    }
+}
+
+/**
+ *  Returns true if a key starts with one of the prefixes
+ */
+static bool isAllowed(const std::string& key, const std::vector<std::string>& prefixes) {
+    for (auto& prefix : prefixes) {
+        if (key.compare(0, prefix.size(), prefix) == 0) { return true; }
+    }
+    return false;
+}
+
+/**
+ *  Main function
+ */
+int main(int argc, char** argv) {
+    std::string baselinePath;
+    std::vector<std::string> results,
+                             allowed;
+    double threshold = 10.0,
+           noise     = 3.0;
+    bool   update    = false;
+    for (int i = 1; i < argc; i++) {
+        if      (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)  { baselinePath = argv[++i]; }
+        else if (strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) { threshold = atof(argv[++i]); }
+        else if (strcmp(argv[i], "--noise") == 0 && i + 1 < argc)     { noise = atof(argv[++i]); }
+        else if (strcmp(argv[i], "--allow") == 0 && i + 1 < argc)     { allowed.push_back(argv[++i]); }
+        else if (strcmp(argv[i], "--update") == 0)                    { update = true; }
+        else { results.push_back(argv[i]); }
+    }
+    if (baselinePath.empty() || results.empty()) {
+        printf("Usage: %s --baseline <baseline.json> [--threshold percent] [--noise factor] [--allow prefix]... [--update] <result.json>...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    //Micro benchmarks carry their own median and MAD, frame reports are one sample per run
+    Metrics current;
+    std::map<std::string, std::vector<std::pair<double, double>>> microRuns;
+    std::map<std::string, std::vector<double>> frameRuns;
+    const char* frameStats[] = { "p50", "p95", "p99" };
+    const char* gpuPasses[]  = { "map", "pellets", "ghosts" };
+    for (auto& path : results) {
+        JsonValue root;
+        if (!loadJson(path, root)) { return EXIT_FAILURE; }
+        if (const JsonValue* benchmarks = root.find("benchmarks")) { addMicroBenchmarks(*benchmarks, microRuns); }
+        if (const JsonValue* frameMs = root.find("frameMs")) {
+            for (auto& stat : frameStats) {
+                if (const JsonValue* value = frameMs->find(stat)) { frameRuns[std::string("frame/frameMs.") + stat].push_back(value->number); }
+            }
+            if (const JsonValue* gpuMs = root.find("gpuMs")) {
+                for (auto& pass : gpuPasses) {
+                    if (const JsonValue* value = gpuMs->find(pass)) { frameRuns[std::string("frame/gpuMs.") + pass].push_back(value->number); }
+                }
+            }
+        }
+    }
+    for (auto& run : frameRuns) { current[run.first] = { median(run.second), medianDeviation(run.second), "ms" }; }
+
+    //Repeated pacman_bench reports: the spread between runs usually beats the spread within one
+    for (auto& run : microRuns) {
+        std::vector<double> medians, deviations;
+        for (auto& sample : run.second) { medians.push_back(sample.first); deviations.push_back(sample.second); }
+        current[run.first] = { median(medians), std::max(medianDeviation(medians), median(deviations)), "ns" };
+    }
+
+    if (update) {
+        FILE* out = fopen(baselinePath.c_str(), "w");
+        if (!out) { printf("ERROR: Couldnt write %s\n", baselinePath.c_str()); return EXIT_FAILURE; }
+        fprintf(out, "{\n  \"metrics\": [\n");
+        size_t count = 0;
+        for (auto& metric : current) {
+            fprintf(out, "    {\"key\": \"%s\", \"median\": %.4f, \"mad\": %.4f, \"unit\": \"%s\"}%s\n",
+                    metric.first.c_str(), metric.second.median, metric.second.mad, metric.second.unit.c_str(),
+                    (++count < current.size()) ? "," : "");
+        }
+        fprintf(out, "  ]\n}\n");
+        fclose(out);
+        printf("Wrote %zu metrics to %s\n", current.size(), baselinePath.c_str());
+        return EXIT_SUCCESS;
+    }
+
+    JsonValue baselineRoot;
+    if (!loadJson(baselinePath, baselineRoot)) { return EXIT_FAILURE; }
+    Metrics baseline;
+    if (const JsonValue* metrics = baselineRoot.find("metrics")) {
+        for (auto& entry : metrics->items) {
+            const JsonValue* key  = entry.find("key");
+            const JsonValue* med  = entry.find("median");
+            const JsonValue* mad  = entry.find("mad");
+            const JsonValue* unit = entry.find("unit");
+            if (key && med) { baseline[key->string] = { med->number, mad ? mad->number : 0.0, unit ? unit->string : "" }; }
+        }
+    }
+
+    int regressed = 0, improved = 0, compared = 0, unmatched = 0;
+    printf("%-52s %14s %14s %9s\n", "metric", "baseline", "current", "change");
+    for (auto& base : baseline) {
+        auto found = current.find(base.first);
+        if (found == current.end()) {
+            bool allow = isAllowed(base.first, allowed);
+            if (!allow) { unmatched++; }
+            printf("%-52s %11.1f %-2s %14s %9s  not run%s\n", base.first.c_str(), base.second.median, base.second.unit.c_str(), "-", "-",
+                   allow ? "" : "  MISSING");
+            continue;
+        }
+        const Metric& now = found->second;
+        double change  = base.second.median > 0.0 ? (now.median - base.second.median) / base.second.median * 100.0 : 0.0,
+               noiseAt = noise * std::max(base.second.mad, now.mad);
+        const char* status = "";
+        if (change > threshold && now.median - base.second.median > noiseAt) { status = "  REGRESSED"; regressed++; }
+        else if (change < -threshold && base.second.median - now.median > noiseAt) { status = "  faster"; improved++; }
+        compared++;
+        printf("%-52s %11.1f %-2s %11.1f %-2s %+8.1f%%%s\n", base.first.c_str(), base.second.median, base.second.unit.c_str(),
+               now.median, now.unit.c_str(), change, status);
+    }
+    for (auto& now : current) {
+        if (baseline.find(now.first) == baseline.end()) {
+            bool allow = isAllowed(now.first, allowed);
+            if (!allow) { unmatched++; }
+            printf("%-52s %14s %11.1f %-2s %9s  not in baseline%s\n", now.first.c_str(), "-", now.second.median, now.second.unit.c_str(), "-",
+                   allow ? "" : "  UNKNOWN");
+        }
+    }
+
+    printf("\n%i metrics compared, %i regressed by more than %.1f%%, %i faster, %i missing or unknown\n",
+           compared, regressed, threshold, improved, unmatched);
+    if (regressed || unmatched) {
+        printf("If the change is intended, regenerate the baseline with --update\n");
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,74 @@
+/**
+ *   Offline texture converter
+ *
+ *   Converts a PNG to a KTX file with a full mip chain, compressed to BC1
+ *   (opaque images) or BC3 (images with alpha). The game loads the KTX when
+ *   it sits next to the PNG and the driver supports S3TC.
+ *
+ *   Usage: TexConv <input.png> [output.ktx] [--format bc1|bc3|rgba8] [--size WxH]
+ *
+ *   --size resamples the image first, textures that share a texture array
+ *   must be converted to the array's layer size and format.
+ *
+ *   @file     texconv.cpp
+ *   @author   Axel Jacobsen
+ */
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include "../ktx.h"
+
+#include <cstdio>
+#include <cstring>
+
+/**
+ *  main function
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        printf("Usage: %s <input.png> [output.ktx] [--format bc1|bc3|rgba8] [--size WxH]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+    std::string input = argv[1],
+                output = ktxPathFor(input),
+                format;
+    int sizeX = 0, sizeY = 0;
+    for (int i = 2; i < argc; i++) {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc) { format = argv[++i]; }
+        else if (strcmp(argv[i], "--size") == 0 && i + 1 < argc) { sscanf(argv[++i], "%ix%i", &sizeX, &sizeY); }
+        else { output = argv[i]; }
+    }
+
+    int width, height, bpp;
+    unsigned char* pixels = stbi_load(input.c_str(), &width, &height, &bpp, STBI_rgb_alpha);
+    if (!pixels) {
+        printf("ERROR: Couldnt load %s\n", input.c_str());
+        return EXIT_FAILURE;
+    }
+    std::vector<unsigned char> image(pixels, pixels + size_t(width) * height * 4);
+    stbi_image_free(pixels);
+    int sourceWidth = width, sourceHeight = height;
+    if (0 < sizeX && 0 < sizeY && (sizeX != width || sizeY != height)) {
+        image = resampleImage(image.data(), width, height, sizeX, sizeY);
+        width = sizeX;
+        height = sizeY;
+    }
+
+    GLenum internalFormat;
+    if      (format == "bc1")   { internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; }
+    else if (format == "bc3")   { internalFormat = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT; }
+    else if (format == "rgba8") { internalFormat = GL_RGBA8; }
+    else { internalFormat = hasTransparency(image.data(), width, height) ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+                                                                        : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT; }
+
+    KtxTexture texture = buildKtxTexture(image.data(), width, height, internalFormat);
+
+    if (!writeKtx(output, texture)) {
+        printf("ERROR: Couldnt write %s\n", output.c_str());
+        return EXIT_FAILURE;
+    }
+    printf("%s (%ix%i) -> %s: %ix%i %s, %zu levels, %zu bytes (RGBA8 level 0 alone: %zu bytes)\n",
+           input.c_str(), sourceWidth, sourceHeight, output.c_str(), width, height,
+           ktxFormatName(internalFormat).c_str(), texture.levels.size(), ktxByteSize(texture),
+           size_t(width) * height * 4);
+    return EXIT_SUCCESS;
+}